@@ -36,7 +36,7 @@ DBTransaction = {}
 ---@field query fun(query: string): any
 ---@field storeQuery fun(query: string): any
 ---@field escapeString fun(value: string): string
----@field asyncQuery fun(query: string): boolean
+---@field asyncQuery fun(query: string, callback?: fun(success: boolean), playerGuid?: number)
 db = {}
 
 ---@class result
@@ -2137,6 +2137,11 @@ configKeys = {
 	MANASHIELD_BREAKABLE = 36,
 	CHECK_DUPLICATE_STORAGE_KEYS = 37,
 	MONSTER_OVERSPAWN = 38,
+	MAP_TILE_GRID = 39,
+	WORLD_SAVE_ASYNC = 40,
+	INCREMENTAL_PLAYER_SAVE = 41,
+	PLAYER_ITEM_BLOBS = 42,
+	PACKET_COMPRESSION = 43,
 
 	-- ConfigKeysString
 	MAP_NAME = 0,
@@ -2202,6 +2207,14 @@ configKeys = {
 	QUEST_TRACKER_PREMIUM_LIMIT = 41,
 	STAMINA_REGEN_MINUTE = 42,
 	STAMINA_REGEN_PREMIUM = 43,
+	PATHFINDING_THREADS = 46,
+	WORLD_SAVE_SLICE_TIME = 47,
+	NETWORK_THREADS = 48,
+	PACKET_COMPRESSION_THRESHOLD = 49,
+	PACKET_COMPRESSION_LEVEL = 50,
+	MAX_OUTBOUND_QUEUE_BYTES = 51,
+	AUTH_THREADS = 52,
+	DATABASE_THREADS = 53,
 }
 
 ITEM_TYPE_NONE = 0
@@ -1,3 +1,15 @@
 function onUpdateDatabase()
-	return false
+	print("> Updating database to version 38 (player item blobs)")
+
+	db.query([[
+		CREATE TABLE IF NOT EXISTS `player_item_blobs` (
+			`player_id` int NOT NULL,
+			`type` tinyint unsigned NOT NULL,
+			`pid` int NOT NULL,
+			`data` mediumblob NOT NULL,
+			PRIMARY KEY (`player_id`, `type`, `pid`),
+			FOREIGN KEY (`player_id`) REFERENCES `players`(`id`) ON DELETE CASCADE
+		) ENGINE=InnoDB DEFAULT CHARACTER SET=utf8;
+	]])
+	return true
 end
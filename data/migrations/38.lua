@@ -0,0 +1,12 @@
+function onUpdateDatabase()
+	print("> Updating database to version 39 (player spells primary key)")
+
+	-- saves used to insert a learned spell again when it was already stored, keep one row of each
+	db.query("CREATE TEMPORARY TABLE `player_spells_unique` SELECT DISTINCT `player_id`, `name` FROM `player_spells`")
+	db.query("DELETE FROM `player_spells`")
+	db.query("INSERT INTO `player_spells` (`player_id`, `name`) SELECT `player_id`, `name` FROM `player_spells_unique`")
+	db.query("DROP TEMPORARY TABLE `player_spells_unique`")
+
+	db.query("ALTER TABLE `player_spells` ADD PRIMARY KEY (`player_id`, `name`)")
+	return true
+end
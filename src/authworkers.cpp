@@ -0,0 +1,73 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "authworkers.h"
+
+AuthWorkers::~AuthWorkers() { shutdown(); }
+
+bool AuthWorkers::start(size_t threadCount)
+{
+	assert(threads.empty());
+
+	threadCount = std::max<size_t>(threadCount, 1);
+	for (size_t i = 0; i < threadCount; ++i) {
+		if (!connections.emplace_back().connect()) {
+			connections.clear();
+			return false;
+		}
+	}
+
+	stopping = false;
+	threads.reserve(threadCount);
+	for (auto& db : connections) {
+		threads.emplace_back(&AuthWorkers::threadMain, this, std::ref(db));
+	}
+	return true;
+}
+
+void AuthWorkers::shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lockClass(taskLock);
+		stopping = true;
+	}
+	taskSignal.notify_all();
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	threads.clear();
+	connections.clear();
+}
+
+void AuthWorkers::addTask(std::function<void(Database&)> task)
+{
+	{
+		std::lock_guard<std::mutex> lockClass(taskLock);
+		if (stopping) {
+			return;
+		}
+		tasks.push_back(std::move(task));
+	}
+	taskSignal.notify_one();
+}
+
+void AuthWorkers::threadMain(Database& db)
+{
+	std::unique_lock<std::mutex> lockClass(taskLock);
+	while (true) {
+		taskSignal.wait(lockClass, [this]() { return stopping || !tasks.empty(); });
+		if (tasks.empty()) {
+			return;
+		}
+
+		auto task = std::move(tasks.front());
+		tasks.pop_front();
+
+		lockClass.unlock();
+		task(db);
+		lockClass.lock();
+	}
+}
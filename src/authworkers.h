@@ -0,0 +1,45 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_AUTHWORKERS_H
+#define FS_AUTHWORKERS_H
+
+#include "database.h"
+
+// Threads for the login work that blocks: the RSA decryption of the first packet and the account, ban and session
+// queries. Every thread owns a database connection of its own, so a burst of logins neither stalls the network threads
+// nor queues up on the connection of the game thread. Results are handed back by the tasks themselves, to the strand
+// of the connection or to the dispatcher for whatever touches the world.
+class AuthWorkers
+{
+public:
+	AuthWorkers() = default;
+	~AuthWorkers();
+
+	// non-copyable
+	AuthWorkers(const AuthWorkers&) = delete;
+	AuthWorkers& operator=(const AuthWorkers&) = delete;
+
+	// connects every worker to the database, returns false if one of the connections fails
+	bool start(size_t threadCount);
+	// runs the tasks that are still queued and waits for the threads
+	void shutdown();
+
+	// any thread, tasks added after shutdown are dropped
+	void addTask(std::function<void(Database&)> task);
+
+private:
+	void threadMain(Database& db);
+
+	std::list<Database> connections;
+	std::vector<std::thread> threads;
+
+	std::deque<std::function<void(Database&)>> tasks;
+	std::mutex taskLock;
+	std::condition_variable taskSignal;
+	bool stopping = false;
+};
+
+extern AuthWorkers g_authWorkers;
+
+#endif // FS_AUTHWORKERS_H
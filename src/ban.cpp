@@ -25,11 +25,14 @@ const std::optional<BanInfo> getAccountBanInfo(uint32_t accountId)
 	time_t expiresAt = result->getNumber<time_t>("expires_at");
 	if (expiresAt != 0 && std::chrono::system_clock::now() > std::chrono::system_clock::from_time_t(expiresAt)) {
 		// Move the ban to history if it has expired
-		g_databaseTasks.addTask(fmt::format(
-		    "INSERT INTO `account_ban_history` (`account_id`, `reason`, `banned_at`, `expired_at`, `banned_by`) VALUES ({:d}, {:s}, {:d}, {:d}, {:d})",
-		    accountId, db.escapeString(result->getString("reason")), result->getNumber<time_t>("banned_at"), expiresAt,
-		    result->getNumber<uint32_t>("banned_by")));
-		g_databaseTasks.addTask(fmt::format("DELETE FROM `account_bans` WHERE `account_id` = {:d}", accountId));
+		g_databaseTasks.addTask(
+		    fmt::format(
+		        "INSERT INTO `account_ban_history` (`account_id`, `reason`, `banned_at`, `expired_at`, `banned_by`) VALUES ({:d}, {:s}, {:d}, {:d}, {:d})",
+		        accountId, db.escapeString(result->getString("reason")), result->getNumber<time_t>("banned_at"),
+		        expiresAt, result->getNumber<uint32_t>("banned_by")),
+		    nullptr, false, DatabaseTasks::accountKey(accountId));
+		g_databaseTasks.addTask(fmt::format("DELETE FROM `account_bans` WHERE `account_id` = {:d}", accountId),
+		                        nullptr, false, DatabaseTasks::accountKey(accountId));
 		return std::nullopt;
 	}
 
@@ -45,14 +48,13 @@ const std::optional<BanInfo> getAccountBanInfo(uint32_t accountId)
 	return banInfo;
 }
 
-const std::optional<BanInfo> getIpBanInfo(const Connection::Address& clientIP)
+const std::optional<BanInfo> getIpBanInfo(const Connection::Address& clientIP,
+                                          Database& db /* = Database::getInstance()*/)
 {
 	if (clientIP.is_unspecified()) {
 		return std::nullopt;
 	}
 
-	Database& db = Database::getInstance();
-
 	DBResult_ptr result = db.storeQuery(fmt::format(
 	    "SELECT `reason`, `expires_at`, (SELECT `name` FROM `players` WHERE `id` = `banned_by`) AS `name` FROM `ip_bans` WHERE `ip` = INET6_ATON('{:s}')",
 	    clientIP.to_string()));
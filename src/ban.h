@@ -5,6 +5,7 @@
 #define FS_BAN_H
 
 #include "connection.h"
+#include "database.h"
 
 namespace IOBan {
 
@@ -16,7 +17,7 @@ struct BanInfo
 };
 
 const std::optional<BanInfo> getAccountBanInfo(uint32_t accountId);
-const std::optional<BanInfo> getIpBanInfo(const Connection::Address& clientIP);
+const std::optional<BanInfo> getIpBanInfo(const Connection::Address& clientIP, Database& db = Database::getInstance());
 bool isPlayerNamelocked(uint32_t playerId);
 
 }; // namespace IOBan
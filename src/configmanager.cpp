@@ -188,6 +188,7 @@ bool ConfigManager::load()
 	if (!loaded) { // info that must be loaded one time (unless we reset the modules involved)
 		boolean[BIND_ONLY_GLOBAL_ADDRESS] = getGlobalBoolean(L, "bindOnlyGlobalAddress", false);
 		boolean[OPTIMIZE_DATABASE] = getGlobalBoolean(L, "startupDatabaseOptimization", true);
+		boolean[MAP_TILE_GRID] = getGlobalBoolean(L, "mapTileGrid", false);
 
 		if (string[IP] == "") {
 			string[IP] = getGlobalString(L, "ip", "127.0.0.1");
@@ -211,6 +212,10 @@ bool ConfigManager::load()
 		integer[STATUS_PORT] = getGlobalNumber(L, "statusProtocolPort", 7171);
 		integer[HTTP_PORT] = getGlobalNumber(L, "httpPort", 8080);
 		integer[HTTP_WORKERS] = getGlobalNumber(L, "httpWorkers", 1);
+		integer[NETWORK_THREADS] = getGlobalNumber(L, "networkThreads", 1);
+		integer[AUTH_THREADS] = getGlobalNumber(L, "authThreads", 2);
+		integer[DATABASE_THREADS] = getGlobalNumber(L, "databaseThreads", 4);
+		integer[PATHFINDING_THREADS] = getGlobalNumber(L, "pathfindingThreads", 0);
 
 		integer[MARKET_OFFER_DURATION] = getGlobalNumber(L, "marketOfferDuration", 30 * 24 * 60 * 60);
 	}
@@ -252,6 +257,10 @@ bool ConfigManager::load()
 	boolean[TWO_FACTOR_AUTH] = getGlobalBoolean(L, "enableTwoFactorAuth", true);
 	boolean[CHECK_DUPLICATE_STORAGE_KEYS] = getGlobalBoolean(L, "checkDuplicateStorageKeys", false);
 	boolean[MONSTER_OVERSPAWN] = getGlobalBoolean(L, "monsterOverspawn", false);
+	boolean[WORLD_SAVE_ASYNC] = getGlobalBoolean(L, "worldSaveAsync", true);
+	boolean[INCREMENTAL_PLAYER_SAVE] = getGlobalBoolean(L, "incrementalPlayerSave", true);
+	boolean[PLAYER_ITEM_BLOBS] = getGlobalBoolean(L, "playerItemBlobs", false);
+	boolean[PACKET_COMPRESSION] = getGlobalBoolean(L, "packetCompression", true);
 
 	string[DEFAULT_PRIORITY] = getGlobalString(L, "defaultPriority", "high");
 	string[SERVER_NAME] = getGlobalString(L, "serverName", "");
@@ -302,6 +311,10 @@ bool ConfigManager::load()
 	integer[STAMINA_REGEN_PREMIUM] = getGlobalNumber(L, "timeToRegenMinutePremiumStamina", 6 * 60);
 	integer[PATHFINDING_INTERVAL] = getGlobalNumber(L, "pathfindingInterval", 200);
 	integer[PATHFINDING_DELAY] = getGlobalNumber(L, "pathfindingDelay", 300);
+	integer[WORLD_SAVE_SLICE_TIME] = getGlobalNumber(L, "worldSaveSliceTime", 10);
+	integer[PACKET_COMPRESSION_THRESHOLD] = getGlobalNumber(L, "packetCompressionThreshold", 128);
+	integer[PACKET_COMPRESSION_LEVEL] = getGlobalNumber(L, "packetCompressionLevel", 6);
+	integer[MAX_OUTBOUND_QUEUE_BYTES] = getGlobalNumber(L, "maxOutboundQueueBytes", 1024 * 1024);
 
 	expStages = loadXMLStages();
 	if (expStages.empty()) {
@@ -47,6 +47,11 @@ enum boolean_config_t
 	MANASHIELD_BREAKABLE,
 	CHECK_DUPLICATE_STORAGE_KEYS,
 	MONSTER_OVERSPAWN,
+	MAP_TILE_GRID,
+	WORLD_SAVE_ASYNC,
+	INCREMENTAL_PLAYER_SAVE,
+	PLAYER_ITEM_BLOBS,
+	PACKET_COMPRESSION,
 
 	LAST_BOOLEAN_CONFIG /* this must be the last one */
 };
@@ -123,6 +128,14 @@ enum integer_config_t
 	STAMINA_REGEN_PREMIUM,
 	PATHFINDING_INTERVAL,
 	PATHFINDING_DELAY,
+	PATHFINDING_THREADS,
+	WORLD_SAVE_SLICE_TIME,
+	NETWORK_THREADS,
+	PACKET_COMPRESSION_THRESHOLD,
+	PACKET_COMPRESSION_LEVEL,
+	MAX_OUTBOUND_QUEUE_BYTES,
+	AUTH_THREADS,
+	DATABASE_THREADS,
 
 	LAST_INTEGER_CONFIG /* this must be the last one */
 };
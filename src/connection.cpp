@@ -11,6 +11,34 @@
 #include "server.h"
 #include "tasks.h"
 
+namespace {
+
+// a network thread parses one packet at a time, the spare buffers are for packets that are still being read
+constexpr size_t MAX_SPARE_RECEIVE_BUFFERS = 4;
+
+thread_local std::vector<NetworkMessage_ptr> spareReceiveBuffers;
+
+NetworkMessage_ptr acquireReceiveBuffer()
+{
+	if (spareReceiveBuffers.empty()) {
+		return std::make_unique<NetworkMessage>();
+	}
+
+	auto msg = std::move(spareReceiveBuffers.back());
+	spareReceiveBuffers.pop_back();
+	return msg;
+}
+
+void releaseReceiveBuffer(NetworkMessage_ptr msg)
+{
+	if (spareReceiveBuffers.size() < MAX_SPARE_RECEIVE_BUFFERS) {
+		msg->reset();
+		spareReceiveBuffers.push_back(std::move(msg));
+	}
+}
+
+} // namespace
+
 Connection_ptr ConnectionManager::createConnection(boost::asio::io_context& io_context,
                                                    ConstServicePort_ptr servicePort)
 {
@@ -33,32 +61,66 @@ void ConnectionManager::closeAll()
 	std::lock_guard<std::mutex> lockClass(connectionManagerLock);
 
 	for (const auto& connection : connections) {
-		try {
-			boost::system::error_code error;
-			connection->socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, error);
-			connection->socket.close(error);
-		} catch (boost::system::system_error&) {
-		}
+		boost::asio::post(connection->strand, [connection]() { connection->closeSocket(); });
 	}
 	connections.clear();
 }
 
+void ConnectionManager::recordWrite(size_t messages, size_t bytes, std::chrono::microseconds latency)
+{
+	writeCount.fetch_add(1, std::memory_order_relaxed);
+	writtenMessages.fetch_add(messages, std::memory_order_relaxed);
+	writtenBytes.fetch_add(bytes, std::memory_order_relaxed);
+	writeLatency.fetch_add(latency.count(), std::memory_order_relaxed);
+}
+
+ConnectionManager::QueueStats ConnectionManager::getQueueStats()
+{
+	QueueStats stats{
+	    .shedMessages = shedMessages.load(std::memory_order_relaxed),
+	    .overflowDisconnects = overflowDisconnects.load(std::memory_order_relaxed),
+	};
+
+	std::lock_guard<std::mutex> lockClass(connectionManagerLock);
+	for (const auto& connection : connections) {
+		const uint64_t queued = connection->getQueuedBytes();
+		stats.queuedBytes += queued;
+		stats.maxQueuedBytes = std::max(stats.maxQueuedBytes, queued);
+	}
+	return stats;
+}
+
+ConnectionManager::WriteStats ConnectionManager::getWriteStats() const
+{
+	return {
+	    .writes = writeCount.load(std::memory_order_relaxed),
+	    .messages = writtenMessages.load(std::memory_order_relaxed),
+	    .bytes = writtenBytes.load(std::memory_order_relaxed),
+	    .latency = std::chrono::microseconds(writeLatency.load(std::memory_order_relaxed)),
+	};
+}
+
 // Connection
 
 Connection::Connection(boost::asio::io_context& io_context, ConstServicePort_ptr service_port) :
-    readTimer(io_context),
-    writeTimer(io_context),
+    strand(boost::asio::make_strand(io_context)),
+    readTimer(strand),
+    writeTimer(strand),
     service_port(std::move(service_port)),
-    socket(io_context),
+    socket(strand),
     timeConnected(time(nullptr))
 {}
 
 void Connection::close(bool force)
 {
-	// any thread
+	// any thread, runs right away when called on the strand
+	boost::asio::dispatch(strand, [thisPtr = shared_from_this(), force]() { thisPtr->internalClose(force); });
+}
+
+void Connection::internalClose(bool force)
+{
 	ConnectionManager::getInstance().releaseConnection(shared_from_this());
 
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
 	connectionState = CONNECTION_STATE_DISCONNECTED;
 
 	if (protocol) {
@@ -103,13 +165,6 @@ void Connection::accept()
 		connectionState = CONNECTION_STATE_REQUEST_CHARLIST;
 	}
 
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
-
-	boost::system::error_code error;
-	if (auto endpoint = socket.remote_endpoint(error); !error) {
-		remoteAddress = endpoint.address();
-	}
-
 	try {
 		readTimer.expires_after(std::chrono::seconds(CONNECTION_READ_TIMEOUT));
 		readTimer.async_wait(
@@ -122,7 +177,7 @@ void Connection::accept()
 		                        ? 1
 		                        : NetworkMessage::HEADER_LENGTH;
 		boost::asio::async_read(
-		    socket, boost::asio::buffer(msg.getBuffer(), bufferLength),
+		    socket, boost::asio::buffer(header.data(), bufferLength),
 		    [thisPtr = shared_from_this()](const boost::system::error_code& error, auto /*bytes_transferred*/) {
 			    thisPtr->parseHeader(error);
 		    });
@@ -134,7 +189,6 @@ void Connection::accept()
 
 void Connection::parseHeader(const boost::system::error_code& error)
 {
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
 	readTimer.cancel();
 
 	if (error) {
@@ -152,9 +206,7 @@ void Connection::parseHeader(const boost::system::error_code& error)
 	}
 
 	if (!receivedLastChar && connectionState == CONNECTION_STATE_GAMEWORLD_AUTH) {
-		uint8_t* msgBuffer = msg.getBuffer();
-
-		if (!receivedName && msgBuffer[1] == 0x00) {
+		if (!receivedName && header[1] == 0x00) {
 			receivedLastChar = true;
 		} else {
 			if (!receivedName) {
@@ -164,7 +216,7 @@ void Connection::parseHeader(const boost::system::error_code& error)
 				return;
 			}
 
-			if (msgBuffer[0] == 0x0A) {
+			if (header[0] == 0x0A) {
 				receivedLastChar = true;
 			}
 
@@ -182,7 +234,7 @@ void Connection::parseHeader(const boost::system::error_code& error)
 		packetsSent = 0;
 	}
 
-	uint16_t size = msg.getLengthHeader();
+	uint16_t size = static_cast<uint16_t>(header[0] | header[1] << 8);
 	if (size == 0 || size >= NETWORKMESSAGE_MAXSIZE - 16) {
 		close(FORCE_CLOSE);
 		return;
@@ -196,9 +248,11 @@ void Connection::parseHeader(const boost::system::error_code& error)
 		    });
 
 		// Read packet content
-		msg.setLength(size + NetworkMessage::HEADER_LENGTH);
+		msg = acquireReceiveBuffer();
+		std::copy(header.begin(), header.end(), msg->getBuffer());
+		msg->setLength(size + NetworkMessage::HEADER_LENGTH);
 		boost::asio::async_read(
-		    socket, boost::asio::buffer(msg.getBodyBuffer(), size),
+		    socket, boost::asio::buffer(msg->getBodyBuffer(), size),
 		    [thisPtr = shared_from_this()](const boost::system::error_code& error, auto /*bytes_transferred*/) {
 			    thisPtr->parsePacket(error);
 		    });
@@ -210,7 +264,6 @@ void Connection::parseHeader(const boost::system::error_code& error)
 
 void Connection::parsePacket(const boost::system::error_code& error)
 {
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
 	readTimer.cancel();
 
 	if (error) {
@@ -221,26 +274,26 @@ void Connection::parsePacket(const boost::system::error_code& error)
 	}
 
 	// Read potential checksum bytes
-	msg.get<uint32_t>();
+	msg->get<uint32_t>();
 
 	if (!receivedFirst) {
 		receivedFirst = true;
 
 		if (!protocol) {
 			// Skip deprecated checksum bytes (with clients that aren't using it in mind)
-			uint16_t len = msg.getLength();
+			uint16_t len = msg->getLength();
 			if (len < 280 && len != 151) {
-				msg.skipBytes(-NetworkMessage::CHECKSUM_LENGTH);
+				msg->skipBytes(-NetworkMessage::CHECKSUM_LENGTH);
 			}
 
 			// Game protocol has already been created at this point
-			protocol = service_port->make_protocol(msg, shared_from_this());
+			protocol = service_port->make_protocol(*msg, shared_from_this());
 			if (!protocol) {
 				close(FORCE_CLOSE);
 				return;
 			}
 		} else {
-			msg.skipBytes(1); // Skip protocol ID
+			msg->skipBytes(1); // Skip protocol ID
 		}
 
 		protocol->onRecvFirstMessage(msg);
@@ -248,6 +301,10 @@ void Connection::parsePacket(const boost::system::error_code& error)
 		protocol->onRecvMessage(msg); // Send the packet to the current protocol
 	}
 
+	if (msg) {
+		releaseReceiveBuffer(std::move(msg));
+	}
+
 	try {
 		readTimer.expires_after(std::chrono::seconds(CONNECTION_READ_TIMEOUT));
 		readTimer.async_wait(
@@ -257,7 +314,7 @@ void Connection::parsePacket(const boost::system::error_code& error)
 
 		// Wait to the next packet
 		boost::asio::async_read(
-		    socket, boost::asio::buffer(msg.getBuffer(), NetworkMessage::HEADER_LENGTH),
+		    socket, boost::asio::buffer(header.data(), NetworkMessage::HEADER_LENGTH),
 		    [thisPtr = shared_from_this()](const boost::system::error_code& error, auto /*bytes_transferred*/) {
 			    thisPtr->parseHeader(error);
 		    });
@@ -267,30 +324,73 @@ void Connection::parsePacket(const boost::system::error_code& error)
 	}
 }
 
+bool Connection::isCongested() const
+{
+	const auto maxQueuedBytes = static_cast<size_t>(getNumber(ConfigManager::MAX_OUTBOUND_QUEUE_BYTES));
+	return maxQueuedBytes != 0 && getQueuedBytes() > maxQueuedBytes / 2;
+}
+
 void Connection::send(const OutputMessage_ptr& msg)
 {
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
-	if (connectionState == CONNECTION_STATE_DISCONNECTED) {
+	// any thread, the message is queued on the strand
+	const size_t bytes = msg->getLength();
+	const size_t queued = queuedBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	const auto maxQueuedBytes = static_cast<size_t>(getNumber(ConfigManager::MAX_OUTBOUND_QUEUE_BYTES));
+	if (maxQueuedBytes != 0 && queued > maxQueuedBytes) {
+		queuedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+
+		// the client does not read what it gets, everything sent from now on would only pile up
+		if (!queueOverflowed.exchange(true)) {
+			std::cout << getIP() << " disconnected for exceeding the outbound queue limit." << std::endl;
+			ConnectionManager::getInstance().recordOverflow();
+			close(FORCE_CLOSE);
+		}
 		return;
 	}
 
-	bool noPendingWrite = messageQueue.empty();
-	messageQueue.emplace_back(msg);
-	if (noPendingWrite) {
-		try {
-			boost::asio::post(socket.get_executor(),
-			                  [thisPtr = shared_from_this(), msg] { thisPtr->internalSend(msg); });
-		} catch (const boost::system::system_error& e) {
-			std::cout << "[Network error - Connection::send] " << e.what() << std::endl;
-			messageQueue.clear();
-			close(FORCE_CLOSE);
+	boost::asio::post(strand, [thisPtr = shared_from_this(), msg, bytes]() {
+		if (thisPtr->connectionState == CONNECTION_STATE_DISCONNECTED) {
+			thisPtr->queuedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+			return;
 		}
-	}
+
+		// Messages behind the ones being written are not encrypted yet. A message that fits is appended to the last
+		// of them, so a client that falls behind does not hold a mostly empty buffer for every message.
+		auto& messageQueue = thisPtr->messageQueue;
+		if (messageQueue.size() > thisPtr->writingMessages &&
+		    messageQueue.back()->getLength() + bytes <= NetworkMessage::MAX_PROTOCOL_BODY_LENGTH) {
+			messageQueue.back()->append(msg);
+			return;
+		}
+
+		if (messageQueue.full()) {
+			messageQueue.set_capacity(messageQueue.capacity() * 2);
+		}
+		messageQueue.push_back(msg);
+
+		if (thisPtr->writingMessages == 0) {
+			thisPtr->internalSend();
+		}
+	});
 }
 
-void Connection::internalSend(const OutputMessage_ptr& msg)
+void Connection::internalSend()
 {
-	protocol->onSendMessage(msg);
+	// everything queued goes out with a single write, the messages are encrypted in the order they were queued
+	size_t bytes = 0;
+	std::chrono::microseconds latency{0};
+	const auto now = std::chrono::steady_clock::now();
+	writeBuffers.clear();
+	for (const auto& msg : messageQueue) {
+		latency += std::chrono::duration_cast<std::chrono::microseconds>(now - msg->getCreationTime());
+		writingBytes += msg->getLength();
+		protocol->onSendMessage(msg);
+		writeBuffers.emplace_back(msg->getOutputBuffer(), msg->getLength());
+		bytes += msg->getLength();
+	}
+	writingMessages = messageQueue.size();
+	ConnectionManager::getInstance().recordWrite(writingMessages, bytes, latency);
+
 	try {
 		writeTimer.expires_after(std::chrono::seconds(CONNECTION_WRITE_TIMEOUT));
 		writeTimer.async_wait(
@@ -299,7 +399,7 @@ void Connection::internalSend(const OutputMessage_ptr& msg)
 		    });
 
 		boost::asio::async_write(
-		    socket, boost::asio::buffer(msg->getOutputBuffer(), msg->getLength()),
+		    socket, writeBuffers,
 		    [thisPtr = shared_from_this()](const boost::system::error_code& error, auto /*bytes_transferred*/) {
 			    thisPtr->onWriteOperation(error);
 		    });
@@ -311,18 +411,23 @@ void Connection::internalSend(const OutputMessage_ptr& msg)
 
 void Connection::onWriteOperation(const boost::system::error_code& error)
 {
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
 	writeTimer.cancel();
-	messageQueue.pop_front();
+	messageQueue.erase_begin(writingMessages);
+	writingMessages = 0;
+	queuedBytes.fetch_sub(writingBytes, std::memory_order_relaxed);
+	writingBytes = 0;
 
 	if (error) {
+		for (const auto& msg : messageQueue) {
+			queuedBytes.fetch_sub(msg->getLength(), std::memory_order_relaxed);
+		}
 		messageQueue.clear();
 		close(FORCE_CLOSE);
 		return;
 	}
 
 	if (!messageQueue.empty()) {
-		internalSend(messageQueue.front());
+		internalSend();
 	} else if (connectionState == CONNECTION_STATE_DISCONNECTED) {
 		closeSocket();
 	}
@@ -41,6 +41,23 @@ using ConstServicePort_ptr = std::shared_ptr<const ServicePort>;
 class ConnectionManager
 {
 public:
+	struct WriteStats
+	{
+		uint64_t writes = 0;
+		uint64_t messages = 0;
+		uint64_t bytes = 0;
+		// summed over all messages
+		std::chrono::microseconds latency{0};
+	};
+
+	struct QueueStats
+	{
+		uint64_t queuedBytes = 0;
+		uint64_t maxQueuedBytes = 0;
+		uint64_t shedMessages = 0;
+		uint64_t overflowDisconnects = 0;
+	};
+
 	static ConnectionManager& getInstance()
 	{
 		static ConnectionManager instance;
@@ -51,11 +68,28 @@ public:
 	void releaseConnection(const Connection_ptr& connection);
 	void closeAll();
 
+	// any network thread, once for every write that is started
+	void recordWrite(size_t messages, size_t bytes, std::chrono::microseconds latency);
+	WriteStats getWriteStats() const;
+
+	// any thread, once for every update a congested connection did not get and for every connection that overflowed
+	void recordShed() { shedMessages.fetch_add(1, std::memory_order_relaxed); }
+	void recordOverflow() { overflowDisconnects.fetch_add(1, std::memory_order_relaxed); }
+	QueueStats getQueueStats();
+
 private:
 	ConnectionManager() = default;
 
 	std::unordered_set<Connection_ptr> connections;
 	std::mutex connectionManagerLock;
+
+	std::atomic<uint64_t> writeCount{0};
+	std::atomic<uint64_t> writtenMessages{0};
+	std::atomic<uint64_t> writtenBytes{0};
+	std::atomic<int64_t> writeLatency{0};
+
+	std::atomic<uint64_t> shedMessages{0};
+	std::atomic<uint64_t> overflowDisconnects{0};
 };
 
 class Connection : public std::enable_shared_from_this<Connection>
@@ -83,8 +117,20 @@ public:
 
 	void send(const OutputMessage_ptr& msg);
 
+	// any thread, the bytes that were handed to send and are not written yet
+	size_t getQueuedBytes() const { return queuedBytes.load(std::memory_order_relaxed); }
+	// any thread, half of maxOutboundQueueBytes is used and updates that later ones supersede may be left out
+	bool isCongested() const;
+
 	const Address& getIP() const { return remoteAddress; };
 
+	// any thread, runs the handler on the strand of the connection
+	template <typename Handler>
+	void post(Handler&& handler)
+	{
+		boost::asio::post(strand, std::forward<Handler>(handler));
+	}
+
 private:
 	void parseHeader(const boost::system::error_code& error);
 	void parsePacket(const boost::system::error_code& error);
@@ -93,20 +139,33 @@ private:
 
 	static void handleTimeout(ConnectionWeak_ptr connectionWeak, const boost::system::error_code& error);
 
+	void internalClose(bool force);
 	void closeSocket();
-	void internalSend(const OutputMessage_ptr& msg);
+	void internalSend();
 
 	boost::asio::ip::tcp::socket& getSocket() { return socket; }
 	friend class ServicePort;
 
-	NetworkMessage msg;
+	// An idle connection only holds the length header of its next packet. The packet is read into a buffer of the
+	// network thread and the buffer goes back once the packet is parsed, unless the protocol took it over.
+	std::array<uint8_t, NetworkMessage::HEADER_LENGTH> header;
+	NetworkMessage_ptr msg;
+
+	// every handler of the connection runs on this strand, other threads post their calls to it
+	boost::asio::strand<boost::asio::io_context::executor_type> strand;
 
 	boost::asio::steady_timer readTimer;
 	boost::asio::steady_timer writeTimer;
 
-	std::recursive_mutex connectionLock;
+	// The first writingMessages messages are being written, the ones queued in the meantime follow them and are all
+	// written together by the next write. The buffer grows when it is full, it never shrinks.
+	boost::circular_buffer<OutputMessage_ptr> messageQueue{16};
+	std::vector<boost::asio::const_buffer> writeBuffers;
+	size_t writingMessages = 0;
+	size_t writingBytes = 0;
 
-	std::list<OutputMessage_ptr> messageQueue;
+	std::atomic<size_t> queuedBytes{0};
+	std::atomic<bool> queueOverflowed{false};
 
 	ConstServicePort_ptr service_port;
 	Protocol_ptr protocol;
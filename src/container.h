@@ -136,6 +136,7 @@ private:
 	void updateItemWeight(int32_t diff);
 
 	friend class ContainerIterator;
+	friend class IOLoginData;
 	friend class IOMapSerialize;
 };
 
@@ -21,6 +21,27 @@ double Creature::speedC = -4795.01;
 extern Game g_game;
 extern CreatureEvents* g_creatureEvents;
 
+std::optional<bool> PlannedPath::take(const Position& start, const Position& target, const FindPathParams& params,
+                                      std::vector<Direction>& walkDirs,
+                                      const std::function<bool(const Position&)>& isWalkable)
+{
+	if (startPos != start || targetPos != target || fpp != params) {
+		return std::nullopt;
+	}
+
+	// a creature or an item may have blocked a tile of the path after the search
+	Position pos = startPos;
+	for (Direction dir : dirList) {
+		pos = getNextPosition(dir, pos);
+		if (!isWalkable(pos)) {
+			return std::nullopt;
+		}
+	}
+
+	walkDirs = std::move(dirList);
+	return found;
+}
+
 Creature::Creature() { onIdleStatus(); }
 
 Creature::~Creature()
@@ -347,7 +368,18 @@ void Creature::updateFollowCreaturePath(FindPathParams& fpp)
 {
 	listWalkDir.clear();
 
-	if (getPathTo(followCreature->getPosition(), listWalkDir, fpp)) {
+	std::optional<bool> found;
+	if (plannedPath) {
+		found = plannedPath->take(getPosition(), followCreature->getPosition(), fpp, listWalkDir,
+		                          [this](const Position& pos) { return g_game.map.canWalkTo(*this, pos) != nullptr; });
+		plannedPath.reset();
+	}
+
+	if (!found) {
+		found = getPathTo(followCreature->getPosition(), listWalkDir, fpp);
+	}
+
+	if (*found) {
 		hasFollowPath = true;
 		startAutoWalk();
 	} else {
@@ -51,6 +51,25 @@ struct FindPathParams
 	int32_t maxSearchDist = 0;
 	int32_t minTargetDist = -1;
 	int32_t maxTargetDist = -1;
+
+	bool operator==(const FindPathParams&) const = default;
+};
+
+// Result of a path search made ahead of time, see Game::updateCreaturesPath
+struct PlannedPath
+{
+	Position startPos;
+	Position targetPos;
+	FindPathParams fpp;
+	std::vector<Direction> dirList;
+	bool found = false;
+
+	// Moves the planned directions into walkDirs and returns whether a path was found. Returns nothing if the path was
+	// not searched from start to target with these parameters, or if isWalkable rejects a position of the path because
+	// the map changed since the search, then the caller has to search it.
+	std::optional<bool> take(const Position& start, const Position& target, const FindPathParams& params,
+	                         std::vector<Direction>& walkDirs,
+	                         const std::function<bool(const Position&)>& isWalkable);
 };
 
 static constexpr int32_t EVENT_CREATURECOUNT = 10;
@@ -191,6 +210,8 @@ public:
 	void addEventWalk(bool firstStep = false);
 	void stopEventWalk();
 	virtual void goToFollowCreature() = 0;
+	// true if goToFollowCreature will step towards the follow creature without searching a path
+	virtual bool walksByDistanceStep() const { return false; }
 	void updateFollowCreaturePath(FindPathParams& fpp);
 
 	// walk events
@@ -393,6 +414,8 @@ protected:
 	CreatureIconHashMap creatureIcons;
 
 	std::vector<Direction> listWalkDir;
+	// used instead of searching again by the next updateFollowCreaturePath, if it is still valid
+	std::optional<PlannedPath> plannedPath;
 
 	Tile* tile = nullptr;
 	Creature* attackedCreature = nullptr;
@@ -410,6 +433,9 @@ protected:
 	uint32_t lastHitCreatureId = 0;
 	uint32_t blockCount = 0;
 	uint32_t blockTicks = 0;
+	// time that passes until the next check of the creature, differs from the think interval once after its check
+	// bucket changed
+	uint32_t checkInterval = EVENT_CREATURE_THINK_INTERVAL;
 	uint32_t lastStepCost = 1;
 	uint32_t baseSpeed = 220;
 	int32_t varSpeed = 0;
@@ -64,18 +64,105 @@ static bool isLostConnectionError(const unsigned error)
 	       error == 1053 /*ER_SERVER_SHUTDOWN*/ || error == CR_CONNECTION_ERROR;
 }
 
-static bool executeQuery(tfs::detail::Mysql_ptr& handle, std::string_view query, const bool retryIfLostConnection)
+static bool isLockConflictError(const unsigned error)
 {
-	while (mysql_real_query(handle.get(), query.data(), query.length()) != 0) {
-		std::cout << "[Error - mysql_real_query] Query: " << query.substr(0, 256) << std::endl
-		          << "Message: " << mysql_error(handle.get()) << std::endl;
-		const unsigned error = mysql_errno(handle.get());
-		if (!isLostConnectionError(error) || !retryIfLostConnection) {
-			return false;
+	return error == 1205 /*ER_LOCK_WAIT_TIMEOUT*/ || error == 1213 /*ER_LOCK_DEADLOCK*/;
+}
+
+static DBResult_ptr fetchStatementResult(MYSQL_STMT* stmt)
+{
+	tfs::detail::MysqlResult_ptr metadata{mysql_stmt_result_metadata(stmt)};
+	if (!metadata) {
+		return nullptr;
+	}
+
+	if (mysql_stmt_store_result(stmt) != 0) {
+		std::cout << "[Error - mysql_stmt_store_result] Message: " << mysql_stmt_error(stmt) << std::endl;
+		return nullptr;
+	}
+
+	struct Column
+	{
+		int64_t integer = 0;
+		double real = 0;
+		unsigned long length = 0;
+		std::remove_pointer_t<decltype(MYSQL_BIND::is_null)> isNull = 0;
+	};
+
+	// numbers are received into their buffer as they are, strings and blobs are fetched once their length is known
+	const unsigned columnCount = mysql_num_fields(metadata.get());
+	const MYSQL_FIELD* fields = mysql_fetch_fields(metadata.get());
+	std::vector<Column> columns(columnCount);
+	std::vector<MYSQL_BIND> binds(columnCount);
+	for (unsigned i = 0; i < columnCount; ++i) {
+		MYSQL_BIND& bind = binds[i];
+		switch (fields[i].type) {
+			case MYSQL_TYPE_TINY:
+			case MYSQL_TYPE_SHORT:
+			case MYSQL_TYPE_INT24:
+			case MYSQL_TYPE_LONG:
+			case MYSQL_TYPE_LONGLONG:
+			case MYSQL_TYPE_YEAR:
+				bind.buffer_type = MYSQL_TYPE_LONGLONG;
+				bind.buffer = &columns[i].integer;
+				bind.is_unsigned = (fields[i].flags & UNSIGNED_FLAG) != 0;
+				break;
+
+			case MYSQL_TYPE_FLOAT:
+			case MYSQL_TYPE_DOUBLE:
+				bind.buffer_type = MYSQL_TYPE_DOUBLE;
+				bind.buffer = &columns[i].real;
+				break;
+
+			default:
+				bind.buffer_type = MYSQL_TYPE_STRING;
+				break;
 		}
-		handle = connectToDatabase(true);
+		bind.length = &columns[i].length;
+		bind.is_null = &columns[i].isNull;
 	}
-	return true;
+
+	std::vector<std::vector<tfs::detail::StatementValue>> rows;
+	if (mysql_stmt_bind_result(stmt, binds.data()) == 0) {
+		int status;
+		while ((status = mysql_stmt_fetch(stmt)) == 0 || status == MYSQL_DATA_TRUNCATED) {
+			auto& row = rows.emplace_back(columnCount);
+			for (unsigned i = 0; i < columnCount; ++i) {
+				const Column& column = columns[i];
+				if (column.isNull) {
+					continue;
+				}
+
+				if (binds[i].buffer_type == MYSQL_TYPE_LONGLONG) {
+					if (binds[i].is_unsigned) {
+						row[i] = static_cast<uint64_t>(column.integer);
+					} else {
+						row[i] = column.integer;
+					}
+				} else if (binds[i].buffer_type == MYSQL_TYPE_DOUBLE) {
+					row[i] = column.real;
+				} else {
+					std::string value(column.length, '\0');
+					if (column.length != 0) {
+						MYSQL_BIND fetch{};
+						fetch.buffer_type = MYSQL_TYPE_STRING;
+						fetch.buffer = value.data();
+						fetch.buffer_length = column.length;
+						mysql_stmt_fetch_column(stmt, &fetch, i, 0);
+					}
+					row[i] = std::move(value);
+				}
+			}
+		}
+	} else {
+		std::cout << "[Error - mysql_stmt_bind_result] Message: " << mysql_stmt_error(stmt) << std::endl;
+	}
+	mysql_stmt_free_result(stmt);
+
+	if (rows.empty()) {
+		return nullptr;
+	}
+	return std::make_shared<DBResult>(std::move(metadata), std::move(rows));
 }
 
 bool Database::connect()
@@ -85,6 +172,7 @@ bool Database::connect()
 		return false;
 	}
 
+	statements.clear();
 	handle = std::move(newHandle);
 	DBResult_ptr result = storeQuery("SHOW VARIABLES LIKE 'max_allowed_packet'");
 	if (result) {
@@ -120,10 +208,41 @@ bool Database::commit()
 	return result;
 }
 
+void Database::noteError(unsigned error)
+{
+	if (isLockConflictError(error)) {
+		lockConflict = true;
+	}
+}
+
+void Database::reconnect()
+{
+	// the prepared statements belong to the lost connection
+	statements.clear();
+	handle = connectToDatabase(true);
+}
+
+bool Database::sendQuery(std::string_view query)
+{
+	while (mysql_real_query(handle.get(), query.data(), query.length()) != 0) {
+		std::cout << "[Error - mysql_real_query] Query: " << query.substr(0, 256) << std::endl
+		          << "Message: " << mysql_error(handle.get()) << std::endl;
+		const unsigned error = mysql_errno(handle.get());
+		if (!isLostConnectionError(error) || !retryQueries) {
+			return false;
+		}
+		reconnect();
+	}
+	return true;
+}
+
 bool Database::executeQuery(const std::string& query)
 {
 	std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
-	auto success = ::executeQuery(handle, query, retryQueries);
+	auto success = sendQuery(query);
+	if (!success) {
+		noteError(mysql_errno(handle.get()));
+	}
 
 	// executeQuery can be called with command that produces result (e.g. SELECT)
 	// we have to store that result, even though we do not need it, otherwise handle will get blocked
@@ -138,7 +257,8 @@ DBResult_ptr Database::storeQuery(std::string_view query)
 	std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
 
 retry:
-	if (!::executeQuery(handle, query, retryQueries) && !retryQueries) {
+	if (!sendQuery(query) && !retryQueries) {
+		noteError(mysql_errno(handle.get()));
 		return nullptr;
 	}
 
@@ -163,6 +283,156 @@ retry:
 	return result;
 }
 
+bool Database::streamQuery(std::string_view query, const std::function<void(const DBResult&)>& visitor)
+{
+	std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
+
+retry:
+	if (!sendQuery(query) && !retryQueries) {
+		return false;
+	}
+
+	tfs::detail::MysqlResult_ptr res{mysql_use_result(handle.get())};
+	if (!res) {
+		std::cout << "[Error - mysql_use_result] Query: " << query << std::endl
+		          << "Message: " << mysql_error(handle.get()) << std::endl;
+		const unsigned error = mysql_errno(handle.get());
+		if (!isLostConnectionError(error) || !retryQueries) {
+			return false;
+		}
+		goto retry;
+	}
+
+	DBResult result{std::move(res)};
+	while (result.hasNext()) {
+		visitor(result);
+		result.next();
+	}
+
+	// the rows also end when reading them fails
+	if (mysql_errno(handle.get()) != 0) {
+		std::cout << "[Error - mysql_fetch_row] Query: " << query << std::endl
+		          << "Message: " << mysql_error(handle.get()) << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool Database::runBatch(std::string_view batch)
+{
+	if (mysql_real_query(handle.get(), batch.data(), batch.length()) != 0) {
+		std::cout << "[Error - mysql_real_query] Batch of " << batch.length() << " bytes" << std::endl
+		          << "Message: " << mysql_error(handle.get()) << std::endl;
+		noteError(mysql_errno(handle.get()));
+		return false;
+	}
+
+	// every command of the batch has a result, they all have to be read before the connection takes the next query
+	int status;
+	do {
+		mysql_free_result(mysql_store_result(handle.get()));
+	} while ((status = mysql_next_result(handle.get())) == 0);
+
+	if (status > 0) {
+		std::cout << "[Error - mysql_next_result] Batch of " << batch.length() << " bytes" << std::endl
+		          << "Message: " << mysql_error(handle.get()) << std::endl;
+		noteError(mysql_errno(handle.get()));
+		return false;
+	}
+	return true;
+}
+
+bool Database::executeBatch(const std::vector<std::string_view>& queries)
+{
+	std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
+
+	// only for the batch, a query that smuggles in a second command must not run anywhere else
+	if (mysql_set_server_option(handle.get(), MYSQL_OPTION_MULTI_STATEMENTS_ON) != 0) {
+		std::cout << "[Error - mysql_set_server_option] Message: " << mysql_error(handle.get()) << std::endl;
+		return false;
+	}
+
+	bool success = true;
+	std::string batch;
+	for (std::string_view query : queries) {
+		if (!batch.empty() && batch.length() + query.length() + 1 >= maxPacketSize) {
+			success = runBatch(batch);
+			batch.clear();
+			if (!success) {
+				break;
+			}
+		}
+
+		if (!batch.empty()) {
+			batch.push_back(';');
+		}
+		batch.append(query);
+	}
+
+	if (success && !batch.empty()) {
+		success = runBatch(batch);
+	}
+
+	mysql_set_server_option(handle.get(), MYSQL_OPTION_MULTI_STATEMENTS_OFF);
+	return success;
+}
+
+MYSQL_STMT* Database::prepareStatement(std::string_view statement, unsigned& error)
+{
+	if (auto it = statements.find(statement); it != statements.end()) {
+		return it->second.get();
+	}
+
+	tfs::detail::MysqlStatement_ptr stmt{mysql_stmt_init(handle.get())};
+	if (!stmt) {
+		error = mysql_errno(handle.get());
+		std::cout << "[Error - mysql_stmt_init] Message: " << mysql_error(handle.get()) << std::endl;
+		return nullptr;
+	}
+
+	if (mysql_stmt_prepare(stmt.get(), statement.data(), statement.length()) != 0) {
+		error = mysql_stmt_errno(stmt.get());
+		std::cout << "[Error - mysql_stmt_prepare] Query: " << statement.substr(0, 256) << std::endl
+		          << "Message: " << mysql_stmt_error(stmt.get()) << std::endl;
+		return nullptr;
+	}
+	return statements.emplace(statement, std::move(stmt)).first->second.get();
+}
+
+bool Database::runStatement(std::string_view statement, MYSQL_BIND* params, DBResult_ptr* result)
+{
+	std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
+
+	MYSQL_STMT* stmt;
+	while (true) {
+		unsigned error = 0;
+		stmt = prepareStatement(statement, error);
+		if (stmt) {
+			if (mysql_stmt_bind_param(stmt, params) == 0 && mysql_stmt_execute(stmt) == 0) {
+				break;
+			}
+
+			error = mysql_stmt_errno(stmt);
+			std::cout << "[Error - mysql_stmt_execute] Query: " << statement.substr(0, 256) << std::endl
+			          << "Message: " << mysql_stmt_error(stmt) << std::endl;
+		}
+
+		if (!isLostConnectionError(error) || !retryQueries) {
+			noteError(error);
+			return false;
+		}
+		reconnect();
+	}
+
+	if (result) {
+		*result = fetchStatementResult(stmt);
+	} else {
+		// a result set that nobody reads would block the statement
+		mysql_stmt_free_result(stmt);
+	}
+	return true;
+}
+
 std::string Database::escapeBlob(const char* s, uint32_t length) const
 {
 	// the worst case is 2n + 1
@@ -192,37 +462,109 @@ DBResult::DBResult(tfs::detail::MysqlResult_ptr&& res) : handle{std::move(res)}
 		listNames[field->name] = i++;
 		field = mysql_fetch_field(handle.get());
 	}
+	columnCount = i;
 
 	row = mysql_fetch_row(handle.get());
+	lengths = mysql_fetch_lengths(handle.get());
 }
 
-std::string_view DBResult::getString(std::string_view column) const
+DBResult::DBResult(tfs::detail::MysqlResult_ptr&& metadata,
+                   std::vector<std::vector<tfs::detail::StatementValue>>&& rows) :
+    handle{std::move(metadata)}, statementRows{std::move(rows)}
+{
+	size_t i = 0;
+
+	MYSQL_FIELD* field = mysql_fetch_field(handle.get());
+	while (field) {
+		listNames[field->name] = i++;
+		field = mysql_fetch_field(handle.get());
+	}
+	columnCount = i;
+}
+
+size_t DBResult::getColumnIndex(std::string_view column) const
 {
 	auto it = listNames.find(column);
 	if (it == listNames.end()) {
-		std::cout << "[Error - DBResult::getString] Column '" << column << "' does not exist in result set."
+		std::cout << "[Error - DBResult::getColumnIndex] Column '" << column << "' doesn't exist in the result set"
 		          << std::endl;
+		// the accessors return nothing for it
+		return columnCount;
+	}
+	return it->second;
+}
+
+std::string_view DBResult::getString(size_t column) const
+{
+	if (column >= columnCount) {
 		return {};
 	}
 
-	if (!row[it->second]) {
+	if (!statementRows.empty()) {
+		const auto& value = statementRows[statementRow][column];
+		if (auto text = std::get_if<std::string>(&value)) {
+			return *text;
+		} else if (std::holds_alternative<std::monostate>(value)) {
+			return {};
+		}
+
+		// numbers come as text from a query, so they are formatted the same way here, once per field
+		auto it = formattedValues.find({statementRow, column});
+		if (it == formattedValues.end()) {
+			it = formattedValues.emplace(std::make_pair(statementRow, column), tfs::detail::formatNumber(value)).first;
+		}
+		return it->second;
+	}
+
+	if (!row[column]) {
 		return {};
 	}
 
-	auto size = mysql_fetch_lengths(handle.get())[it->second];
-	return {row[it->second], size};
+	return {row[column], lengths[column]};
 }
 
-bool DBResult::hasNext() const { return row; }
+bool DBResult::hasNext() const
+{
+	if (!statementRows.empty()) {
+		return statementRow < statementRows.size();
+	}
+	return row;
+}
 
 bool DBResult::next()
 {
+	if (!statementRows.empty()) {
+		return ++statementRow < statementRows.size();
+	}
+
 	row = mysql_fetch_row(handle.get());
-	return row;
+	if (!row) {
+		return false;
+	}
+
+	lengths = mysql_fetch_lengths(handle.get());
+	return true;
 }
 
 DBInsert::DBInsert(std::string query) : query(std::move(query)) { this->length = this->query.length(); }
 
+DBInsert::DBInsert(std::string query, std::vector<std::string>& queries) : DBInsert(std::move(query))
+{
+	this->queries = &queries;
+}
+
+void DBInsert::upsert(const std::vector<std::string_view>& columns)
+{
+	upsertQuery = " ON DUPLICATE KEY UPDATE ";
+	for (size_t i = 0; i < columns.size(); ++i) {
+		if (i != 0) {
+			upsertQuery.append(", ");
+		}
+		upsertQuery.append(fmt::format("`{0:s}` = VALUES(`{0:s}`)", columns[i]));
+	}
+	length = query.length() + upsertQuery.length();
+}
+
 bool DBInsert::addRow(const std::string& row)
 {
 	// adds new row to buffer
@@ -260,9 +602,14 @@ bool DBInsert::execute()
 		return true;
 	}
 
-	// executes buffer
-	bool res = Database::getInstance().executeQuery(query + values);
+	bool res = true;
+	if (queries) {
+		queries->push_back(query + values + upsertQuery);
+	} else {
+		// executes buffer
+		res = Database::getInstance().executeQuery(query + values + upsertQuery);
+	}
 	values.clear();
-	length = query.length();
+	length = query.length() + upsertQuery.length();
 	return res;
 }
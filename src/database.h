@@ -4,21 +4,117 @@
 #ifndef FS_DATABASE_H
 #define FS_DATABASE_H
 
-#include "pugicast.h"
+#include <charconv>
 
 class DBResult;
 using DBResult_ptr = std::shared_ptr<DBResult>;
 
+// binary data for a prepared statement, sent as a BLOB instead of a string in the connection charset
+struct DBBlob
+{
+	std::string data;
+};
+
 namespace tfs::detail {
 
 struct MysqlDeleter
 {
 	void operator()(MYSQL* handle) const { mysql_close(handle); }
 	void operator()(MYSQL_RES* handle) const { mysql_free_result(handle); }
+	void operator()(MYSQL_STMT* handle) const { mysql_stmt_close(handle); }
 };
 
 using Mysql_ptr = std::unique_ptr<MYSQL, MysqlDeleter>;
 using MysqlResult_ptr = std::unique_ptr<MYSQL_RES, MysqlDeleter>;
+using MysqlStatement_ptr = std::unique_ptr<MYSQL_STMT, MysqlDeleter>;
+
+// a column of a prepared statement result the way the binary protocol delivers it, NULL is the monostate
+using StatementValue = std::variant<std::monostate, int64_t, uint64_t, double, std::string>;
+
+// Parses a column without copying it. Integers are read at full width and then narrowed, so that out of range values
+// wrap the way strtoul did before.
+template <typename T>
+T parseNumber(std::string_view value)
+{
+	if constexpr (std::is_enum_v<T>) {
+		return static_cast<T>(parseNumber<std::underlying_type_t<T>>(value));
+	} else if constexpr (std::is_floating_point_v<T>) {
+		T number{};
+		std::from_chars(value.data(), value.data() + value.size(), number);
+		return number;
+	} else if (!value.empty() && value.front() == '-') {
+		int64_t number = 0;
+		std::from_chars(value.data(), value.data() + value.size(), number);
+		return static_cast<T>(number);
+	} else {
+		uint64_t number = 0;
+		std::from_chars(value.data(), value.data() + value.size(), number);
+		return static_cast<T>(number);
+	}
+}
+
+// Formats a numeric column the way it is sent as text, strings and NULL give an empty string.
+inline std::string formatNumber(const StatementValue& value)
+{
+	return std::visit(
+	    [](const auto& number) -> std::string {
+		    using Value = std::decay_t<decltype(number)>;
+		    if constexpr (std::is_same_v<Value, double>) {
+			    return fmt::format("{}", number);
+		    } else if constexpr (std::is_integral_v<Value>) {
+			    return std::to_string(number);
+		    } else {
+			    return {};
+		    }
+	    },
+	    value);
+}
+
+template <typename T>
+constexpr bool isOptional = false;
+template <typename T>
+constexpr bool isOptional<std::optional<T>> = true;
+
+// Points the parameter at the value, the value has to outlive the execution of the statement. Enums have to be
+// passed as their underlying value.
+template <typename T>
+void bindParam(MYSQL_BIND& bind, const T& value)
+{
+	if constexpr (std::is_same_v<T, std::nullptr_t>) {
+		bind.buffer_type = MYSQL_TYPE_NULL;
+	} else if constexpr (isOptional<T>) {
+		if (value) {
+			bindParam(bind, *value);
+		} else {
+			bind.buffer_type = MYSQL_TYPE_NULL;
+		}
+	} else if constexpr (std::is_integral_v<T>) {
+		static_assert(sizeof(T) <= sizeof(int64_t));
+		if constexpr (sizeof(T) == 1) {
+			bind.buffer_type = MYSQL_TYPE_TINY;
+		} else if constexpr (sizeof(T) == 2) {
+			bind.buffer_type = MYSQL_TYPE_SHORT;
+		} else if constexpr (sizeof(T) == 4) {
+			bind.buffer_type = MYSQL_TYPE_LONG;
+		} else {
+			bind.buffer_type = MYSQL_TYPE_LONGLONG;
+		}
+		bind.buffer = const_cast<T*>(&value);
+		bind.is_unsigned = std::is_unsigned_v<T>;
+	} else if constexpr (std::is_same_v<T, double>) {
+		bind.buffer_type = MYSQL_TYPE_DOUBLE;
+		bind.buffer = const_cast<double*>(&value);
+	} else if constexpr (std::is_same_v<T, DBBlob>) {
+		bind.buffer_type = MYSQL_TYPE_BLOB;
+		bind.buffer = const_cast<char*>(value.data.data());
+		bind.buffer_length = value.data.size();
+	} else {
+		const std::string_view data = value;
+		bind.buffer_type = MYSQL_TYPE_STRING;
+		bind.buffer = const_cast<char*>(data.data());
+		bind.buffer_length = data.size();
+	}
+}
 
 } // namespace tfs::detail
 
@@ -63,6 +159,102 @@ public:
 	 */
 	DBResult_ptr storeQuery(std::string_view query);
 
+	/**
+	 * Queries database without buffering the result.
+	 *
+	 * The rows are passed to the visitor one at a time as they arrive from
+	 * the server, for reads too large to keep in memory at once. The
+	 * connection is busy until the last row is read, so the visitor must
+	 * not run queries on it; a lost connection is only retried before the
+	 * first row.
+	 *
+	 * @param query query that generates results (mostly SELECT)
+	 * @param visitor called for every row of the result
+	 * @return true if every row was read, false on error
+	 */
+	bool streamQuery(std::string_view query, const std::function<void(const DBResult&)>& visitor);
+
+	/**
+	 * Executes a prepared statement.
+	 *
+	 * The statement is prepared the first time it is used and kept for the
+	 * connection, so its text must not contain any values. The parameters
+	 * are sent in the binary protocol, strings are neither escaped nor quoted.
+	 *
+	 * @param statement SQL with a ? in place of every parameter
+	 * @param params integers, doubles, strings, DBBlob, nullptr or optionals of them
+	 * @return true on success, false on error
+	 */
+	template <typename... Params>
+	bool executeStatement(std::string_view statement, const Params&... params)
+	{
+		std::array<MYSQL_BIND, sizeof...(Params)> binds{};
+		[[maybe_unused]] size_t index = 0;
+		(tfs::detail::bindParam(binds[index++], params), ...);
+		return runStatement(statement, binds.data(), nullptr);
+	}
+
+	/**
+	 * Queries database with a prepared statement.
+	 *
+	 * The columns of the result keep their binary type, getNumber reads
+	 * integer columns without parsing any text.
+	 *
+	 * @return results object (nullptr on error or if there are no rows)
+	 */
+	template <typename... Params>
+	DBResult_ptr storeStatement(std::string_view statement, const Params&... params)
+	{
+		std::array<MYSQL_BIND, sizeof...(Params)> binds{};
+		[[maybe_unused]] size_t index = 0;
+		(tfs::detail::bindParam(binds[index++], params), ...);
+
+		DBResult_ptr result;
+		runStatement(statement, binds.data(), &result);
+		return result;
+	}
+
+	/**
+	 * Renders a prepared statement as a text query.
+	 *
+	 * For statements that are sent in a batch, which the binary protocol
+	 * cannot do. The parameters are escaped and quoted, the statement text
+	 * must not contain a ? other than the placeholders.
+	 *
+	 * @return the query with the parameters in place of the placeholders
+	 */
+	template <typename... Params>
+	std::string formatStatement(std::string_view statement, const Params&... params) const
+	{
+		std::string query;
+		query.reserve(statement.size() + 8 * sizeof...(Params));
+
+		[[maybe_unused]] size_t position = 0;
+		[[maybe_unused]] auto appendParam = [&](const auto& param) {
+			const size_t placeholder = statement.find('?', position);
+			assert(placeholder != std::string_view::npos);
+			query.append(statement.substr(position, placeholder - position));
+			formatParam(query, param);
+			position = placeholder + 1;
+		};
+		(appendParam(params), ...);
+
+		query.append(statement.substr(position));
+		return query;
+	}
+
+	/**
+	 * Executes commands in as few round trips as possible.
+	 *
+	 * The commands are sent together as multi-statements, split only where
+	 * they would exceed max_allowed_packet. Meant to run within a
+	 * DBTransaction, a lost connection is not retried.
+	 *
+	 * @param queries commands that don't generate results
+	 * @return true if every command succeeded, the commands after a failed one are not executed
+	 */
+	bool executeBatch(const std::vector<std::string_view>& queries);
+
 	/**
 	 * Escapes string for query.
 	 *
@@ -101,6 +293,24 @@ public:
 
 	uint64_t getMaxPacketSize() const { return maxPacketSize; }
 
+	// Runs a function that writes in a transaction of its own, again as long as the transaction fails on a deadlock
+	// or a lock wait timeout. Those only mean that another connection held the same rows at the time.
+	template <typename Function>
+	bool retryTransaction(Function&& function, uint32_t tries = 3)
+	{
+		for (uint32_t i = 1;; ++i) {
+			lockConflict = false;
+			if (function()) {
+				return true;
+			}
+
+			if (!lockConflict || i >= tries) {
+				return false;
+			}
+			std::cout << "[Warning - Database::retryTransaction] Lock conflict, retrying the transaction." << std::endl;
+		}
+	}
+
 private:
 	/**
 	 * Transaction related methods.
@@ -114,11 +324,47 @@ private:
 	bool rollback();
 	bool commit();
 
+	bool runStatement(std::string_view statement, MYSQL_BIND* params, DBResult_ptr* result);
+	void noteError(unsigned error);
+	bool runBatch(std::string_view batch);
+
+	template <typename T>
+	void formatParam(std::string& query, const T& param) const
+	{
+		if constexpr (std::is_same_v<T, std::nullptr_t>) {
+			query.append("NULL");
+		} else if constexpr (tfs::detail::isOptional<T>) {
+			if (param) {
+				formatParam(query, *param);
+			} else {
+				query.append("NULL");
+			}
+		} else if constexpr (std::is_integral_v<T>) {
+			fmt::format_to(std::back_inserter(query), "{:d}", param);
+		} else if constexpr (std::is_same_v<T, double>) {
+			fmt::format_to(std::back_inserter(query), "{}", param);
+		} else if constexpr (std::is_same_v<T, DBBlob>) {
+			query.append(escapeBlob(param.data.data(), param.data.size()));
+		} else {
+			query.append(escapeString(param));
+		}
+	}
+
+	MYSQL_STMT* prepareStatement(std::string_view statement, unsigned& error);
+	// replaces the lost connection, waits until the database can be reached again
+	void reconnect();
+	// sends a query, reconnecting and sending it again on a lost connection if retryQueries is set
+	bool sendQuery(std::string_view query);
+
 	tfs::detail::Mysql_ptr handle = nullptr;
+	// prepared statements by their text, they belong to handle and are dropped whenever it is replaced
+	std::map<std::string, tfs::detail::MysqlStatement_ptr, std::less<>> statements;
 	std::recursive_mutex databaseLock;
 	uint64_t maxPacketSize = 1048576;
 	// Do not retry queries if we are in the middle of a transaction
 	bool retryQueries = true;
+	// a statement failed on a deadlock or a lock wait timeout since retryTransaction started the current try
+	bool lockConflict = false;
 
 	friend class DBTransaction;
 };
@@ -127,38 +373,70 @@ class DBResult
 {
 public:
 	explicit DBResult(tfs::detail::MysqlResult_ptr&& res);
+	// the result of a prepared statement, the metadata only provides the column names
+	DBResult(tfs::detail::MysqlResult_ptr&& metadata, std::vector<std::vector<tfs::detail::StatementValue>>&& rows);
 
 	// non-copyable
 	DBResult(const DBResult&) = delete;
 	DBResult& operator=(const DBResult&) = delete;
 
+	// the position of the column in the rows, resolve it once before reading many rows
+	size_t getColumnIndex(std::string_view column) const;
+
 	template <typename T>
-	T getNumber(std::string_view column) const
+	T getNumber(size_t column) const
 	{
-		auto it = listNames.find(column);
-		if (it == listNames.end()) {
-			std::cout << "[Error - DBResult::getNumber] Column '" << column << "' doesn't exist in the result set"
-			          << std::endl;
+		if (column >= columnCount) {
 			return {};
 		}
 
-		if (!row[it->second]) {
+		if (!statementRows.empty()) {
+			return std::visit(
+			    [](const auto& value) -> T {
+				    using Value = std::decay_t<decltype(value)>;
+				    if constexpr (std::is_same_v<Value, std::monostate>) {
+					    return {};
+				    } else if constexpr (std::is_same_v<Value, std::string>) {
+					    // DECIMAL columns, such as SUM of integers
+					    return tfs::detail::parseNumber<T>(value);
+				    } else {
+					    return static_cast<T>(value);
+				    }
+			    },
+			    statementRows[statementRow][column]);
+		}
+
+		if (!row[column]) {
 			return {};
 		}
 
-		return pugi::cast<T>(row[it->second]);
+		return tfs::detail::parseNumber<T>({row[column], lengths[column]});
+	}
+
+	template <typename T>
+	T getNumber(std::string_view column) const
+	{
+		return getNumber<T>(getColumnIndex(column));
 	}
 
-	std::string_view getString(std::string_view column) const;
+	std::string_view getString(size_t column) const;
+	std::string_view getString(std::string_view column) const { return getString(getColumnIndex(column)); }
 
 	bool hasNext() const;
 	bool next();
 
 private:
 	tfs::detail::MysqlResult_ptr handle;
-	MYSQL_ROW row;
+	MYSQL_ROW row = nullptr;
+	unsigned long* lengths = nullptr;
 
 	std::map<std::string_view, size_t> listNames;
+	size_t columnCount = 0;
+
+	std::vector<std::vector<tfs::detail::StatementValue>> statementRows;
+	size_t statementRow = 0;
+	// text of the numeric statement fields read through getString, by row and column
+	mutable std::map<std::pair<size_t, size_t>, std::string> formattedValues;
 
 	friend class Database;
 };
@@ -170,25 +448,31 @@ class DBInsert
 {
 public:
 	explicit DBInsert(std::string query);
+	// collects the statements in the list instead of executing them, to run them later or on another connection
+	DBInsert(std::string query, std::vector<std::string>& queries);
+	// rows that already exist update the given columns instead of failing on the primary key
+	void upsert(const std::vector<std::string_view>& columns);
 	bool addRow(const std::string& row);
 	bool addRow(std::ostringstream& row);
 	bool execute();
 
 private:
 	std::string query;
+	std::string upsertQuery;
 	std::string values;
 	size_t length;
+	std::vector<std::string>* queries = nullptr;
 };
 
 class DBTransaction
 {
 public:
-	constexpr DBTransaction() = default;
+	explicit DBTransaction(Database& db = Database::getInstance()) : db(db) {}
 
 	~DBTransaction()
 	{
 		if (state == STATE_START) {
-			Database::getInstance().rollback();
+			db.rollback();
 		}
 	}
 
@@ -199,7 +483,7 @@ public:
 	bool begin()
 	{
 		state = STATE_START;
-		return Database::getInstance().beginTransaction();
+		return db.beginTransaction();
 	}
 
 	bool commit()
@@ -209,7 +493,7 @@ public:
 		}
 
 		state = STATE_COMMIT;
-		return Database::getInstance().commit();
+		return db.commit();
 	}
 
 private:
@@ -220,6 +504,7 @@ private:
 		STATE_COMMIT,
 	};
 
+	Database& db;
 	TransactionStates_t state = STATE_NO_START;
 };
 
@@ -7,52 +7,172 @@
 
 #include "tasks.h"
 
+#include <bit>
+
 extern Dispatcher g_dispatcher;
 
-void DatabaseTasks::start()
+namespace {
+
+void record(DatabaseTasks::Histogram& histogram, uint64_t value)
 {
-	db.connect();
-	ThreadHolder::start();
+	++histogram[std::min<size_t>(std::bit_width(value), histogram.size() - 1)];
 }
 
-void DatabaseTasks::threadMain()
+uint64_t microsecondsBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
 {
-	std::unique_lock<std::mutex> taskLockUnique(taskLock, std::defer_lock);
-	while (getState() != THREAD_STATE_TERMINATED) {
-		taskLockUnique.lock();
-		if (tasks.empty()) {
-			taskSignal.wait(taskLockUnique);
+	return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+} // namespace
+
+bool DatabaseTasks::start(size_t threadCount, bool connect /* = true*/)
+{
+	assert(threads.empty());
+
+	threadCount = std::max<size_t>(threadCount, 1);
+	for (size_t i = 0; i < threadCount; ++i) {
+		Database& db = connections.emplace_back();
+		if (connect && !db.connect()) {
+			connections.clear();
+			return false;
 		}
+	}
 
-		if (!tasks.empty()) {
-			DatabaseTask task = std::move(tasks.front());
-			tasks.pop_front();
-			taskLockUnique.unlock();
-			runTask(task);
-		} else {
-			taskLockUnique.unlock();
+	state = THREAD_STATE_RUNNING;
+	stats.threads = threadCount;
+	threads.reserve(threadCount);
+	for (auto& db : connections) {
+		threads.emplace_back(&DatabaseTasks::threadMain, this, std::ref(db));
+	}
+	return true;
+}
+
+void DatabaseTasks::threadMain(Database& db)
+{
+	std::unique_lock<std::mutex> taskLockUnique(taskLock);
+	while (true) {
+		taskSignal.wait(taskLockUnique, [this]() {
+			return !readyTasks.empty() || (state == THREAD_STATE_TERMINATED && tasks.empty());
+		});
+		if (readyTasks.empty()) {
+			return;
 		}
+
+		const auto it = readyTasks.front();
+		readyTasks.pop_front();
+
+		// a ready task is the first one of each of its keys, it holds them until it is done
+		for (uint64_t key : it->keys) {
+			KeyQueue& queue = keyQueues[key];
+			queue.tasks.pop_front();
+			queue.running = true;
+			queue.runningSequence = it->sequence;
+		}
+
+		DatabaseTask task = std::move(*it);
+		tasks.erase(it);
+		if (state == THREAD_STATE_TERMINATED && tasks.empty()) {
+			// the idle threads return now
+			taskSignal.notify_all();
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		record(stats.waitTime, microsecondsBetween(task.queued, start));
+		runningTasks.insert(task.sequence);
+
+		taskLockUnique.unlock();
+		runTask(db, task);
+		taskLockUnique.lock();
+
+		record(stats.runTime, microsecondsBetween(start, std::chrono::steady_clock::now()));
+		runningTasks.erase(task.sequence);
+
+		for (size_t ready = releaseKeys(task); ready != 0; --ready) {
+			taskSignal.notify_one();
+		}
+		idleSignal.notify_all();
 	}
 }
 
-void DatabaseTasks::addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback /* = nullptr*/,
-                            bool store /* = false*/)
+size_t DatabaseTasks::releaseKeys(const DatabaseTask& task)
 {
-	bool signal = false;
-	taskLock.lock();
-	if (getState() == THREAD_STATE_RUNNING) {
-		signal = tasks.empty();
-		tasks.emplace_back(std::move(query), std::move(callback), store);
+	size_t ready = 0;
+	for (uint64_t key : task.keys) {
+		auto it = keyQueues.find(key);
+		KeyQueue& queue = it->second;
+		if (queue.tasks.empty()) {
+			keyQueues.erase(it);
+			continue;
+		}
+
+		queue.running = false;
+		const auto next = queue.tasks.front();
+		if (--next->blockingKeys == 0) {
+			readyTasks.push_back(next);
+			++ready;
+		}
 	}
-	taskLock.unlock();
+	return ready;
+}
+
+template <typename... Args>
+void DatabaseTasks::pushTask(Args&&... args)
+{
+	{
+		std::lock_guard<std::mutex> lockClass(taskLock);
+		if (state != THREAD_STATE_RUNNING) {
+			return;
+		}
+
+		DatabaseTask& task = tasks.emplace_back(std::forward<Args>(args)...);
+		task.sequence = nextSequence++;
+		task.queued = std::chrono::steady_clock::now();
+		++stats.tasks;
+		record(stats.queueDepth, tasks.size());
 
-	if (signal) {
-		taskSignal.notify_one();
+		// a key that is given twice must not hold the task back behind itself
+		std::sort(task.keys.begin(), task.keys.end());
+		task.keys.erase(std::unique(task.keys.begin(), task.keys.end()), task.keys.end());
+
+		for (uint64_t key : task.keys) {
+			KeyQueue& queue = keyQueues[key];
+			if (queue.running || !queue.tasks.empty()) {
+				++task.blockingKeys;
+			}
+			queue.tasks.push_back(std::prev(tasks.end()));
+		}
+
+		if (task.blockingKeys != 0) {
+			return;
+		}
+		readyTasks.push_back(std::prev(tasks.end()));
 	}
+	taskSignal.notify_one();
+}
+
+void DatabaseTasks::addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback /* = nullptr*/,
+                            bool store /* = false*/, uint64_t key /* = DEFAULT_KEY*/)
+{
+	pushTask(std::move(query), std::move(callback), store, std::vector<uint64_t>{key});
+}
+
+void DatabaseTasks::addJob(std::function<void(Database&)> job, uint64_t key /* = DEFAULT_KEY*/)
+{
+	pushTask(std::move(job), std::vector<uint64_t>{key});
+}
+
+void DatabaseTasks::addJob(std::function<void(Database&)> job, std::vector<uint64_t> keys)
+{
+	pushTask(std::move(job), std::move(keys));
 }
 
-void DatabaseTasks::runTask(const DatabaseTask& task)
+void DatabaseTasks::runTask(Database& db, const DatabaseTask& task)
 {
+	if (task.job) {
+		task.job(db);
+		return;
+	}
+
 	bool success;
 	DBResult_ptr result;
 	if (task.store) {
@@ -68,23 +188,70 @@ void DatabaseTasks::runTask(const DatabaseTask& task)
 	}
 }
 
+bool DatabaseTasks::isDone(uint64_t sequence, std::optional<uint64_t> key) const
+{
+	// the queue is in the order the tasks were added, running tasks started before everything that is still queued
+	if (!key) {
+		return (tasks.empty() || tasks.front().sequence >= sequence) &&
+		       (runningTasks.empty() || *runningTasks.begin() >= sequence);
+	}
+
+	auto it = keyQueues.find(*key);
+	if (it == keyQueues.end()) {
+		return true;
+	}
+
+	const KeyQueue& queue = it->second;
+	if (queue.running && queue.runningSequence < sequence) {
+		return false;
+	}
+	return queue.tasks.empty() || queue.tasks.front()->sequence >= sequence;
+}
+
 void DatabaseTasks::flush()
 {
-	std::unique_lock<std::mutex> guard{taskLock};
-	while (!tasks.empty()) {
-		auto task = std::move(tasks.front());
-		tasks.pop_front();
-		guard.unlock();
-		runTask(task);
-		guard.lock();
+	std::unique_lock<std::mutex> taskLockUnique(taskLock);
+	idleSignal.wait(taskLockUnique, [this, sequence = nextSequence]() { return isDone(sequence, std::nullopt); });
+}
+
+void DatabaseTasks::flush(uint64_t key)
+{
+	std::unique_lock<std::mutex> taskLockUnique(taskLock);
+	idleSignal.wait(taskLockUnique, [this, key, sequence = nextSequence]() { return isDone(sequence, key); });
+}
+
+void DatabaseTasks::stop()
+{
+	std::lock_guard<std::mutex> lockClass(taskLock);
+	if (state == THREAD_STATE_RUNNING) {
+		state = THREAD_STATE_CLOSING;
 	}
 }
 
 void DatabaseTasks::shutdown()
 {
-	taskLock.lock();
-	setState(THREAD_STATE_TERMINATED);
-	taskLock.unlock();
+	{
+		std::lock_guard<std::mutex> lockClass(taskLock);
+		state = THREAD_STATE_TERMINATED;
+	}
+	// the threads only return once the queue is empty
+	taskSignal.notify_all();
 	flush();
-	taskSignal.notify_one();
+}
+
+void DatabaseTasks::join()
+{
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	threads.clear();
+	connections.clear();
+}
+
+DatabaseTasks::Stats DatabaseTasks::getStats()
+{
+	std::lock_guard<std::mutex> lockClass(taskLock);
+	Stats copy = stats;
+	copy.queued = tasks.size();
+	return copy;
 }
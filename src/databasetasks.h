@@ -5,39 +5,122 @@
 #define FS_DATABASETASKS_H
 
 #include "database.h"
-#include "thread_holder_base.h"
+#include "enums.h"
 
 struct DatabaseTask
 {
-	DatabaseTask(std::string&& query, std::function<void(DBResult_ptr, bool)>&& callback, bool store) :
-	    query(std::move(query)), callback(std::move(callback)), store(store)
+	DatabaseTask(std::string&& query, std::function<void(DBResult_ptr, bool)>&& callback, bool store,
+	             std::vector<uint64_t>&& keys) :
+	    query(std::move(query)), callback(std::move(callback)), store(store), keys(std::move(keys))
+	{}
+	DatabaseTask(std::function<void(Database&)>&& job, std::vector<uint64_t>&& keys) :
+	    job(std::move(job)), keys(std::move(keys))
 	{}
 
 	std::string query;
 	std::function<void(DBResult_ptr, bool)> callback;
-	bool store;
+	bool store = false;
+
+	// runs instead of the query, for work that needs several statements or a transaction on the connection
+	std::function<void(Database&)> job;
+
+	std::vector<uint64_t> keys;
+	uint64_t sequence = 0;
+	std::chrono::steady_clock::time_point queued;
+	// keys that still hold the task back, because another task with the key runs or is ahead of it in the queue
+	size_t blockingKeys = 0;
 };
 
-class DatabaseTasks : public ThreadHolder<DatabaseTasks>
+// Runs queries in the background on a pool of threads, each with a connection of its own. Every task has one or more
+// keys: a task does not start before the tasks with one of its keys that were added earlier have finished, tasks that
+// share no key run at the same time.
+class DatabaseTasks
 {
 public:
+	// counts per power of two, bucket i holds the values below 2^i that do not fit into bucket i - 1
+	using Histogram = std::array<uint64_t, 32>;
+
+	struct Stats
+	{
+		size_t threads = 0;
+		size_t queued = 0;
+		uint64_t tasks = 0;
+		// tasks waiting when a task is added, including the new one
+		Histogram queueDepth{};
+		// microseconds from adding a task until it starts and from its start until it is done
+		Histogram waitTime{};
+		Histogram runTime{};
+	};
+
+	// Tasks added without a key keep the order among each other they always had. They are not ordered with tasks of
+	// other keys, such as player saves, anything that has to see those writes has to use their key.
+	static constexpr uint64_t DEFAULT_KEY = 0;
+	static constexpr uint64_t HOUSES_KEY = 1;
+	static constexpr uint64_t playerKey(uint32_t guid) { return (uint64_t{1} << 32) | guid; }
+	static constexpr uint64_t accountKey(uint32_t accountId) { return (uint64_t{2} << 32) | accountId; }
+
 	DatabaseTasks() = default;
-	void start();
+
+	// non-copyable
+	DatabaseTasks(const DatabaseTasks&) = delete;
+	DatabaseTasks& operator=(const DatabaseTasks&) = delete;
+
+	// connects every thread to the database, returns false if one of the connections fails. Without connecting, the
+	// threads can only run jobs that do not use their connection.
+	bool start(size_t threadCount, bool connect = true);
+	// waits for the tasks added before, the ones with the key only if one is given
 	void flush();
+	void flush(uint64_t key);
+	// tasks added after stop are dropped, the queued ones still run
+	void stop();
 	void shutdown();
+	void join();
 
-	void addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback = nullptr, bool store = false);
+	// any thread
+	void addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback = nullptr, bool store = false,
+	             uint64_t key = DEFAULT_KEY);
+	void addJob(std::function<void(Database&)> job, uint64_t key = DEFAULT_KEY);
+	void addJob(std::function<void(Database&)> job, std::vector<uint64_t> keys);
 
-	void threadMain();
+	Stats getStats();
 
 private:
-	void runTask(const DatabaseTask& task);
+	using TaskIterator = std::list<DatabaseTask>::iterator;
+
+	// the queued tasks with a key in the order they were added, the first one waits only for the running one
+	struct KeyQueue
+	{
+		std::deque<TaskIterator> tasks;
+		bool running = false;
+		uint64_t runningSequence = 0;
+	};
+
+	template <typename... Args>
+	void pushTask(Args&&... args);
+	void runTask(Database& db, const DatabaseTask& task);
+	// releases the keys of a task that finished, returns how many queued tasks are ready to run now
+	size_t releaseKeys(const DatabaseTask& task);
+	bool isDone(uint64_t sequence, std::optional<uint64_t> key) const;
+
+	void threadMain(Database& db);
 
-	Database db;
-	std::thread thread;
+	std::list<Database> connections;
+	std::vector<std::thread> threads;
+
+	// every queued task in the order they were added, the ones no key holds back are also in readyTasks
 	std::list<DatabaseTask> tasks;
+	std::deque<TaskIterator> readyTasks;
+	std::unordered_map<uint64_t, KeyQueue> keyQueues;
 	std::mutex taskLock;
 	std::condition_variable taskSignal;
+	std::condition_variable idleSignal;
+	ThreadState state = THREAD_STATE_TERMINATED;
+	uint64_t nextSequence = 0;
+
+	// the sequences of the running tasks
+	std::set<uint64_t> runningTasks;
+
+	Stats stats;
 };
 
 extern DatabaseTasks g_databaseTasks;
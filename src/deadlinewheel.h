@@ -0,0 +1,278 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_DEADLINEWHEEL_H
+#define FS_DEADLINEWHEEL_H
+
+// Refers to an entry of a DeadlineWheel, a default constructed one refers to nothing. It stays safe to use after the
+// entry expired or was removed, the wheel recognises it as outdated then.
+struct DeadlineWheelEntry
+{
+	uint32_t index = 0;
+	uint32_t generation = 0;
+};
+
+// Hierarchical timing wheel that hands values back once their deadline tick has passed. Entries that are too far in the
+// future for the near level are cascaded down whenever the level below wraps around. The entries live in a pool and
+// every slot links its entries by pool index, so the values do not need bookkeeping fields of their own: inserting
+// returns a DeadlineWheelEntry the owner keeps to remove the entry again in constant time. Values that go stale without
+// being removed have to be recognised and dropped when they come back.
+template <typename T>
+class DeadlineWheel
+{
+public:
+	static constexpr uint32_t NEAR_BITS = 8;
+	static constexpr uint32_t FAR_BITS = 6;
+	static constexpr uint32_t FAR_LEVELS = 3;
+
+	static constexpr uint32_t NEAR_SIZE = 1 << NEAR_BITS;
+	static constexpr uint32_t FAR_SIZE = 1 << FAR_BITS;
+
+	explicit DeadlineWheel(uint64_t currentTick = 0) : currentTick(currentTick) {}
+
+	// non-copyable
+	DeadlineWheel(const DeadlineWheel&) = delete;
+	DeadlineWheel& operator=(const DeadlineWheel&) = delete;
+
+	DeadlineWheelEntry insert(T value, uint64_t deadline)
+	{
+		const uint32_t index = allocate();
+		Node& node = nodes[index];
+		node.value = std::move(value);
+		// values can not expire in the tick that has already been processed
+		node.deadline = std::max(deadline, currentTick + 1);
+		place(index);
+		++totalCount;
+		return {index, node.generation};
+	}
+
+	// removes the entry if it still holds the value, returns false if it already expired or was removed
+	bool remove(const DeadlineWheelEntry& entry, const T& value)
+	{
+		if (entry.index >= nodes.size()) {
+			return false;
+		}
+
+		Node& node = nodes[entry.index];
+		if (node.generation != entry.generation || !node.slot || !(node.value == value)) {
+			return false;
+		}
+
+		unlink(entry.index);
+		release(entry.index);
+		--totalCount;
+		return true;
+	}
+
+	// removes every entry and appends its value to the list
+	void clear(std::vector<T>& removed)
+	{
+		for (uint32_t index = 0; index < nodes.size(); ++index) {
+			if (nodes[index].slot) {
+				removed.push_back(std::move(nodes[index].value));
+				release(index);
+			}
+		}
+
+		nearSlots.fill({});
+		for (auto& level : farSlots) {
+			level.fill({});
+		}
+		overflow = {};
+
+		nearCount = 0;
+		totalCount = 0;
+	}
+
+	// advances the wheel to the given tick and appends every expired value to the list, in expiration order
+	void advance(uint64_t tick, std::vector<T>& expired)
+	{
+		while (currentTick < tick) {
+			if (totalCount == 0) {
+				// nothing to expire, skip straight to the requested tick
+				currentTick = tick;
+				break;
+			}
+
+			++currentTick;
+
+			if ((currentTick & (NEAR_SIZE - 1)) == 0) {
+				for (uint32_t level = 1; level <= FAR_LEVELS; ++level) {
+					const auto index = (currentTick >> getLevelShift(level)) & (FAR_SIZE - 1);
+					cascade(farSlots[level - 1][index]);
+					if (index != 0) {
+						break;
+					}
+
+					if (level == FAR_LEVELS) {
+						cascade(overflow);
+					}
+				}
+			}
+
+			auto& slot = nearSlots[currentTick & (NEAR_SIZE - 1)];
+			for (uint32_t index = std::exchange(slot.head, NONE); index != NONE;) {
+				const uint32_t next = nodes[index].next;
+				expired.push_back(std::move(nodes[index].value));
+				release(index);
+				--nearCount;
+				--totalCount;
+				index = next;
+			}
+			slot.tail = NONE;
+		}
+	}
+
+	// number of ticks until the wheel has to be advanced again, nothing if the wheel is empty
+	std::optional<uint64_t> getNextTimeout() const
+	{
+		if (totalCount == 0) {
+			return std::nullopt;
+		}
+
+		// entries in the upper levels are only moved down when the near level wraps around
+		const uint64_t untilCascade = NEAR_SIZE - (currentTick & (NEAR_SIZE - 1));
+		const uint64_t limit = nearCount == totalCount ? NEAR_SIZE - 1 : untilCascade;
+
+		if (nearCount != 0) {
+			for (uint64_t ticks = 1; ticks <= limit; ++ticks) {
+				if (nearSlots[(currentTick + ticks) & (NEAR_SIZE - 1)].head != NONE) {
+					return ticks;
+				}
+			}
+		}
+		return limit;
+	}
+
+	uint64_t getCurrentTick() const { return currentTick; }
+	size_t size() const { return totalCount; }
+	bool empty() const { return totalCount == 0; }
+
+private:
+	static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+	struct Slot
+	{
+		uint32_t head = NONE;
+		uint32_t tail = NONE;
+	};
+
+	struct Node
+	{
+		T value{};
+		uint64_t deadline = 0;
+		// the slot the node is linked into, nullptr while the node is free
+		Slot* slot = nullptr;
+		uint32_t prev = NONE;
+		uint32_t next = NONE;
+		// odd while the node is in use, so a default constructed DeadlineWheelEntry never matches
+		uint32_t generation = 0;
+	};
+
+	static constexpr uint32_t getLevelShift(uint32_t level) { return NEAR_BITS + (level - 1) * FAR_BITS; }
+
+	bool isNear(const Slot* slot) const { return slot >= nearSlots.data() && slot < nearSlots.data() + NEAR_SIZE; }
+
+	uint32_t allocate()
+	{
+		uint32_t index = freeHead;
+		if (index != NONE) {
+			freeHead = nodes[index].next;
+		} else {
+			index = static_cast<uint32_t>(nodes.size());
+			nodes.emplace_back();
+		}
+		++nodes[index].generation;
+		return index;
+	}
+
+	void release(uint32_t index)
+	{
+		Node& node = nodes[index];
+		node.value = T{};
+		node.slot = nullptr;
+		node.prev = NONE;
+		node.next = freeHead;
+		++node.generation;
+		freeHead = index;
+	}
+
+	Slot& getSlot(uint64_t deadline)
+	{
+		const uint64_t delta = deadline - currentTick;
+		if (delta < NEAR_SIZE) {
+			return nearSlots[deadline & (NEAR_SIZE - 1)];
+		}
+
+		for (uint32_t level = 1; level <= FAR_LEVELS; ++level) {
+			if (delta < (uint64_t{1} << (getLevelShift(level) + FAR_BITS))) {
+				return farSlots[level - 1][(deadline >> getLevelShift(level)) & (FAR_SIZE - 1)];
+			}
+		}
+		return overflow;
+	}
+
+	void place(uint32_t index)
+	{
+		Node& node = nodes[index];
+		Slot& slot = getSlot(node.deadline);
+		node.slot = &slot;
+		if (isNear(&slot)) {
+			++nearCount;
+		}
+		node.prev = slot.tail;
+		node.next = NONE;
+		if (slot.tail != NONE) {
+			nodes[slot.tail].next = index;
+		} else {
+			slot.head = index;
+		}
+		slot.tail = index;
+	}
+
+	void unlink(uint32_t index)
+	{
+		Node& node = nodes[index];
+		Slot& slot = *node.slot;
+		if (isNear(&slot)) {
+			--nearCount;
+		}
+
+		if (node.prev != NONE) {
+			nodes[node.prev].next = node.next;
+		} else {
+			slot.head = node.next;
+		}
+
+		if (node.next != NONE) {
+			nodes[node.next].prev = node.prev;
+		} else {
+			slot.tail = node.prev;
+		}
+	}
+
+	void cascade(Slot& slot)
+	{
+		// relinking keeps the order of the entries and does not allocate
+		uint32_t index = std::exchange(slot.head, NONE);
+		slot.tail = NONE;
+		while (index != NONE) {
+			const uint32_t next = nodes[index].next;
+			place(index);
+			index = next;
+		}
+	}
+
+	std::vector<Node> nodes;
+	uint32_t freeHead = NONE;
+
+	std::array<Slot, NEAR_SIZE> nearSlots;
+	std::array<std::array<Slot, FAR_SIZE>, FAR_LEVELS> farSlots;
+	Slot overflow;
+
+	uint64_t currentTick = 0;
+	size_t nearCount = 0;
+	size_t totalCount = 0;
+};
+
+#endif // FS_DEADLINEWHEEL_H
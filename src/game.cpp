@@ -6,6 +6,7 @@
 #include "game.h"
 
 #include "actions.h"
+#include "authworkers.h"
 #include "bed.h"
 #include "configmanager.h"
 #include "creature.h"
@@ -47,6 +48,19 @@ extern MoveEvents* g_moveEvents;
 extern Weapons* g_weapons;
 extern Scripts* g_scripts;
 
+namespace {
+
+// a bucket is rebalanced once it holds this many creatures more than the average, and half the average on top
+constexpr size_t CREATURE_CHECK_IMBALANCE = 32;
+
+// first decay tick that starts at or after the given time, so that no item expires before its deadline
+uint64_t getDecayTick(int64_t time)
+{
+	return static_cast<uint64_t>((time + EVENT_DECAYINTERVAL - 1) / EVENT_DECAYINTERVAL);
+}
+
+} // namespace
+
 Game::Game()
 {
 	offlineTrainingWindow.defaultEnterButton = 0;
@@ -65,6 +79,10 @@ void Game::start(ServiceManager* manager)
 {
 	serviceManager = manager;
 
+	if (int32_t pathfindingThreads = getNumber(ConfigManager::PATHFINDING_THREADS); pathfindingThreads > 0) {
+		pathfindingPool.start(pathfindingThreads);
+	}
+
 	g_scheduler.addEvent(createSchedulerTask(EVENT_CREATURE_THINK_INTERVAL, [this]() { checkCreatures(0); }));
 	g_scheduler.addEvent(
 	    createSchedulerTask(getNumber(ConfigManager::PATHFINDING_INTERVAL), [this]() { updateCreaturesPath(0); }));
@@ -156,9 +174,24 @@ void Game::saveGameState()
 
 	std::cout << "Saving server..." << std::endl;
 
+	// a running world save is superseded by this one, whatever it already queued has to be written first
+	worldSave.reset();
+	g_databaseTasks.flush();
+
+	std::vector<PlayerSnapshot> snapshots;
+	snapshots.reserve(players.size());
 	for (const auto& it : players) {
 		it.second->loginPosition = it.second->getPosition();
-		IOLoginData::savePlayer(it.second);
+		if (auto snapshot = IOLoginData::snapshotPlayer(it.second)) {
+			snapshots.push_back(std::move(*snapshot));
+		} else {
+			std::cout << "> Failed to save player " << it.second->getName() << std::endl;
+		}
+	}
+
+	// one transaction for everyone online
+	if (!snapshots.empty()) {
+		writePlayerSnapshots(std::move(snapshots), 0);
 	}
 
 	Map::save();
@@ -170,6 +203,192 @@ void Game::saveGameState()
 	}
 }
 
+bool Game::startWorldSave()
+{
+	if (worldSave) {
+		return false;
+	}
+
+	std::cout << "Saving server in the background..." << std::endl;
+
+	WorldSave& save = worldSave.emplace();
+	save.id = ++lastWorldSaveId;
+
+	save.playerIds.reserve(players.size());
+	for (const auto& it : players) {
+		save.playerIds.push_back(it.first);
+	}
+
+	for (const auto& it : map.houses.getHouses()) {
+		save.houseIds.push_back(it.first);
+	}
+
+	continueWorldSave();
+	return true;
+}
+
+void Game::continueWorldSave()
+{
+	if (!worldSave) {
+		return;
+	}
+
+	WorldSave& save = *worldSave;
+
+	const auto start = std::chrono::steady_clock::now();
+	const auto deadline = start + std::chrono::milliseconds(getNumber(ConfigManager::WORLD_SAVE_SLICE_TIME));
+
+	std::vector<PlayerSnapshot> snapshots;
+	while (save.nextPlayer < save.playerIds.size() && std::chrono::steady_clock::now() < deadline) {
+		// players that logged out in the meantime were saved by the logout
+		if (Player* player = getPlayerByID(save.playerIds[save.nextPlayer++])) {
+			player->loginPosition = player->getPosition();
+			if (auto snapshot = IOLoginData::snapshotPlayer(player)) {
+				snapshots.push_back(std::move(*snapshot));
+			} else {
+				std::cout << "> Failed to save player " << player->getName() << std::endl;
+				save.stats.success = false;
+			}
+		}
+	}
+
+	while (save.nextPlayer == save.playerIds.size() && save.nextHouse < save.houseIds.size() &&
+	       std::chrono::steady_clock::now() < deadline) {
+		if (House* house = map.houses.getHouse(save.houseIds[save.nextHouse++])) {
+			IOMapSerialize::snapshotHouse(house, save.houses);
+		}
+	}
+
+	const auto elapsed =
+	    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	save.stats.snapshotTime += elapsed;
+	save.stats.longestSlice = std::max<int64_t>(save.stats.longestSlice, elapsed);
+	save.stats.players += snapshots.size();
+	++save.stats.slices;
+
+	if (!snapshots.empty()) {
+		writePlayerSnapshots(std::move(snapshots), save.id);
+	}
+
+	if (save.nextPlayer < save.playerIds.size() || save.nextHouse < save.houseIds.size()) {
+		g_dispatcher.addTask([this]() { continueWorldSave(); });
+		return;
+	}
+
+	save.snapshotDone = true;
+	++save.pendingWrites;
+	g_databaseTasks.addJob(
+	    [this, saveId = save.id, houses = std::move(save.houses)](Database& db) {
+		    const auto start = std::chrono::steady_clock::now();
+		    const bool saved = Map::save(db, houses);
+		    const auto writeTime =
+		        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)
+		            .count();
+
+		    g_dispatcher.addTask([=, this]() { finishWorldSaveWrite(saveId, saved, writeTime); });
+	    },
+	    DatabaseTasks::HOUSES_KEY);
+}
+
+void Game::finishWorldSaveWrite(uint32_t saveId, bool saved, int64_t writeTime)
+{
+	if (!worldSave || worldSave->id != saveId) {
+		return;
+	}
+
+	WorldSaveStats& stats = worldSave->stats;
+	stats.writeTime += writeTime;
+	stats.success = stats.success && saved;
+
+	// the writes run side by side, the save is done with the last of them
+	if (--worldSave->pendingWrites != 0 || !worldSave->snapshotDone) {
+		return;
+	}
+
+	std::cout << fmt::format("> Saved {:d} players and {:d} houses: {:.3f} s snapshot in {:d} slices (longest "
+	                         "{:.3f} ms), {:.3f} s database writes{:s}",
+	                         stats.players, worldSave->houseIds.size(), stats.snapshotTime / 1000000.,
+	                         stats.slices, stats.longestSlice / 1000., stats.writeTime / 1000000.,
+	                         stats.success ? "" : ", some writes failed")
+	          << std::endl;
+
+	worldSaveStats = stats;
+	worldSave.reset();
+}
+
+void Game::writePlayerSnapshots(std::vector<PlayerSnapshot>&& snapshots, uint32_t saveId)
+{
+	std::vector<uint64_t> keys;
+	keys.reserve(snapshots.size());
+	for (const PlayerSnapshot& snapshot : snapshots) {
+		++pendingPlayerSaves[snapshot.guid];
+		keys.push_back(DatabaseTasks::playerKey(snapshot.guid));
+	}
+
+	if (worldSave && worldSave->id == saveId) {
+		++worldSave->pendingWrites;
+	}
+
+	g_databaseTasks.addJob(
+	    [this, saveId, snapshots = std::move(snapshots)](Database& db) mutable {
+		    const auto start = std::chrono::steady_clock::now();
+
+		    // all players in one transaction, if that fails they are saved one by one so only the failing ones are lost
+		    std::vector<bool> stored;
+		    bool saved = true;
+		    if (snapshots.size() == 1 || !IOLoginData::saveSnapshots(db, snapshots, stored)) {
+			    stored.assign(snapshots.size(), false);
+			    // saveSnapshot already retries on lock conflicts, any other error fails the same way again
+			    for (size_t i = 0; i < snapshots.size(); ++i) {
+				    bool playerStored = false;
+				    if (!IOLoginData::saveSnapshot(db, snapshots[i], playerStored)) {
+					    std::cout << "> Failed to save player with guid " << snapshots[i].guid << std::endl;
+					    saved = false;
+				    }
+				    stored[i] = playerStored;
+			    }
+		    }
+
+		    const auto writeTime =
+		        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)
+		            .count();
+
+		    std::vector<std::pair<uint32_t, uint32_t>> saves;
+		    saves.reserve(snapshots.size());
+		    for (const PlayerSnapshot& snapshot : snapshots) {
+			    saves.emplace_back(snapshot.guid, snapshot.sequence);
+		    }
+
+		    g_dispatcher.addTask(
+		        [this, saveId, writeTime, saved, saves = std::move(saves), stored = std::move(stored)]() {
+			        for (size_t i = 0; i < saves.size(); ++i) {
+				        const auto [guid, sequence] = saves[i];
+				        auto it = pendingPlayerSaves.find(guid);
+				        if (it != pendingPlayerSaves.end() && --it->second == 0) {
+					        pendingPlayerSaves.erase(it);
+				        }
+
+				        // the rows of the snapshot only count as saved now, snapshots taken in the meantime were
+				        // computed against them and the confirmed rows alike. Players whose save flag is off only
+				        // had their login written, their rows stay as they were.
+				        if (Player* player = getPlayerByGUID(guid)) {
+					        player->confirmSave(sequence, stored[i]);
+				        }
+			        }
+
+			        finishWorldSaveWrite(saveId, saved, writeTime);
+		        });
+	    },
+	    std::move(keys));
+}
+
+void Game::queuePlayerSave(PlayerSnapshot&& snapshot)
+{
+	std::vector<PlayerSnapshot> snapshots;
+	snapshots.push_back(std::move(snapshot));
+	writePlayerSnapshots(std::move(snapshots), 0);
+}
+
 bool Game::loadMainMap(const std::string& filename)
 {
 	return map.loadMap("data/world/" + filename + ".otbm", true, false);
@@ -1423,8 +1642,10 @@ ReturnValue Game::internalRemoveItem(Item* item, int32_t count /*= -1*/, bool te
 
 		if (item->isRemoved()) {
 			item->onRemoved();
-			if (item->canDecay()) {
-				decayItems->remove(item);
+			if (item->getDecaying() == DECAYING_TRUE) {
+				// the decay is paused until the item is added again, its entry must not keep it alive until then
+				removeDecayEntry(item);
+				item->setDecaying(DECAYING_FALSE);
 			}
 			ReleaseItem(item);
 		}
@@ -3754,9 +3975,10 @@ bool Game::internalCreatureTurn(Creature* creature, Direction dir)
 	// send to client
 	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), true, true);
+	CreatureTurnPackets packets;
 	for (Creature* spectator : spectators) {
 		assert(dynamic_cast<Player*>(spectator) != nullptr);
-		static_cast<Player*>(spectator)->sendCreatureTurn(creature);
+		static_cast<Player*>(spectator)->sendCreatureTurn(creature, packets);
 	}
 	return true;
 }
@@ -3792,11 +4014,13 @@ bool Game::internalCreatureSay(Creature* creature, SpeakClasses type, const std:
 		spectators = (*spectatorsPtr);
 	}
 
-	// send to client
+	// send to client, every spectator gets the same statement
+	NetworkMessage msg;
+	ProtocolGame::encodeCreatureSay(msg, ProtocolGame::nextStatementId(), creature, type, text, pos);
 	for (Creature* spectator : spectators) {
 		if (Player* tmpPlayer = spectator->getPlayer()) {
 			if (!ghostMode || tmpPlayer->canSeeCreature(creature)) {
-				tmpPlayer->sendCreatureSay(creature, type, text, pos);
+				tmpPlayer->sendEncodedPacket(msg);
 			}
 		}
 	}
@@ -3826,6 +4050,8 @@ void Game::updateCreatureWalk(uint32_t creatureId)
 	Creature* creature = getCreatureByID(creatureId);
 	if (creature && !creature->isDead()) {
 		creature->goToFollowCreature();
+		// a planned path that was not needed must not be taken by a later update
+		creature->plannedPath.reset();
 	}
 }
 
@@ -3863,33 +4089,111 @@ void Game::checkCreatures(size_t index)
 	g_scheduler.addEvent(createSchedulerTask(EVENT_CHECK_CREATURE_INTERVAL,
 	                                         [=, this]() { checkCreatures((index + 1) % EVENT_CREATURECOUNT); }));
 
+	const auto start = std::chrono::steady_clock::now();
+
+	// creatures may be added to the bucket while it is checked, so it is walked by slot
 	auto& checkCreatureList = checkCreatureLists[index];
-	auto it = checkCreatureList.begin(), end = checkCreatureList.end();
-	while (it != end) {
-		Creature* creature = *it;
+	size_t slot = 0;
+	while (slot < checkCreatureList.size()) {
+		Creature* creature = checkCreatureList[slot];
 		if (creature->creatureCheck) {
 			if (!creature->isDead()) {
-				creature->onThink(EVENT_CREATURE_THINK_INTERVAL);
-				creature->onAttacking(EVENT_CREATURE_THINK_INTERVAL);
-				creature->executeConditions(EVENT_CREATURE_THINK_INTERVAL);
+				const uint32_t interval = std::exchange(creature->checkInterval, EVENT_CREATURE_THINK_INTERVAL);
+				creature->onThink(interval);
+				creature->onAttacking(interval);
+				creature->executeConditions(interval);
 			}
-			++it;
+			++slot;
 		} else {
+			// the last creature takes over the slot and is checked next
 			creature->inCheckCreaturesVector = false;
-			it = checkCreatureList.erase(it);
+			checkCreatureList[slot] = checkCreatureList.back();
+			checkCreatureList.pop_back();
 			ReleaseCreature(creature);
 		}
 	}
 
+	checkCreatureTimes[index] =
+	    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+	rebalanceCreatureChecks(index);
 	cleanup();
 }
 
+void Game::rebalanceCreatureChecks(size_t index)
+{
+	auto& checkCreatureList = checkCreatureLists[index];
+
+	size_t total = 0;
+	for (const auto& bucket : checkCreatureLists) {
+		total += bucket.size();
+	}
+
+	const size_t average = total / EVENT_CREATURECOUNT;
+	if (checkCreatureList.size() <= average + average / 2 + CREATURE_CHECK_IMBALANCE) {
+		return;
+	}
+
+	// hand the last creatures over to the smallest buckets. They have just been checked and are checked again when
+	// their new bucket comes up, which is sooner than EVENT_CREATURE_THINK_INTERVAL, so that next check is passed
+	// the time that really passed and conditions and think timers do not run ahead.
+	while (checkCreatureList.size() > average + 1) {
+		auto smallest = std::min_element(std::begin(checkCreatureLists), std::end(checkCreatureLists),
+		                                 [](const auto& lhs, const auto& rhs) { return lhs.size() < rhs.size(); });
+		if (smallest->size() + 1 >= checkCreatureList.size()) {
+			break;
+		}
+
+		const size_t bucket = std::distance(std::begin(checkCreatureLists), smallest);
+		const size_t offset = (bucket + EVENT_CREATURECOUNT - index) % EVENT_CREATURECOUNT;
+
+		Creature* creature = checkCreatureList.back();
+		creature->checkInterval = offset * EVENT_CHECK_CREATURE_INTERVAL;
+		smallest->push_back(creature);
+		checkCreatureList.pop_back();
+	}
+}
+
 void Game::updateCreaturesPath(size_t index)
 {
 	g_scheduler.addEvent(createSchedulerTask(getNumber(ConfigManager::PATHFINDING_INTERVAL),
 	                                         [=, this]() { updateCreaturesPath((index + 1) % EVENT_CREATURECOUNT); }));
 
 	auto& checkCreatureList = checkCreatureLists[index];
+	if (pathfindingPool.getThreadCount() == 0) {
+		for (Creature* creature : checkCreatureList) {
+			if (!creature->isDead()) {
+				creature->forceUpdatePath();
+			}
+		}
+		return;
+	}
+
+	// The path searches only read the map and the creatures, so they run on the worker pool while this thread waits
+	// for them, all against the same state. Afterwards every creature gets its walk update posted exactly like on the
+	// serial path, the update takes the planned path if the creature and its target have not moved since the search
+	// and every tile of the path is still walkable, and searches again otherwise.
+	std::vector<Creature*> creatures;
+	for (Creature* creature : checkCreatureList) {
+		if (!creature->isDead() && creature->followCreature && !creature->walksByDistanceStep()) {
+			creatures.push_back(creature);
+		}
+	}
+
+	std::vector<PlannedPath> paths(creatures.size());
+	pathfindingPool.parallelFor(creatures.size(), [&](size_t i) {
+		const Creature* creature = creatures[i];
+		PlannedPath& path = paths[i];
+		path.startPos = creature->getPosition();
+		path.targetPos = creature->followCreature->getPosition();
+		creature->getPathSearchParams(creature->followCreature, path.fpp);
+		path.found = creature->getPathTo(path.targetPos, path.dirList, path.fpp);
+	});
+
+	for (size_t i = 0; i < creatures.size(); ++i) {
+		creatures[i]->plannedPath = std::move(paths[i]);
+	}
+
 	for (Creature* creature : checkCreatureList) {
 		if (!creature->isDead()) {
 			creature->forceUpdatePath();
@@ -4681,9 +4985,11 @@ void Game::addCreatureHealth(const Creature* target)
 
 void Game::addCreatureHealth(const SpectatorVec& spectators, const Creature* target)
 {
+	NetworkMessage msg;
+	ProtocolGame::encodeCreatureHealth(msg, target);
 	for (Creature* spectator : spectators) {
 		if (Player* tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendCreatureHealth(target);
+			tmpPlayer->sendCreatureHealth(target, msg);
 		}
 	}
 }
@@ -4697,9 +5003,11 @@ void Game::addMagicEffect(const Position& pos, uint8_t effect)
 
 void Game::addMagicEffect(const SpectatorVec& spectators, const Position& pos, uint8_t effect)
 {
+	NetworkMessage msg;
+	ProtocolGame::encodeMagicEffect(msg, pos, effect);
 	for (Creature* spectator : spectators) {
 		if (Player* tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendMagicEffect(pos, effect);
+			tmpPlayer->sendMagicEffect(pos, msg);
 		}
 	}
 }
@@ -4717,9 +5025,11 @@ void Game::addDistanceEffect(const Position& fromPos, const Position& toPos, uin
 void Game::addDistanceEffect(const SpectatorVec& spectators, const Position& fromPos, const Position& toPos,
                              uint8_t effect)
 {
+	NetworkMessage msg;
+	ProtocolGame::encodeDistanceShoot(msg, fromPos, toPos, effect);
 	for (Creature* spectator : spectators) {
 		if (Player* tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendDistanceShoot(fromPos, toPos, effect);
+			tmpPlayer->sendDistanceShoot(msg);
 		}
 	}
 }
@@ -4744,6 +5054,16 @@ void Game::startDecay(Item* item)
 	}
 }
 
+bool Game::removeDecayEntry(Item* item)
+{
+	if (!decayWheel.remove(item->getDecayEntry(), item)) {
+		return false;
+	}
+
+	ReleaseItem(item);
+	return true;
+}
+
 void Game::internalDecayItem(Item* item)
 {
 	const int32_t decayTo = item->getDecayTo();
@@ -4766,43 +5086,26 @@ void Game::internalDecayItem(Item* item)
 void Game::checkDecay()
 {
 	g_scheduler.addEvent(createSchedulerTask(EVENT_DECAYINTERVAL, [this]() { checkDecay(); }));
-	size_t bucket = (lastBucket + 1) % EVENT_DECAY_BUCKETS;
 
-	auto it = decayItems[bucket].begin(), end = decayItems[bucket].end();
-	while (it != end) {
-		Item* item = *it;
-		if (!item->canDecay()) {
-			item->setDecaying(DECAYING_FALSE);
+	const int64_t now = OTSYS_TIME();
+	decayWheel.advance(now / EVENT_DECAYINTERVAL, expiredDecayItems);
+
+	for (Item* item : expiredDecayItems) {
+		const int64_t deadline = item->getDecayDeadline();
+		if (deadline == 0 || deadline > now) {
+			// paused or rescheduled since this entry was added, a newer entry takes over if it decays again
 			ReleaseItem(item);
-			it = decayItems[bucket].erase(it);
 			continue;
 		}
 
-		int32_t duration = item->getDuration();
-		int32_t decreaseTime = std::min<int32_t>(EVENT_DECAYINTERVAL * EVENT_DECAY_BUCKETS, duration);
-
-		duration -= decreaseTime;
-		item->decreaseDuration(decreaseTime);
-
-		if (duration <= 0) {
-			it = decayItems[bucket].erase(it);
+		item->setDecaying(DECAYING_FALSE);
+		if (item->canDecay()) {
 			internalDecayItem(item);
-			ReleaseItem(item);
-		} else if (duration < EVENT_DECAYINTERVAL * EVENT_DECAY_BUCKETS) {
-			it = decayItems[bucket].erase(it);
-			size_t newBucket = (bucket + ((duration + EVENT_DECAYINTERVAL / 2) / 1000)) % EVENT_DECAY_BUCKETS;
-			if (newBucket == bucket) {
-				internalDecayItem(item);
-				ReleaseItem(item);
-			} else {
-				decayItems[newBucket].push_back(item);
-			}
-		} else {
-			++it;
 		}
+		ReleaseItem(item);
 	}
+	expiredDecayItems.clear();
 
-	lastBucket = bucket;
 	cleanup();
 }
 
@@ -4811,8 +5114,10 @@ void Game::shutdown()
 	std::cout << "Shutting down..." << std::flush;
 
 	g_scheduler.shutdown();
+	g_authWorkers.shutdown();
 	g_databaseTasks.shutdown();
 	g_dispatcher.shutdown();
+	pathfindingPool.shutdown();
 	map.spawns.clear();
 
 	cleanup();
@@ -4840,11 +5145,11 @@ void Game::cleanup()
 	ToReleaseItems.clear();
 
 	for (Item* item : toDecayItems) {
-		const uint32_t dur = item->getDuration();
-		if (dur >= EVENT_DECAYINTERVAL * EVENT_DECAY_BUCKETS) {
-			decayItems[lastBucket].push_back(item);
+		if (const int64_t deadline = item->getDecayDeadline(); deadline != 0) {
+			item->setDecayEntry(decayWheel.insert(item, getDecayTick(deadline)));
 		} else {
-			decayItems[(lastBucket + 1 + dur / 1000) % EVENT_DECAY_BUCKETS].push_back(item);
+			// paused again before it made it into the wheel
+			ReleaseItem(item);
 		}
 	}
 	toDecayItems.clear();
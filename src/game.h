@@ -4,16 +4,20 @@
 #ifndef FS_GAME_H
 #define FS_GAME_H
 
+#include "deadlinewheel.h"
 #include "groups.h"
+#include "iomapserialize.h"
 #include "map.h"
 #include "mounts.h"
 #include "player.h"
 #include "position.h"
 #include "wildcardtree.h"
+#include "workerpool.h"
 
 class Monster;
 class Npc;
 class ServiceManager;
+struct PlayerSnapshot;
 
 enum stackPosType_t
 {
@@ -45,7 +49,6 @@ enum GameState_t
 static constexpr int32_t PLAYER_NAME_LENGTH = 25;
 
 static constexpr int32_t EVENT_DECAYINTERVAL = 250;
-static constexpr int32_t EVENT_DECAY_BUCKETS = 4;
 
 static constexpr int32_t MOVE_CREATURE_INTERVAL = 1000;
 static constexpr int32_t RANGE_MOVE_CREATURE_INTERVAL = 1500;
@@ -62,6 +65,18 @@ static constexpr int32_t MAX_STACKPOS = 10;
 
 static constexpr uint8_t ITEM_STACK_SIZE = 100;
 
+// Timings of the last asynchronous world save, in microseconds. The snapshot is taken on the dispatcher thread, the
+// write time is spent by the database thread while the game keeps running.
+struct WorldSaveStats
+{
+	int64_t snapshotTime = 0;
+	int64_t longestSlice = 0;
+	int64_t writeTime = 0;
+	uint32_t slices = 0;
+	uint32_t players = 0;
+	bool success = true;
+};
+
 /**
  * Main Game class.
  * This class is responsible to control everything that happens
@@ -205,6 +220,10 @@ public:
 	void addCreatureCheck(Creature* creature);
 	static void removeCreatureCheck(Creature* creature);
 
+	size_t getCreatureCheckBucketSize(size_t index) const { return checkCreatureLists[index].size(); }
+	// time the last think of the bucket took
+	std::chrono::microseconds getCreatureCheckBucketTime(size_t index) const { return checkCreatureTimes[index]; }
+
 	size_t getPlayersOnline() const { return players.size(); }
 	size_t getMonstersOnline() const { return monsters.size(); }
 	size_t getNpcsOnline() const { return npcs.size(); }
@@ -419,12 +438,24 @@ public:
 	void setGameState(GameState_t newState);
 	void saveGameState();
 
+	// Starts a world save that snapshots the players and houses in slices of WORLD_SAVE_SLICE_TIME and writes them on
+	// the database thread. Returns false if a world save is already running.
+	bool startWorldSave();
+	bool isWorldSaveRunning() const { return worldSave.has_value(); }
+	const WorldSaveStats& getWorldSaveStats() const { return worldSaveStats; }
+
+	// a snapshot of the player has not been written yet, it must not be loaded from the database until it is
+	bool isPlayerSavePending(uint32_t guid) const { return pendingPlayerSaves.contains(guid); }
+	bool hasPendingPlayerSaves() const { return !pendingPlayerSaves.empty(); }
+	void queuePlayerSave(PlayerSnapshot&& snapshot);
+
 	// Events
 	void checkCreatureWalk(uint32_t creatureId);
 	void updateCreatureWalk(uint32_t creatureId);
 	void checkCreatureAttack(uint32_t creatureId);
 	void checkCreatures(size_t index);
 	void updateCreaturesPath(size_t index);
+	void rebalanceCreatureChecks(size_t index);
 
 	bool combatBlockHit(CombatDamage& damage, Creature* attacker, Creature* target, bool checkDefense, bool checkArmor,
 	                    bool field, bool ignoreResistances = false);
@@ -444,6 +475,9 @@ public:
 	                              uint8_t effect);
 
 	void startDecay(Item* item);
+	// drops the wheel entry of a running decay right away, together with the reference it holds. Returns false if the
+	// item has no entry yet because it still waits in toDecayItems.
+	bool removeDecayEntry(Item* item);
 
 	void sendOfflineTrainingDialog(Player* player);
 
@@ -503,20 +537,32 @@ private:
 	void checkDecay();
 	void internalDecayItem(Item* item);
 
+	void continueWorldSave();
+	void finishWorldSaveWrite(uint32_t saveId, bool saved, int64_t writeTime);
+	void writePlayerSnapshots(std::vector<PlayerSnapshot>&& snapshots, uint32_t saveId);
+
 	std::unordered_map<uint32_t, Player*> players;
 	std::unordered_map<std::string, Player*> mappedPlayerNames;
 	std::unordered_map<uint32_t, Player*> mappedPlayerGuids;
 	std::unordered_map<uint32_t, Guild_ptr> guilds;
 	std::unordered_map<uint16_t, Item*> uniqueItems;
 
-	std::list<Item*> decayItems[EVENT_DECAY_BUCKETS];
-	std::list<Creature*> checkCreatureLists[EVENT_CREATURECOUNT];
+	// Decaying items by the tick (EVENT_DECAYINTERVAL) in which their decay deadline passes. Every entry holds a
+	// reference to its item. Removing an item or changing its duration drops its entry right away, an item that is only
+	// paused keeps it until it expires and is recognised as outdated by its decay deadline.
+	DeadlineWheel<Item*> decayWheel{static_cast<uint64_t>(OTSYS_TIME() / EVENT_DECAYINTERVAL)};
+	std::vector<Item*> expiredDecayItems;
+	// Creatures think in EVENT_CREATURECOUNT buckets, one bucket every EVENT_CHECK_CREATURE_INTERVAL. Creatures that
+	// stopped thinking are removed while their bucket is walked, the last creature of the bucket takes their slot.
+	std::vector<Creature*> checkCreatureLists[EVENT_CREATURECOUNT];
+	std::chrono::microseconds checkCreatureTimes[EVENT_CREATURECOUNT] = {};
+
+	// searches the paths of a creature bucket in parallel, see updateCreaturesPath
+	WorkerPool pathfindingPool;
 
 	std::vector<Creature*> ToReleaseCreatures;
 	std::vector<Item*> ToReleaseItems;
 
-	size_t lastBucket = 0;
-
 	WildcardTreeNode wildcardTree{false};
 
 	std::map<uint32_t, Npc*> npcs;
@@ -529,6 +575,29 @@ private:
 
 	std::unordered_set<Tile*> tilesToClean;
 
+	// State of the running world save. The players and houses are looked up again for every slice, whatever was removed
+	// in the meantime has been saved on its own already.
+	struct WorldSave
+	{
+		uint32_t id = 0;
+		std::vector<uint32_t> playerIds;
+		std::vector<uint32_t> houseIds;
+		size_t nextPlayer = 0;
+		size_t nextHouse = 0;
+		HousesSnapshot houses;
+		WorldSaveStats stats;
+		// jobs of this save that the database tasks have not finished yet
+		size_t pendingWrites = 0;
+		bool snapshotDone = false;
+	};
+
+	std::optional<WorldSave> worldSave;
+	WorldSaveStats worldSaveStats;
+	uint32_t lastWorldSaveId = 0;
+
+	// number of snapshots per player guid that are waiting for the database thread
+	std::unordered_map<uint32_t, uint32_t> pendingPlayerSaves;
+
 	ModalWindow offlineTrainingWindow{std::numeric_limits<uint32_t>::max(), "Choose a Skill", "Please choose a skill:"};
 
 	GameState_t gameState = GAME_STATE_NORMAL;
@@ -3,9 +3,11 @@
 #include <boost/beast/http/status.hpp>
 #include <boost/json/value.hpp>
 
+class Database;
+
 namespace tfs::http {
 
 std::pair<boost::beast::http::status, boost::json::value> handle_cacheinfo(const boost::json::object& body,
-                                                                           std::string_view ip);
+                                                                           std::string_view ip, Database& db);
 
 }
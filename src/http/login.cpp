@@ -33,7 +33,7 @@ int getPvpType()
 
 } // namespace
 
-std::pair<status, json::value> tfs::http::handle_login(const json::object& body, std::string_view ip)
+std::pair<status, json::value> tfs::http::handle_login(const json::object& body, std::string_view ip, Database& db)
 {
 	using namespace std::chrono;
 
@@ -49,7 +49,6 @@ std::pair<status, json::value> tfs::http::handle_login(const json::object& body,
 		    {.code = 3, .message = "Tibia account email address or Tibia password is not correct."});
 	}
 
-	thread_local auto& db = Database::getInstance();
 	auto result = db.storeQuery(fmt::format(
 	    "SELECT `id`, UNHEX(`password`) AS `password`, `secret`, `premium_ends_at` FROM `accounts` WHERE `email` = {:s}",
 	    db.escapeString(emailField->get_string())));
@@ -13,15 +13,15 @@ namespace json = boost::json;
 
 namespace {
 
-auto router(std::string_view type, const json::object& body, std::string_view ip)
+auto router(std::string_view type, const json::object& body, std::string_view ip, Database& db)
 {
 	using namespace tfs::http;
 
 	if (type == "cacheinfo") {
-		return handle_cacheinfo(body, ip);
+		return handle_cacheinfo(body, ip, db);
 	}
 	if (type == "login") {
-		return handle_login(body, ip);
+		return handle_login(body, ip, db);
 	}
 
 	return make_error_response();
@@ -32,9 +32,9 @@ thread_local json::monotonic_resource mr;
 } // namespace
 
 beast::http::message_generator tfs::http::handle_request(const beast::http::request<beast::http::string_body>& req,
-                                                         std::string_view ip)
+                                                         std::string_view ip, Database& db)
 {
-	auto&& [status, responseBody] = [&req, ip]() {
+	auto&& [status, responseBody] = [&req, ip, &db]() {
 		boost::system::error_code ec;
 		auto requestBody = json::parse(req.body(), ec, &mr);
 		if (ec || !requestBody.is_object()) {
@@ -47,7 +47,7 @@ beast::http::message_generator tfs::http::handle_request(const beast::http::requ
 			return make_error_response({.code = 2, .message = "Invalid request type."});
 		}
 
-		return router(typeField->get_string(), requestBodyObj, ip);
+		return router(typeField->get_string(), requestBodyObj, ip, db);
 	}();
 
 	beast::http::response<beast::http::string_body> res{status, req.version()};
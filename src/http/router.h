@@ -4,9 +4,11 @@
 
 #include <boost/beast/http/message_generator.hpp>
 
+class Database;
+
 namespace tfs::http {
 
 boost::beast::http::message_generator handle_request(
-    const boost::beast::http::request<boost::beast::http::string_body>& req, std::string_view ip);
+    const boost::beast::http::request<boost::beast::http::string_body>& req, std::string_view ip, Database& db);
 
 } // namespace tfs::http
@@ -1,8 +1,12 @@
+#include "../otpch.h"
+
 #include "session.h"
 
+#include "../authworkers.h"
 #include "router.h"
 
 #include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/beast/http/read.hpp>
 #include <boost/beast/http/write.hpp>
 #include <fmt/core.h>
@@ -72,8 +76,14 @@ void Session::on_read(beast::error_code ec, size_t /*bytes_transferred*/)
 		return;
 	};
 
+	// the handlers hash passwords and query the database, they run on an auth worker and its connection, the
+	// response is written back on the strand of the session
 	auto ip = stream.socket().remote_endpoint().address().to_string();
-	write(handle_request(std::move(req), ip));
+	g_authWorkers.addTask([self = shared_from_this(), ip = std::move(ip)](Database& db) {
+		asio::post(self->stream.get_executor(), [self, msg = handle_request(self->req, ip, db)]() mutable {
+			self->write(std::move(msg));
+		});
+	});
 }
 
 void Session::on_write(beast::error_code ec, size_t /*bytes_transferred*/, bool keep_alive)
@@ -151,7 +151,7 @@ using status = boost::beast::http::status;
 
 BOOST_FIXTURE_TEST_CASE(test_login_missing_email, LoginFixture)
 {
-	auto&& [status, body] = tfs::http::handle_login({{"type", "login"}, {"password", "bar"}}, ip);
+	auto&& [status, body] = tfs::http::handle_login({{"type", "login"}, {"password", "bar"}}, ip, db);
 
 	BOOST_TEST(status == status::ok);
 	BOOST_TEST(body.at("errorCode").as_int64() == 3);
@@ -160,7 +160,7 @@ BOOST_FIXTURE_TEST_CASE(test_login_missing_email, LoginFixture)
 BOOST_FIXTURE_TEST_CASE(test_login_account_does_not_exist, LoginFixture)
 {
 	auto&& [status, body] =
-	    tfs::http::handle_login({{"type", "login"}, {"email", "k@example.com"}, {"password", "bar"}}, ip);
+	    tfs::http::handle_login({{"type", "login"}, {"email", "k@example.com"}, {"password", "bar"}}, ip, db);
 
 	BOOST_TEST(status == status::ok);
 	BOOST_TEST(body.at("errorCode").as_int64() == 3);
@@ -168,7 +168,7 @@ BOOST_FIXTURE_TEST_CASE(test_login_account_does_not_exist, LoginFixture)
 
 BOOST_FIXTURE_TEST_CASE(test_login_missing_password, LoginFixture)
 {
-	auto&& [status, body] = tfs::http::handle_login({{"type", "login"}, {"email", "foo@example.com"}}, ip);
+	auto&& [status, body] = tfs::http::handle_login({{"type", "login"}, {"email", "foo@example.com"}}, ip, db);
 
 	BOOST_TEST(status == status::ok);
 	BOOST_TEST(body.at("errorCode").as_int64() == 3);
@@ -180,7 +180,7 @@ BOOST_FIXTURE_TEST_CASE(test_login_invalid_password, LoginFixture)
 	    "INSERT INTO `accounts` (`name`, `email`, `password`) VALUES ('abc', 'foo@example.com', SHA1('bar'))"));
 
 	auto&& [status, body] =
-	    tfs::http::handle_login({{"type", "login"}, {"email", "foo@example.com"}, {"password", "baz"}}, ip);
+	    tfs::http::handle_login({{"type", "login"}, {"email", "foo@example.com"}, {"password", "baz"}}, ip, db);
 
 	BOOST_TEST(status == status::ok);
 	BOOST_TEST(body.at("errorCode").as_int64() == 3);
@@ -197,7 +197,7 @@ BOOST_FIXTURE_TEST_CASE(test_login_missing_token, LoginFixture)
 	        {"email", "fooba@example.com"},
 	        {"password", "bar"},
 	    },
-	    ip);
+	    ip, db);
 
 	BOOST_TEST(status == status::ok);
 	BOOST_TEST(body.at("errorCode").as_int64() == 6);
@@ -209,7 +209,7 @@ BOOST_FIXTURE_TEST_CASE(test_login_success_no_players, LoginFixture)
 	    "INSERT INTO `accounts` (`name`, `email`, `password`) VALUES ('defg', 'foobar@example.com', SHA1('bar'))"));
 
 	auto&& [status, body] =
-	    tfs::http::handle_login({{"type", "login"}, {"email", "foobar@example.com"}, {"password", "bar"}}, ip);
+	    tfs::http::handle_login({{"type", "login"}, {"email", "foobar@example.com"}, {"password", "bar"}}, ip, db);
 
 	BOOST_TEST(status == status::ok);
 	auto& characters = body.at("playdata").at("characters").as_array();
@@ -232,7 +232,7 @@ BOOST_FIXTURE_TEST_CASE(test_login_success, LoginFixture)
 	BOOST_TEST(insert.execute());
 
 	auto&& [status, body] =
-	    tfs::http::handle_login({{"type", "login"}, {"email", "ghij@example.com"}, {"password", "bar"}}, ip);
+	    tfs::http::handle_login({{"type", "login"}, {"email", "ghij@example.com"}, {"password", "bar"}}, ip, db);
 
 	BOOST_TEST(status == status::ok);
 
@@ -290,7 +290,7 @@ BOOST_FIXTURE_TEST_CASE(test_login_success_with_token, LoginFixture)
 	        {"password", "bar"},
 	        {"token", generateToken("", now.count() / AUTHENTICATOR_PERIOD)},
 	    },
-	    ip);
+	    ip, db);
 
 	BOOST_TEST(status == status::ok);
 }
@@ -0,0 +1,47 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "iocontextpool.h"
+
+IoContextPool::~IoContextPool() { stop(); }
+
+void IoContextPool::start(size_t threadCount)
+{
+	assert(contexts.empty());
+
+	threadCount = std::max<size_t>(threadCount, 1);
+	contexts.reserve(threadCount);
+	workGuards.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i) {
+		// every io_context is run by a single thread, the hint lets asio queue handlers without waking other runners
+		auto& context = contexts.emplace_back(std::make_unique<boost::asio::io_context>(1));
+		workGuards.emplace_back(context->get_executor());
+	}
+
+	threads.reserve(threadCount);
+	for (auto& context : contexts) {
+		threads.emplace_back([&context = *context]() { context.run(); });
+	}
+}
+
+void IoContextPool::stop()
+{
+	workGuards.clear();
+	for (auto& context : contexts) {
+		context->stop();
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	threads.clear();
+}
+
+boost::asio::io_context& IoContextPool::next()
+{
+	assert(!contexts.empty());
+
+	return *contexts[nextContext.fetch_add(1, std::memory_order_relaxed) % contexts.size()];
+}
@@ -0,0 +1,40 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_IOCONTEXTPOOL_H
+#define FS_IOCONTEXTPOOL_H
+
+// Network threads that each run an io_context of their own. Connections are handed out round-robin and stay on the
+// io_context they were created on for their whole life, so reading, decrypting and writing for different connections
+// runs in parallel while the handlers of one connection never run at the same time.
+class IoContextPool
+{
+public:
+	IoContextPool() = default;
+	~IoContextPool();
+
+	// non-copyable
+	IoContextPool(const IoContextPool&) = delete;
+	IoContextPool& operator=(const IoContextPool&) = delete;
+
+	void start(size_t threadCount);
+	// Stops every io_context and waits for the threads, handlers that have not run yet are dropped. The io_contexts
+	// themselves live as long as the pool, sockets that were created on them may still be closed afterwards.
+	void stop();
+
+	size_t size() const { return contexts.size(); }
+
+	// the io_context of the next connection, the acceptors are reopened from the scheduler thread as well
+	boost::asio::io_context& next();
+
+private:
+	using WorkGuard = boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
+
+	std::vector<std::unique_ptr<boost::asio::io_context>> contexts;
+	std::vector<WorkGuard> workGuards;
+	std::vector<std::thread> threads;
+
+	std::atomic<size_t> nextContext{0};
+};
+
+#endif // FS_IOCONTEXTPOOL_H
@@ -7,9 +7,11 @@
 
 #include "condition.h"
 #include "configmanager.h"
+#include "databasetasks.h"
 #include "depotchest.h"
 #include "game.h"
 #include "inbox.h"
+#include "itemblob.h"
 #include "storeinbox.h"
 
 extern Game g_game;
@@ -60,10 +62,9 @@ void IOLoginData::updateOnlineStatus(uint32_t guid, bool login)
 	}
 
 	if (login) {
-		Database::getInstance().executeQuery(fmt::format("INSERT INTO `players_online` VALUES ({:d})", guid));
+		Database::getInstance().executeStatement("INSERT INTO `players_online` VALUES (?)", guid);
 	} else {
-		Database::getInstance().executeQuery(
-		    fmt::format("DELETE FROM `players_online` WHERE `player_id` = {:d}", guid));
+		Database::getInstance().executeStatement("DELETE FROM `players_online` WHERE `player_id` = ?", guid);
 	}
 }
 
@@ -71,9 +72,9 @@ bool IOLoginData::preloadPlayer(Player* player)
 {
 	Database& db = Database::getInstance();
 
-	DBResult_ptr result = db.storeQuery(fmt::format(
-	    "SELECT `p`.`name`, `p`.`account_id`, `p`.`group_id`, `a`.`type`, `a`.`premium_ends_at` FROM `players` AS `p` JOIN `accounts` AS `a` ON `a`.`id` = `p`.`account_id` WHERE `p`.`id` = {:d} AND `p`.`deletion` = 0",
-	    player->getGUID()));
+	DBResult_ptr result = db.storeStatement(
+	    "SELECT `p`.`name`, `p`.`account_id`, `p`.`group_id`, `a`.`type`, `a`.`premium_ends_at` FROM `players` AS `p` JOIN `accounts` AS `a` ON `a`.`id` = `p`.`account_id` WHERE `p`.`id` = ? AND `p`.`deletion` = 0",
+	    player->getGUID());
 	if (!result) {
 		return false;
 	}
@@ -94,22 +95,34 @@ bool IOLoginData::preloadPlayer(Player* player)
 
 bool IOLoginData::loadPlayerById(Player* player, uint32_t id)
 {
+	// the world save may still be writing an older snapshot of the player
+	if (g_game.isPlayerSavePending(id)) {
+		g_databaseTasks.flush(DatabaseTasks::playerKey(id));
+	}
+
 	Database& db = Database::getInstance();
 	return loadPlayer(
 	    player,
-	    db.storeQuery(fmt::format(
-	        "SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `lookmount`, `lookmounthead`, `lookmountbody`, `lookmountlegs`, `lookmountfeet`, `currentmount`, `randomizemount`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `id` = {:d}",
-	        id)));
+	    db.storeStatement(
+	        "SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `lookmount`, `lookmounthead`, `lookmountbody`, `lookmountlegs`, `lookmountfeet`, `currentmount`, `randomizemount`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `id` = ?",
+	        id));
 }
 
 bool IOLoginData::loadPlayerByName(Player* player, const std::string& name)
 {
+	// the world save may still be writing an older snapshot of the player, only its own saves are waited for
+	if (g_game.hasPendingPlayerSaves()) {
+		if (uint32_t guid = getGuidByName(name); guid != 0 && g_game.isPlayerSavePending(guid)) {
+			g_databaseTasks.flush(DatabaseTasks::playerKey(guid));
+		}
+	}
+
 	Database& db = Database::getInstance();
 	return loadPlayer(
 	    player,
-	    db.storeQuery(fmt::format(
-	        "SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `lookmount`, `lookmounthead`, `lookmountbody`, `lookmountlegs`, `lookmountfeet`, `currentmount`, `randomizemount`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `name` = {:s}",
-	        db.escapeString(name))));
+	    db.storeStatement(
+	        "SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `lookmount`, `lookmounthead`, `lookmountbody`, `lookmountlegs`, `lookmountfeet`, `currentmount`, `randomizemount`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `name` = ?",
+	        name));
 }
 
 static GuildWarVector getWarList(uint32_t guildId)
@@ -143,8 +156,7 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 
 	uint32_t accountId = result->getNumber<uint32_t>("account_id");
 
-	auto account =
-	    db.storeQuery(fmt::format("SELECT `type`, `premium_ends_at` FROM `accounts` WHERE `id` = {:d}", accountId));
+	auto account = db.storeStatement("SELECT `type`, `premium_ends_at` FROM `accounts` WHERE `id` = ?", accountId);
 	if (!account) {
 		return false;
 	}
@@ -346,17 +358,28 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 		}
 	}
 
+	// the rows that were loaded are the rows that the next save compares with
+	SavedRows<std::string>::Rows spellRows;
 	if ((result = db.storeQuery(fmt::format("SELECT `player_id`, `name` FROM `player_spells` WHERE `player_id` = {:d}",
 	                                        player->getGUID())))) {
 		do {
-			player->learnedInstantSpellList.emplace_front(result->getString("name"));
+			auto name = result->getString("name");
+			player->learnedInstantSpellList.emplace_front(name);
+			spellRows.try_emplace(std::string{name});
 		} while (result->next());
 	}
+	player->savedSpells.reset(std::move(spellRows));
 
 	// load inventory items
 	ItemMap itemMap;
 	std::map<uint8_t, Container*> openContainersList;
 
+	// items that were saved with playerItemBlobs, a save clears the rows of the other format
+	if ((result = db.storeQuery(fmt::format(
+	         "SELECT `type`, `pid`, `data` FROM `player_item_blobs` WHERE `player_id` = {:d}", player->getGUID())))) {
+		loadItemBlobs(player, result, openContainersList);
+	}
+
 	if ((result = db.storeQuery(fmt::format(
 	         "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_items` WHERE `player_id` = {:d} ORDER BY `sid` DESC",
 	         player->getGUID())))) {
@@ -488,12 +511,19 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 	}
 
 	// load storage map
+	SavedRows<uint32_t, int32_t>::Rows storageRows;
 	if ((result = db.storeQuery(
 	         fmt::format("SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = {:d}", player->getGUID())))) {
+		const size_t keyColumn = result->getColumnIndex("key");
+		const size_t valueColumn = result->getColumnIndex("value");
 		do {
-			player->setStorageValue(result->getNumber<uint32_t>("key"), result->getNumber<int32_t>("value"), true);
+			const auto key = result->getNumber<uint32_t>(keyColumn);
+			const auto value = result->getNumber<int32_t>(valueColumn);
+			player->setStorageValue(key, value, true);
+			storageRows.emplace(key, value);
 		} while (result->next());
 	}
+	player->savedStorage.reset(std::move(storageRows));
 
 	// load vip list
 	if ((result = db.storeQuery(fmt::format("SELECT `player_id` FROM `account_viplist` WHERE `account_id` = {:d}",
@@ -504,20 +534,29 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 	}
 
 	// load outfits & addons
+	SavedRows<uint16_t, uint8_t>::Rows outfitRows;
 	if ((result = db.storeQuery(fmt::format(
 	         "SELECT `outfit_id`, `addons` FROM `player_outfits` WHERE `player_id` = {:d}", player->getGUID())))) {
 		do {
-			player->addOutfit(result->getNumber<uint16_t>("outfit_id"), result->getNumber<uint8_t>("addons"));
+			const auto lookType = result->getNumber<uint16_t>("outfit_id");
+			const auto addons = result->getNumber<uint8_t>("addons");
+			player->addOutfit(lookType, addons);
+			outfitRows.emplace(lookType, addons);
 		} while (result->next());
 	}
+	player->savedOutfits.reset(std::move(outfitRows));
 
 	// load mounts
+	SavedRows<uint16_t>::Rows mountRows;
 	if ((result = db.storeQuery(
 	         fmt::format("SELECT `mount_id` FROM `player_mounts` WHERE `player_id` = {:d}", player->getGUID())))) {
 		do {
-			player->tameMount(result->getNumber<uint16_t>("mount_id"));
+			const auto mountId = result->getNumber<uint16_t>("mount_id");
+			player->tameMount(mountId);
+			mountRows.try_emplace(mountId);
 		} while (result->next());
 	}
+	player->savedMounts.reset(std::move(mountRows));
 
 	player->updateBaseSpeed();
 	player->updateInventoryWeight();
@@ -525,7 +564,72 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 	return true;
 }
 
-bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList, DBInsert& query_insert,
+template <typename Key, typename Format>
+static std::string joinKeys(const std::vector<Key>& keys, Format&& format)
+{
+	std::string list;
+	for (const Key& key : keys) {
+		if (!list.empty()) {
+			list.append(", ");
+		}
+		list.append(format(key));
+	}
+	return list;
+}
+
+constexpr std::array<std::string_view, PLAYER_ITEMS_LAST + 1> itemTableNames = {
+    "player_items", "player_depotitems", "player_inboxitems", "player_storeinboxitems"};
+
+static std::string getItemRowsDigest(const std::vector<std::string>& rows)
+{
+	std::string joinedRows;
+	for (const std::string& row : rows) {
+		joinedRows.append(row);
+		joinedRows.push_back('\n');
+	}
+	return transformToSHA1(joinedRows);
+}
+
+// The item rows refer to each other through pid and sid, an item that changed shifts the numbering of every row after
+// it, so an item table is rewritten as a whole. Only the tables whose digest changed are passed in here.
+static bool saveItemRows(PlayerSnapshot& snapshot, PlayerItemTable_t table, bool blobs,
+                         const std::vector<std::string>& rows)
+{
+	// the format that is not in use is cleared as well, switching playerItemBlobs moves the items with the next save
+	snapshot.queries.push_back(
+	    fmt::format("DELETE FROM `{:s}` WHERE `player_id` = {:d}", itemTableNames[table], snapshot.guid));
+	snapshot.queries.push_back(fmt::format("DELETE FROM `player_item_blobs` WHERE `player_id` = {:d} AND `type` = {:d}",
+	                                       snapshot.guid, std::to_underlying(table)));
+
+	DBInsert query(blobs ? "INSERT INTO `player_item_blobs` (`player_id`, `type`, `pid`, `data`) VALUES "
+	                     : fmt::format("INSERT INTO `{:s}` (`player_id`, `pid`, `sid`, `itemtype`, `count`, "
+	                                   "`attributes`) VALUES ",
+	                                   itemTableNames[table]),
+	               snapshot.queries);
+	for (const std::string& row : rows) {
+		if (!query.addRow(row)) {
+			return false;
+		}
+	}
+	return query.execute();
+}
+
+// remembers which containers the player has open, so that they are opened again on the next login
+static void updateOpenContainer(const Player* player, Container* container)
+{
+	if (container->getIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER)) {
+		container->setIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER, 0);
+	}
+
+	for (const auto& it : player->getOpenContainers()) {
+		if (it.second.container == container) {
+			container->setIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER, static_cast<int64_t>(it.first) + 1);
+			break;
+		}
+	}
+}
+
+void IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList, std::vector<std::string>& rows,
                             PropWriteStream& propWriteStream)
 {
 	using ContainerBlock = std::pair<Container*, int32_t>;
@@ -533,7 +637,6 @@ bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList,
 	containers.reserve(32);
 
 	int32_t runningId = 100;
-	const auto& openContainers = player->getOpenContainers();
 
 	Database& db = Database::getInstance();
 	for (const auto& it : itemList) {
@@ -542,33 +645,15 @@ bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList,
 		++runningId;
 
 		if (Container* container = item->getContainer()) {
-			if (container->getIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER)) {
-				container->setIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER, 0);
-			}
-
-			if (!openContainers.empty()) {
-				for (const auto& its : openContainers) {
-					auto openContainer = its.second;
-					auto opcontainer = openContainer.container;
-
-					if (opcontainer == container) {
-						container->setIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER, static_cast<int64_t>(its.first) + 1);
-						break;
-					}
-				}
-			}
-
+			updateOpenContainer(player, container);
 			containers.emplace_back(container, runningId);
 		}
 
 		propWriteStream.clear();
 		item->serializeAttr(propWriteStream);
 
-		if (!query_insert.addRow(fmt::format("{:d}, {:d}, {:d}, {:d}, {:d}, {:s}", player->getGUID(), pid, runningId,
-		                                     item->getID(), item->getSubType(),
-		                                     db.escapeString(propWriteStream.getStream())))) {
-			return false;
-		}
+		rows.push_back(fmt::format("{:d}, {:d}, {:d}, {:d}, {:d}, {:s}", player->getGUID(), pid, runningId,
+		                           item->getID(), item->getSubType(), db.escapeString(propWriteStream.getStream())));
 	}
 
 	for (size_t i = 0; i < containers.size(); i++) {
@@ -582,309 +667,485 @@ bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList,
 			Container* subContainer = item->getContainer();
 			if (subContainer) {
 				containers.emplace_back(subContainer, runningId);
-
-				if (subContainer->getIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER)) {
-					subContainer->setIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER, 0);
-				}
-
-				if (!openContainers.empty()) {
-					for (const auto& it : openContainers) {
-						auto openContainer = it.second;
-						auto opcontainer = openContainer.container;
-
-						if (opcontainer == subContainer) {
-							subContainer->setIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER, it.first + 1);
-							break;
-						}
-					}
-				}
+				updateOpenContainer(player, subContainer);
 			}
 
 			propWriteStream.clear();
 			item->serializeAttr(propWriteStream);
 
-			if (!query_insert.addRow(fmt::format("{:d}, {:d}, {:d}, {:d}, {:d}, {:s}", player->getGUID(), parentId,
-			                                     runningId, item->getID(), item->getSubType(),
-			                                     db.escapeString(propWriteStream.getStream())))) {
-				return false;
-			}
+			rows.push_back(fmt::format("{:d}, {:d}, {:d}, {:d}, {:d}, {:s}", player->getGUID(), parentId, runningId,
+			                           item->getID(), item->getSubType(),
+			                           db.escapeString(propWriteStream.getStream())));
 		}
 	}
-	return query_insert.execute();
 }
 
-bool IOLoginData::savePlayer(Player* player)
+void IOLoginData::saveItemBlobs(const Player* player, PlayerItemTable_t table, const ItemBlockList& itemList,
+                                std::vector<std::string>& rows, PropWriteStream& propWriteStream)
 {
-	if (player->isDead()) {
-		player->changeHealth(1);
+	std::map<int32_t, std::vector<Item*>> blobItems;
+	for (const auto& [pid, item] : itemList) {
+		blobItems[pid].push_back(item);
 	}
 
+	// one blob for every slot or depot, the items are written in reverse as loading adds every item to the front
 	Database& db = Database::getInstance();
+	for (const auto& [pid, items] : blobItems) {
+		propWriteStream.clear();
+		propWriteStream.write<uint32_t>(items.size());
+		for (auto it = items.rbegin(), end = items.rend(); it != end; ++it) {
+			saveItemTree(player, *it, propWriteStream);
+		}
 
-	DBResult_ptr result =
-	    db.storeQuery(fmt::format("SELECT `save` FROM `players` WHERE `id` = {:d}", player->getGUID()));
-	if (!result) {
-		return false;
+		const std::string blob = tfs::itemblob::pack(propWriteStream.getStream());
+		rows.push_back(fmt::format("{:d}, {:d}, {:d}, {:s}", player->getGUID(), std::to_underlying(table), pid,
+		                           db.escapeBlob(blob.data(), blob.size())));
 	}
+}
 
-	if (result->getNumber<uint16_t>("save") == 0) {
-		return db.executeQuery(
-		    fmt::format("UPDATE `players` SET `lastlogin` = {:d}, `lastip` = INET6_ATON('{:s}') WHERE `id` = {:d}",
-		                player->lastLoginSaved, player->lastIP.to_string(), player->getGUID()));
+void IOLoginData::saveItemTree(const Player* player, Item* item, PropWriteStream& propWriteStream)
+{
+	Container* container = item->getContainer();
+	if (container) {
+		updateOpenContainer(player, container);
 	}
 
-	// serialize conditions
-	PropWriteStream propWriteStream;
-	for (Condition* condition : player->conditions) {
-		if (condition->isPersistent()) {
-			condition->serialize(propWriteStream);
-			propWriteStream.write<uint8_t>(CONDITIONATTR_END);
+	propWriteStream.write<uint16_t>(item->getID());
+	item->serializeAttr(propWriteStream);
+
+	if (container) {
+		// the same layout as the house items, see IOMapSerialize::saveItem
+		propWriteStream.write<uint8_t>(ATTR_CONTAINER_ITEMS);
+		propWriteStream.write<uint32_t>(container->size());
+		for (auto it = container->getReversedItems(), end = container->getReversedEnd(); it != end; ++it) {
+			saveItemTree(player, *it, propWriteStream);
 		}
 	}
 
-	// First, an UPDATE query to write the player itself
-	std::ostringstream query;
-	query << "UPDATE `players` SET ";
-	query << "`level` = " << player->level << ',';
-	query << "`group_id` = " << player->group->id << ',';
-	query << "`vocation` = " << player->getVocationId() << ',';
-	query << "`health` = " << player->health << ',';
-	query << "`healthmax` = " << player->healthMax << ',';
-	query << "`experience` = " << player->experience << ',';
-	query << "`lookbody` = " << static_cast<uint32_t>(player->defaultOutfit.lookBody) << ',';
-	query << "`lookfeet` = " << static_cast<uint32_t>(player->defaultOutfit.lookFeet) << ',';
-	query << "`lookhead` = " << static_cast<uint32_t>(player->defaultOutfit.lookHead) << ',';
-	query << "`looklegs` = " << static_cast<uint32_t>(player->defaultOutfit.lookLegs) << ',';
-	query << "`looktype` = " << player->defaultOutfit.lookType << ',';
-	query << "`lookaddons` = " << static_cast<uint32_t>(player->defaultOutfit.lookAddons) << ',';
-	query << "`lookmount` = " << player->defaultOutfit.lookMount << ',';
-	query << "`lookmounthead` = " << static_cast<uint32_t>(player->defaultOutfit.lookMountHead) << ',';
-	query << "`lookmountbody` = " << static_cast<uint32_t>(player->defaultOutfit.lookMountBody) << ',';
-	query << "`lookmountlegs` = " << static_cast<uint32_t>(player->defaultOutfit.lookMountLegs) << ',';
-	query << "`lookmountfeet` = " << static_cast<uint32_t>(player->defaultOutfit.lookMountFeet) << ',';
-	query << "`currentmount` = " << static_cast<uint16_t>(player->currentMount) << ',';
-	query << "`randomizemount` = " << player->randomizeMount << ",";
-	query << "`maglevel` = " << player->magLevel << ',';
-	query << "`mana` = " << player->mana << ',';
-	query << "`manamax` = " << player->manaMax << ',';
-	query << "`manaspent` = " << player->manaSpent << ',';
-	query << "`soul` = " << static_cast<uint16_t>(player->soul) << ',';
-	query << "`town_id` = " << player->town->id << ',';
+	propWriteStream.write<uint8_t>(0x00); // attr end
+}
 
-	const Position& loginPosition = player->getLoginPosition();
-	query << "`posx` = " << loginPosition.getX() << ',';
-	query << "`posy` = " << loginPosition.getY() << ',';
-	query << "`posz` = " << loginPosition.getZ() << ',';
+void IOLoginData::loadItemBlobs(Player* player, DBResult_ptr result, std::map<uint8_t, Container*>& openContainers)
+{
+	std::string buffer;
+	do {
+		const auto table = result->getNumber<uint8_t>("type");
+		const auto pid = result->getNumber<int32_t>("pid");
+
+		// uncompressed blobs are read right from the result
+		const auto items = tfs::itemblob::unpack(result->getString("data"), buffer);
+		if (!items) {
+			std::cout << "WARNING: Broken item blob of player " << player->getName() << std::endl;
+			continue;
+		}
 
-	query << "`cap` = " << (player->capacity / 100) << ',';
-	query << "`sex` = " << static_cast<uint16_t>(player->sex) << ',';
+		PropStream propStream;
+		propStream.init(items->data(), items->size());
 
-	if (player->lastLoginSaved != 0) {
-		query << "`lastlogin` = " << player->lastLoginSaved << ',';
+		uint32_t count;
+		if (!propStream.read<uint32_t>(count)) {
+			std::cout << "WARNING: Broken item blob of player " << player->getName() << std::endl;
+			continue;
+		}
+
+		while (count-- > 0) {
+			Item* item = loadItemTree(propStream, table == PLAYER_ITEMS_INVENTORY ? &openContainers : nullptr);
+			if (!item) {
+				std::cout << "WARNING: Serialize error in IOLoginData::loadItemBlobs" << std::endl;
+				break;
+			}
+
+			switch (table) {
+				case PLAYER_ITEMS_INVENTORY:
+					if (pid >= CONST_SLOT_FIRST && pid <= CONST_SLOT_LAST) {
+						player->internalAddThing(pid, item);
+						continue;
+					}
+					break;
+
+				case PLAYER_ITEMS_DEPOT:
+					if (const auto& depotChest = player->getDepotChest(pid, true)) {
+						depotChest->internalAddThing(item);
+						continue;
+					}
+					break;
+
+				case PLAYER_ITEMS_INBOX:
+					player->getInbox()->internalAddThing(item);
+					continue;
+
+				case PLAYER_ITEMS_STOREINBOX:
+					player->getStoreInbox()->internalAddThing(item);
+					continue;
+
+				default:
+					break;
+			}
+			item->decrementReferenceCounter();
+		}
+	} while (result->next());
+}
+
+Item* IOLoginData::loadItemTree(PropStream& propStream, std::map<uint8_t, Container*>* openContainers)
+{
+	uint16_t id;
+	if (!propStream.read<uint16_t>(id)) {
+		return nullptr;
 	}
 
-	if (!player->lastIP.is_unspecified()) {
-		query << "`lastip` = INET6_ATON('" << player->lastIP.to_string() << "'),";
+	Item* item = Item::CreateItem(id);
+	if (!item) {
+		return nullptr;
 	}
 
-	query << "`conditions` = " << db.escapeString(propWriteStream.getStream()) << ',';
+	if (!item->unserializeAttr(propStream)) {
+		item->decrementReferenceCounter();
+		return nullptr;
+	}
 
-	if (g_game.getWorldType() != WORLD_TYPE_PVP_ENFORCED) {
-		int64_t skullTime = 0;
+	if (Container* container = item->getContainer()) {
+		while (container->serializationCount > 0) {
+			Item* child = loadItemTree(propStream, openContainers);
+			if (!child) {
+				item->decrementReferenceCounter();
+				return nullptr;
+			}
 
-		if (player->skullTicks > 0) {
-			skullTime = time(nullptr) + player->skullTicks;
+			container->internalAddThing(child);
+			container->serializationCount--;
 		}
-		query << "`skulltime` = " << skullTime << ',';
 
-		Skulls_t skull = SKULL_NONE;
-		if (player->skull == SKULL_RED) {
-			skull = SKULL_RED;
-		} else if (player->skull == SKULL_BLACK) {
-			skull = SKULL_BLACK;
+		uint8_t endAttr;
+		if (!propStream.read<uint8_t>(endAttr) || endAttr != 0) {
+			item->decrementReferenceCounter();
+			return nullptr;
+		}
+
+		if (openContainers) {
+			if (uint8_t cid = container->getIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER); cid > 0) {
+				openContainers->emplace(cid, container);
+			}
 		}
-		query << "`skull` = " << static_cast<int64_t>(skull) << ',';
-	}
-
-	query << "`lastlogout` = " << player->getLastLogout() << ',';
-	query << "`balance` = " << player->bankBalance << ',';
-	query << "`offlinetraining_time` = " << player->getOfflineTrainingTime() / 1000 << ',';
-	query << "`offlinetraining_skill` = " << player->getOfflineTrainingSkill() << ',';
-	query << "`stamina` = " << player->getStaminaMinutes() << ',';
-
-	query << "`skill_fist` = " << player->skills[SKILL_FIST].level << ',';
-	query << "`skill_fist_tries` = " << player->skills[SKILL_FIST].tries << ',';
-	query << "`skill_club` = " << player->skills[SKILL_CLUB].level << ',';
-	query << "`skill_club_tries` = " << player->skills[SKILL_CLUB].tries << ',';
-	query << "`skill_sword` = " << player->skills[SKILL_SWORD].level << ',';
-	query << "`skill_sword_tries` = " << player->skills[SKILL_SWORD].tries << ',';
-	query << "`skill_axe` = " << player->skills[SKILL_AXE].level << ',';
-	query << "`skill_axe_tries` = " << player->skills[SKILL_AXE].tries << ',';
-	query << "`skill_dist` = " << player->skills[SKILL_DISTANCE].level << ',';
-	query << "`skill_dist_tries` = " << player->skills[SKILL_DISTANCE].tries << ',';
-	query << "`skill_shielding` = " << player->skills[SKILL_SHIELD].level << ',';
-	query << "`skill_shielding_tries` = " << player->skills[SKILL_SHIELD].tries << ',';
-	query << "`skill_fishing` = " << player->skills[SKILL_FISHING].level << ',';
-	query << "`skill_fishing_tries` = " << player->skills[SKILL_FISHING].tries << ',';
-	query << "`direction` = " << static_cast<uint16_t>(player->getDirection()) << ',';
-
-	if (!player->isOffline()) {
-		query << "`onlinetime` = `onlinetime` + " << (time(nullptr) - player->lastLoginSaved) << ',';
-	}
-	query << "`blessings` = " << player->blessings.to_ulong();
-	query << " WHERE `id` = " << player->getGUID();
-
-	DBTransaction transaction;
-	if (!transaction.begin()) {
-		return false;
 	}
+	return item;
+}
 
-	if (!db.executeQuery(query.str())) {
+bool IOLoginData::savePlayer(Player* player)
+{
+	std::optional<PlayerSnapshot> snapshot = snapshotPlayer(player);
+	if (!snapshot) {
 		return false;
 	}
 
-	// learned spells
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_spells` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
+	// an older snapshot of the player is still waiting for the database thread, this one has to be written after it
+	if (g_game.isPlayerSavePending(snapshot->guid)) {
+		g_game.queuePlayerSave(std::move(*snapshot));
+		return true;
 	}
 
-	DBInsert spellsQuery("INSERT INTO `player_spells` (`player_id`, `name`) VALUES ");
-	for (const std::string& spellName : player->learnedInstantSpellList) {
-		if (!spellsQuery.addRow(fmt::format("{:d}, {:s}", player->getGUID(), db.escapeString(spellName)))) {
-			return false;
-		}
+	bool stored = false;
+	const bool saved = saveSnapshot(Database::getInstance(), *snapshot, stored);
+	player->confirmSave(snapshot->sequence, saved && stored);
+	return saved;
+}
+
+bool IOLoginData::saveSnapshot(Database& db, const PlayerSnapshot& snapshot, bool& stored)
+{
+	std::vector<bool> snapshotStored;
+	const bool saved = saveSnapshots(db, {&snapshot, 1}, snapshotStored);
+	stored = saved && snapshotStored.front();
+	return saved;
+}
+
+static bool writeSnapshots(Database& db, std::span<const PlayerSnapshot> snapshots, std::vector<bool>& stored)
+{
+	stored.assign(snapshots.size(), false);
+	if (snapshots.empty()) {
+		return true;
 	}
 
-	if (!spellsQuery.execute()) {
-		return false;
+	std::vector<uint32_t> guids;
+	guids.reserve(snapshots.size());
+	for (const PlayerSnapshot& snapshot : snapshots) {
+		guids.push_back(snapshot.guid);
 	}
 
-	// item saving
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_items` WHERE `player_id` = {:d}", player->getGUID()))) {
+	DBResult_ptr result =
+	    db.storeQuery(fmt::format("SELECT `id`, `save` FROM `players` WHERE `id` IN ({:s})",
+	                              joinKeys(guids, [](uint32_t guid) { return std::to_string(guid); })));
+	if (!result) {
 		return false;
 	}
 
-	DBInsert itemsQuery(
-	    "INSERT INTO `player_items` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
+	std::unordered_map<uint32_t, bool> saveFlags;
+	do {
+		saveFlags.emplace(result->getNumber<uint32_t>(0), result->getNumber<uint16_t>(1) != 0);
+	} while (result->next());
 
-	ItemBlockList itemList;
-	for (int32_t slotId = CONST_SLOT_FIRST; slotId <= CONST_SLOT_LAST; ++slotId) {
-		Item* item = player->inventory[slotId];
-		if (item) {
-			itemList.emplace_back(slotId, item);
+	std::vector<std::string_view> queries;
+	for (size_t i = 0; i < snapshots.size(); ++i) {
+		const PlayerSnapshot& snapshot = snapshots[i];
+		auto it = saveFlags.find(snapshot.guid);
+		if (it == saveFlags.end()) {
+			return false;
+		}
+
+		// only the login is kept, the rows of the snapshot never reach the database
+		if (!it->second) {
+			if (!snapshot.updateLogin(db)) {
+				return false;
+			}
+			continue;
 		}
+		queries.insert(queries.end(), snapshot.queries.begin(), snapshot.queries.end());
+		stored[i] = true;
 	}
 
-	if (!saveItems(player, itemList, itemsQuery, propWriteStream)) {
+	if (queries.empty()) {
+		return true;
+	}
+
+	// all the players in one transaction, sent in as few round trips as the packet size allows
+	DBTransaction transaction{db};
+	if (!transaction.begin()) {
 		return false;
 	}
 
-	// save depot items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_depotitems` WHERE `player_id` = {:d}", player->getGUID()))) {
+	if (!db.executeBatch(queries)) {
 		return false;
 	}
 
-	DBInsert depotQuery(
-	    "INSERT INTO `player_depotitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-	itemList.clear();
+	// End the transaction
+	return transaction.commit();
+}
 
-	for (const auto& it : player->depotChests) {
-		for (Item* item : it.second->getItemList()) {
-			itemList.emplace_back(it.first, item);
+bool IOLoginData::saveSnapshots(Database& db, std::span<const PlayerSnapshot> snapshots, std::vector<bool>& stored)
+{
+	return db.retryTransaction([&]() { return writeSnapshots(db, snapshots, stored); });
+}
+
+std::optional<PlayerSnapshot> IOLoginData::snapshotPlayer(Player* player)
+{
+	if (player->isDead()) {
+		player->changeHealth(1);
+	}
+
+	Database& db = Database::getInstance();
+
+	PlayerSnapshot snapshot;
+	snapshot.guid = player->getGUID();
+	snapshot.sequence = ++player->lastSaveSequence;
+	snapshot.updateLogin = [lastLogin = player->lastLoginSaved, lastIP = player->lastIP.to_string(),
+	                        guid = player->getGUID()](Database& db) {
+		return db.executeStatement(
+		    "UPDATE `players` SET `lastlogin` = ?, `lastip` = INET6_ATON(?) WHERE `id` = ?", lastLogin, lastIP, guid);
+	};
+
+	// serialize conditions
+	PropWriteStream propWriteStream;
+	for (Condition* condition : player->conditions) {
+		if (condition->isPersistent()) {
+			condition->serialize(propWriteStream);
+			propWriteStream.write<uint8_t>(CONDITIONATTR_END);
 		}
 	}
 
-	if (!saveItems(player, itemList, depotQuery, propWriteStream)) {
-		return false;
+	std::optional<time_t> lastLogin;
+	if (player->lastLoginSaved != 0) {
+		lastLogin = player->lastLoginSaved;
 	}
 
-	// save inbox items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_inboxitems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
+	std::optional<std::string> lastIP;
+	if (!player->lastIP.is_unspecified()) {
+		lastIP = player->lastIP.to_string();
 	}
 
-	DBInsert inboxQuery(
-	    "INSERT INTO `player_inboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-	itemList.clear();
+	std::optional<int64_t> skullTime;
+	std::optional<int64_t> skull;
+	if (g_game.getWorldType() != WORLD_TYPE_PVP_ENFORCED) {
+		skullTime = player->skullTicks > 0 ? time(nullptr) + player->skullTicks : 0;
+		skull = player->skull == SKULL_RED || player->skull == SKULL_BLACK ? player->skull : SKULL_NONE;
+	}
 
-	for (Item* item : player->getInbox()->getItemList()) {
-		itemList.emplace_back(0, item);
+	const Position& loginPosition = player->getLoginPosition();
+
+	// First, an UPDATE of the player itself. The columns that are not always written keep their value when the
+	// parameter is NULL, so that every save sends the same statement.
+	snapshot.queries.push_back(std::apply(
+	    [&db](const auto&... values) {
+		    return db.formatStatement(
+		        "UPDATE `players` SET `level` = ?, `group_id` = ?, `vocation` = ?, `health` = ?, `healthmax` = ?, `experience` = ?, `lookbody` = ?, `lookfeet` = ?, `lookhead` = ?, `looklegs` = ?, `looktype` = ?, `lookaddons` = ?, `lookmount` = ?, `lookmounthead` = ?, `lookmountbody` = ?, `lookmountlegs` = ?, `lookmountfeet` = ?, `currentmount` = ?, `randomizemount` = ?, `maglevel` = ?, `mana` = ?, `manamax` = ?, `manaspent` = ?, `soul` = ?, `town_id` = ?, `posx` = ?, `posy` = ?, `posz` = ?, `cap` = ?, `sex` = ?, `lastlogin` = COALESCE(?, `lastlogin`), `lastip` = COALESCE(INET6_ATON(?), `lastip`), `conditions` = ?, `skulltime` = COALESCE(?, `skulltime`), `skull` = COALESCE(?, `skull`), `lastlogout` = ?, `balance` = ?, `offlinetraining_time` = ?, `offlinetraining_skill` = ?, `stamina` = ?, `skill_fist` = ?, `skill_fist_tries` = ?, `skill_club` = ?, `skill_club_tries` = ?, `skill_sword` = ?, `skill_sword_tries` = ?, `skill_axe` = ?, `skill_axe_tries` = ?, `skill_dist` = ?, `skill_dist_tries` = ?, `skill_shielding` = ?, `skill_shielding_tries` = ?, `skill_fishing` = ?, `skill_fishing_tries` = ?, `direction` = ?, `onlinetime` = `onlinetime` + ?, `blessings` = ? WHERE `id` = ?",
+		        values...);
+	    },
+	    std::make_tuple(
+	        player->level, player->group->id, player->getVocationId(), player->health, player->healthMax,
+	        player->experience, player->defaultOutfit.lookBody, player->defaultOutfit.lookFeet,
+	        player->defaultOutfit.lookHead, player->defaultOutfit.lookLegs, player->defaultOutfit.lookType,
+	        player->defaultOutfit.lookAddons, player->defaultOutfit.lookMount, player->defaultOutfit.lookMountHead,
+	        player->defaultOutfit.lookMountBody, player->defaultOutfit.lookMountLegs,
+	        player->defaultOutfit.lookMountFeet, player->currentMount, player->randomizeMount, player->magLevel,
+	        player->mana, player->manaMax, player->manaSpent, player->soul, player->town->id, loginPosition.getX(),
+	        loginPosition.getY(), loginPosition.getZ(), player->capacity / 100, std::to_underlying(player->sex),
+	        std::move(lastLogin), std::move(lastIP), DBBlob{std::string{propWriteStream.getStream()}},
+	        std::move(skullTime), std::move(skull), player->getLastLogout(), player->bankBalance,
+	        player->getOfflineTrainingTime() / 1000, player->getOfflineTrainingSkill(), player->getStaminaMinutes(),
+	        player->skills[SKILL_FIST].level, player->skills[SKILL_FIST].tries, player->skills[SKILL_CLUB].level,
+	        player->skills[SKILL_CLUB].tries, player->skills[SKILL_SWORD].level, player->skills[SKILL_SWORD].tries,
+	        player->skills[SKILL_AXE].level, player->skills[SKILL_AXE].tries, player->skills[SKILL_DISTANCE].level,
+	        player->skills[SKILL_DISTANCE].tries, player->skills[SKILL_SHIELD].level,
+	        player->skills[SKILL_SHIELD].tries, player->skills[SKILL_FISHING].level,
+	        player->skills[SKILL_FISHING].tries, std::to_underlying(player->getDirection()),
+	        player->isOffline() ? 0 : time(nullptr) - player->lastLoginSaved, player->blessings.to_ulong(),
+	        player->getGUID())));
+
+	// only the rows that changed since the last save are written, unless the tables have to be rewritten as a whole
+	const bool rewrite = !getBoolean(ConfigManager::INCREMENTAL_PLAYER_SAVE);
+	const uint32_t guid = player->getGUID();
+
+	// learned spells
+	SavedRows<std::string>::Rows spellRows;
+	for (const std::string& spellName : player->learnedInstantSpellList) {
+		spellRows.try_emplace(spellName);
 	}
 
-	if (!saveItems(player, itemList, inboxQuery, propWriteStream)) {
-		return false;
+	const auto spellChanges = player->savedSpells.update(std::move(spellRows), snapshot.sequence, rewrite);
+	if (spellChanges.rewrite) {
+		snapshot.queries.push_back(fmt::format("DELETE FROM `player_spells` WHERE `player_id` = {:d}", guid));
+	} else if (!spellChanges.removals.empty()) {
+		const std::string names =
+		    joinKeys(spellChanges.removals, [&](const std::string& name) { return db.escapeString(name); });
+		snapshot.queries.push_back(
+		    fmt::format("DELETE FROM `player_spells` WHERE `player_id` = {:d} AND `name` IN ({:s})", guid, names));
 	}
 
-	// save store inbox items
-	if (!db.executeQuery(
-	        fmt::format("DELETE FROM `player_storeinboxitems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
+	DBInsert spellsQuery("INSERT INTO `player_spells` (`player_id`, `name`) VALUES ", snapshot.queries);
+	spellsQuery.upsert({"name"});
+	for (const auto& it : spellChanges.upserts) {
+		if (!spellsQuery.addRow(fmt::format("{:d}, {:s}", guid, db.escapeString(it.first)))) {
+			return std::nullopt;
+		}
 	}
 
-	DBInsert storeInboxQuery(
-	    "INSERT INTO `player_storeinboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-	itemList.clear();
+	if (!spellsQuery.execute()) {
+		return std::nullopt;
+	}
 
-	for (Item* item : player->getStoreInbox()->getItemList()) {
-		itemList.emplace_back(0, item);
+	// item saving, one row for every item or one blob for every slot and depot
+	std::array<ItemBlockList, PLAYER_ITEMS_LAST + 1> itemLists;
+	for (int32_t slotId = CONST_SLOT_FIRST; slotId <= CONST_SLOT_LAST; ++slotId) {
+		Item* item = player->inventory[slotId];
+		if (item) {
+			itemLists[PLAYER_ITEMS_INVENTORY].emplace_back(slotId, item);
+		}
 	}
 
-	if (!saveItems(player, itemList, storeInboxQuery, propWriteStream)) {
-		return false;
+	for (const auto& it : player->depotChests) {
+		for (Item* item : it.second->getItemList()) {
+			itemLists[PLAYER_ITEMS_DEPOT].emplace_back(it.first, item);
+		}
 	}
 
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_storage` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
+	for (Item* item : player->getInbox()->getItemList()) {
+		itemLists[PLAYER_ITEMS_INBOX].emplace_back(0, item);
 	}
 
-	DBInsert storageQuery("INSERT INTO `player_storage` (`player_id`, `key`, `value`) VALUES ");
+	for (Item* item : player->getStoreInbox()->getItemList()) {
+		itemLists[PLAYER_ITEMS_STOREINBOX].emplace_back(0, item);
+	}
 
-	for (const auto& [key, value] : player->getStorageMap()) {
-		if (!storageQuery.addRow(fmt::format("{:d}, {:d}, {:d}", player->getGUID(), key, value))) {
-			return false;
+	const bool itemBlobs = getBoolean(ConfigManager::PLAYER_ITEM_BLOBS);
+	std::array<std::vector<std::string>, PLAYER_ITEMS_LAST + 1> itemRows;
+	SavedRows<uint8_t, std::string>::Rows itemDigests;
+	for (uint8_t i = 0; i <= PLAYER_ITEMS_LAST; ++i) {
+		const auto table = static_cast<PlayerItemTable_t>(i);
+		if (itemBlobs) {
+			saveItemBlobs(player, table, itemLists[table], itemRows[table], propWriteStream);
+		} else {
+			saveItems(player, itemLists[table], itemRows[table], propWriteStream);
 		}
+		itemDigests.emplace(i, getItemRowsDigest(itemRows[table]));
 	}
 
-	if (!storageQuery.execute()) {
-		return false;
+	const auto itemChanges = player->savedItemDigests.update(std::move(itemDigests), snapshot.sequence, rewrite);
+	for (const auto& it : itemChanges.upserts) {
+		const auto table = static_cast<PlayerItemTable_t>(it.first);
+		if (!saveItemRows(snapshot, table, itemBlobs, itemRows[table])) {
+			return std::nullopt;
+		}
 	}
 
-	// save outfits & addons
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_outfits` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
+	// save storage values
+	const auto storageChanges = player->savedStorage.update(player->getStorageMap(), snapshot.sequence, rewrite);
+	if (storageChanges.rewrite) {
+		snapshot.queries.push_back(fmt::format("DELETE FROM `player_storage` WHERE `player_id` = {:d}", guid));
+	} else if (!storageChanges.removals.empty()) {
+		snapshot.queries.push_back(
+		    fmt::format("DELETE FROM `player_storage` WHERE `player_id` = {:d} AND `key` IN ({:s})", guid,
+		                joinKeys(storageChanges.removals, [](uint32_t key) { return std::to_string(key); })));
 	}
 
-	DBInsert outfitQuery("INSERT INTO `player_outfits` (`player_id`, `outfit_id`, `addons`) VALUES ");
+	DBInsert storageQuery("INSERT INTO `player_storage` (`player_id`, `key`, `value`) VALUES ", snapshot.queries);
+	storageQuery.upsert({"value"});
+	for (const auto& [key, value] : storageChanges.upserts) {
+		if (!storageQuery.addRow(fmt::format("{:d}, {:d}, {:d}", guid, key, value))) {
+			return std::nullopt;
+		}
+	}
 
-	for (const auto& it : player->outfits) {
-		if (!outfitQuery.addRow(fmt::format("{:d}, {:d}, {:d}", player->getGUID(), it.first, it.second))) {
-			return false;
+	if (!storageQuery.execute()) {
+		return std::nullopt;
+	}
+
+	// save outfits & addons
+	const auto outfitChanges = player->savedOutfits.update(player->outfits, snapshot.sequence, rewrite);
+	if (outfitChanges.rewrite) {
+		snapshot.queries.push_back(fmt::format("DELETE FROM `player_outfits` WHERE `player_id` = {:d}", guid));
+	} else if (!outfitChanges.removals.empty()) {
+		snapshot.queries.push_back(
+		    fmt::format("DELETE FROM `player_outfits` WHERE `player_id` = {:d} AND `outfit_id` IN ({:s})", guid,
+		                joinKeys(outfitChanges.removals, [](uint16_t lookType) { return std::to_string(lookType); })));
+	}
+
+	DBInsert outfitQuery("INSERT INTO `player_outfits` (`player_id`, `outfit_id`, `addons`) VALUES ", snapshot.queries);
+	outfitQuery.upsert({"addons"});
+	for (const auto& [lookType, addons] : outfitChanges.upserts) {
+		if (!outfitQuery.addRow(fmt::format("{:d}, {:d}, {:d}", guid, lookType, addons))) {
+			return std::nullopt;
 		}
 	}
 
 	if (!outfitQuery.execute()) {
-		return false;
+		return std::nullopt;
 	}
 
 	// save mounts
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_mounts` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
+	SavedRows<uint16_t>::Rows mountRows;
+	for (uint16_t mountId : player->mounts) {
+		mountRows.try_emplace(mountId);
 	}
 
-	DBInsert mountQuery("INSERT INTO `player_mounts` (`player_id`, `mount_id`) VALUES ");
+	const auto mountChanges = player->savedMounts.update(std::move(mountRows), snapshot.sequence, rewrite);
+	if (mountChanges.rewrite) {
+		snapshot.queries.push_back(fmt::format("DELETE FROM `player_mounts` WHERE `player_id` = {:d}", guid));
+	} else if (!mountChanges.removals.empty()) {
+		snapshot.queries.push_back(
+		    fmt::format("DELETE FROM `player_mounts` WHERE `player_id` = {:d} AND `mount_id` IN ({:s})", guid,
+		                joinKeys(mountChanges.removals, [](uint16_t mountId) { return std::to_string(mountId); })));
+	}
 
-	for (const auto& it : player->mounts) {
-		if (!mountQuery.addRow(fmt::format("{:d}, {:d}", player->getGUID(), it))) {
-			return false;
+	DBInsert mountQuery("INSERT INTO `player_mounts` (`player_id`, `mount_id`) VALUES ", snapshot.queries);
+	mountQuery.upsert({"mount_id"});
+	for (const auto& it : mountChanges.upserts) {
+		if (!mountQuery.addRow(fmt::format("{:d}, {:d}", guid, it.first))) {
+			return std::nullopt;
 		}
 	}
 
 	if (!mountQuery.execute()) {
-		return false;
+		return std::nullopt;
 	}
 
-	// End the transaction
-	return transaction.commit();
+	return snapshot;
 }
 
 std::string IOLoginData::getNameByGuid(uint32_t guid)
@@ -952,13 +1213,19 @@ bool IOLoginData::formatPlayerName(std::string& name)
 
 void IOLoginData::loadItems(ItemMap& itemMap, DBResult_ptr result)
 {
+	const size_t sidColumn = result->getColumnIndex("sid");
+	const size_t pidColumn = result->getColumnIndex("pid");
+	const size_t typeColumn = result->getColumnIndex("itemtype");
+	const size_t countColumn = result->getColumnIndex("count");
+	const size_t attributesColumn = result->getColumnIndex("attributes");
+
 	do {
-		uint32_t sid = result->getNumber<uint32_t>("sid");
-		uint32_t pid = result->getNumber<uint32_t>("pid");
-		uint16_t type = result->getNumber<uint16_t>("itemtype");
-		uint16_t count = result->getNumber<uint16_t>("count");
+		uint32_t sid = result->getNumber<uint32_t>(sidColumn);
+		uint32_t pid = result->getNumber<uint32_t>(pidColumn);
+		uint16_t type = result->getNumber<uint16_t>(typeColumn);
+		uint16_t count = result->getNumber<uint16_t>(countColumn);
 
-		auto attr = result->getString("attributes");
+		auto attr = result->getString(attributesColumn);
 		PropStream propStream;
 		propStream.init(attr.data(), attr.size());
 
@@ -7,13 +7,39 @@
 #include "database.h"
 #include "enums.h"
 
+class Container;
 class Item;
 class Player;
+class PropStream;
 class PropWriteStream;
 struct VIPEntry;
 
 using ItemBlockList = std::list<std::pair<int32_t, Item*>>;
 
+// the item tables of a player, also the `type` of the rows in player_item_blobs
+enum PlayerItemTable_t : uint8_t
+{
+	PLAYER_ITEMS_INVENTORY = 0,
+	PLAYER_ITEMS_DEPOT = 1,
+	PLAYER_ITEMS_INBOX = 2,
+	PLAYER_ITEMS_STOREINBOX = 3,
+
+	PLAYER_ITEMS_LAST = PLAYER_ITEMS_STOREINBOX,
+};
+
+// Everything that is written when a player is saved, serialized on the dispatcher thread. It only holds plain
+// statements, so it can be written later or from another thread and connection.
+struct PlayerSnapshot
+{
+	uint32_t guid = 0;
+	// the saved rows of the player are pending under this number until the write is confirmed, see SavedRows
+	uint32_t sequence = 0;
+	// used instead of the full save when the `save` flag of the player is off
+	std::function<bool(Database&)> updateLogin;
+	// the row in `players` first, then the rows of the other tables
+	std::vector<std::string> queries;
+};
+
 class IOLoginData
 {
 public:
@@ -29,6 +55,10 @@ public:
 	static bool loadPlayerByName(Player* player, const std::string& name);
 	static bool loadPlayer(Player* player, DBResult_ptr result);
 	static bool savePlayer(Player* player);
+	static std::optional<PlayerSnapshot> snapshotPlayer(Player* player);
+	// stored tells whether the rows of the snapshot were written, they are not for players whose save flag is off
+	static bool saveSnapshot(Database& db, const PlayerSnapshot& snapshot, bool& stored);
+	static bool saveSnapshots(Database& db, std::span<const PlayerSnapshot> snapshots, std::vector<bool>& stored);
 	static uint32_t getGuidByName(const std::string& name);
 	static bool getGuidByNameEx(uint32_t& guid, bool& specialVip, std::string& name);
 	static std::string getNameByGuid(uint32_t guid);
@@ -49,8 +79,13 @@ private:
 	using ItemMap = std::map<uint32_t, std::pair<Item*, uint32_t>>;
 
 	static void loadItems(ItemMap& itemMap, DBResult_ptr result);
-	static bool saveItems(const Player* player, const ItemBlockList& itemList, DBInsert& query_insert,
+	static void saveItems(const Player* player, const ItemBlockList& itemList, std::vector<std::string>& rows,
 	                      PropWriteStream& propWriteStream);
+	static void saveItemBlobs(const Player* player, PlayerItemTable_t table, const ItemBlockList& itemList,
+	                          std::vector<std::string>& rows, PropWriteStream& propWriteStream);
+	static void saveItemTree(const Player* player, Item* item, PropWriteStream& propWriteStream);
+	static void loadItemBlobs(Player* player, DBResult_ptr result, std::map<uint8_t, Container*>& openContainers);
+	static Item* loadItemTree(PropStream& propStream, std::map<uint8_t, Container*>* openContainers);
 };
 
 #endif // FS_IOLOGINDATA_H
@@ -142,6 +142,10 @@ bool IOMap::loadMap(Map* map, const std::filesystem::path& fileName)
 		return false;
 	}
 
+	if (getBoolean(ConfigManager::MAP_TILE_GRID)) {
+		map->buildTileGrid();
+	}
+
 	std::cout << "> Map loading time: " << (OTSYS_TIME() - start) / (1000.) << " seconds." << std::endl;
 	return true;
 }
@@ -11,50 +11,60 @@
 
 extern Game g_game;
 
-void IOMapSerialize::loadHouseItems(Map* map)
+bool IOMapSerialize::loadHouseItems(Map* map)
 {
 	int64_t start = OTSYS_TIME();
 
-	DBResult_ptr result = Database::getInstance().storeQuery("SELECT `data` FROM `tile_store`");
-	if (!result) {
-		return;
-	}
-
-	do {
-		auto attr = result->getString("data");
+	auto loadTile = [map](const DBResult& result) {
+		auto attr = result.getString(0);
 		PropStream propStream;
 		propStream.init(attr.data(), attr.size());
 
 		uint16_t x, y;
 		uint8_t z;
 		if (!propStream.read<uint16_t>(x) || !propStream.read<uint16_t>(y) || !propStream.read<uint8_t>(z)) {
-			continue;
+			return;
 		}
 
 		Tile* tile = map->getTile(x, y, z);
 		if (!tile) {
-			continue;
+			return;
 		}
 
 		uint32_t item_count;
 		if (!propStream.read<uint32_t>(item_count)) {
-			continue;
+			return;
 		}
 
 		while (item_count--) {
 			loadItem(propStream, tile);
 		}
-	} while (result->next());
+	};
+
+	// The tiles are streamed instead of buffered, on a connection of their own: loading a bed looks up the name of
+	// its sleeper in the meantime. The tiles that were read are already on the map when the stream breaks off, the
+	// next save would then drop the others, so the server must not start.
+	Database db;
+	if (db.connect()) {
+		if (!db.streamQuery("SELECT `data` FROM `tile_store`", loadTile)) {
+			std::cout << "[Error - IOMapSerialize::loadHouseItems] Not all house items could be read" << std::endl;
+			return false;
+		}
+	} else if (DBResult_ptr result = Database::getInstance().storeQuery("SELECT `data` FROM `tile_store`")) {
+		do {
+			loadTile(*result);
+		} while (result->next());
+	}
 	std::cout << "> Loaded house items in: " << (OTSYS_TIME() - start) / (1000.) << " s" << std::endl;
+	return true;
 }
 
-bool IOMapSerialize::saveHouseItems()
+bool IOMapSerialize::saveHouseItems(Database& db, const HousesSnapshot& snapshot)
 {
 	int64_t start = OTSYS_TIME();
-	Database& db = Database::getInstance();
 
 	// Start the transaction
-	DBTransaction transaction;
+	DBTransaction transaction{db};
 	if (!transaction.begin()) {
 		return false;
 	}
@@ -64,21 +74,11 @@ bool IOMapSerialize::saveHouseItems()
 		return false;
 	}
 
-	DBInsert stmt("INSERT INTO `tile_store` (`house_id`, `data`) VALUES ");
-
-	PropWriteStream stream;
-	for (const auto& it : g_game.map.houses.getHouses()) {
-		// save house items
-		House* house = it.second;
-		for (HouseTile* tile : house->getTiles()) {
-			saveTile(stream, tile);
-
-			if (auto attributes = stream.getStream(); !attributes.empty()) {
-				if (!stmt.addRow(fmt::format("{:d}, {:s}", house->getId(), db.escapeString(attributes)))) {
-					return false;
-				}
-				stream.clear();
-			}
+	std::vector<std::string> queries;
+	DBInsert stmt("INSERT INTO `tile_store` (`house_id`, `data`) VALUES ", queries);
+	for (const std::string& row : snapshot.tileRows) {
+		if (!stmt.addRow(row)) {
+			return false;
 		}
 	}
 
@@ -86,6 +86,12 @@ bool IOMapSerialize::saveHouseItems()
 		return false;
 	}
 
+	for (const std::string& query : queries) {
+		if (!db.executeQuery(query)) {
+			return false;
+		}
+	}
+
 	// End the transaction
 	bool success = transaction.commit();
 	std::cout << "> Saved house items in: " << (OTSYS_TIME() - start) / (1000.) << " s" << std::endl;
@@ -280,11 +286,9 @@ bool IOMapSerialize::loadHouseInfo()
 	return true;
 }
 
-bool IOMapSerialize::saveHouseInfo()
+bool IOMapSerialize::saveHouseInfo(Database& db, const HousesSnapshot& snapshot)
 {
-	Database& db = Database::getInstance();
-
-	DBTransaction transaction;
+	DBTransaction transaction{db};
 	if (!transaction.begin()) {
 		return false;
 	}
@@ -293,65 +297,91 @@ bool IOMapSerialize::saveHouseInfo()
 		return false;
 	}
 
-	for (const auto& it : g_game.map.houses.getHouses()) {
-		House* house = it.second;
-		DBResult_ptr result = db.storeQuery(fmt::format("SELECT `id` FROM `houses` WHERE `id` = {:d}", house->getId()));
+	for (const auto& house : snapshot.houses) {
+		DBResult_ptr result = db.storeQuery(fmt::format("SELECT `id` FROM `houses` WHERE `id` = {:d}", house.id));
 		if (result) {
-			db.executeQuery(fmt::format(
-			    "UPDATE `houses` SET `owner` = {:d}, `paid` = {:d}, `warnings` = {:d}, `name` = {:s}, `town_id` = {:d}, `rent` = {:d}, `size` = {:d}, `beds` = {:d} WHERE `id` = {:d}",
-			    house->getOwner(), house->getPaidUntil(), house->getPayRentWarnings(),
-			    db.escapeString(house->getName()), house->getTownId(), house->getRent(), house->getTiles().size(),
-			    house->getBedCount(), house->getId()));
+			db.executeQuery(house.updateQuery);
 		} else {
-			db.executeQuery(fmt::format(
-			    "INSERT INTO `houses` (`id`, `owner`, `paid`, `warnings`, `name`, `town_id`, `rent`, `size`, `beds`) VALUES ({:d}, {:d}, {:d}, {:d}, {:s}, {:d}, {:d}, {:d}, {:d})",
-			    house->getId(), house->getOwner(), house->getPaidUntil(), house->getPayRentWarnings(),
-			    db.escapeString(house->getName()), house->getTownId(), house->getRent(), house->getTiles().size(),
-			    house->getBedCount()));
+			db.executeQuery(house.insertQuery);
 		}
 	}
 
-	DBInsert stmt("INSERT INTO `house_lists` (`house_id` , `listid` , `list`) VALUES ");
-
-	for (const auto& it : g_game.map.houses.getHouses()) {
-		House* house = it.second;
+	std::vector<std::string> queries;
+	DBInsert stmt("INSERT INTO `house_lists` (`house_id` , `listid` , `list`) VALUES ", queries);
+	for (const std::string& row : snapshot.listRows) {
+		if (!stmt.addRow(row)) {
+			return false;
+		}
+	}
 
-		std::string listText;
-		if (house->getAccessList(GUEST_LIST, listText) && !listText.empty()) {
-			if (!stmt.addRow(fmt::format("{:d}, {:d}, {:s}", house->getId(), std::to_underlying(GUEST_LIST),
-			                             db.escapeString(listText)))) {
-				return false;
-			}
+	if (!stmt.execute()) {
+		return false;
+	}
 
-			listText.clear();
+	for (const std::string& query : queries) {
+		if (!db.executeQuery(query)) {
+			return false;
 		}
+	}
 
-		if (house->getAccessList(SUBOWNER_LIST, listText) && !listText.empty()) {
-			if (!stmt.addRow(fmt::format("{:d}, {:d}, {:s}", house->getId(), std::to_underlying(SUBOWNER_LIST),
-			                             db.escapeString(listText)))) {
-				return false;
-			}
+	return transaction.commit();
+}
+
+void IOMapSerialize::snapshotHouse(House* house, HousesSnapshot& snapshot)
+{
+	Database& db = Database::getInstance();
+
+	snapshot.houses.push_back(
+	    {house->getId(),
+	     fmt::format(
+	         "UPDATE `houses` SET `owner` = {:d}, `paid` = {:d}, `warnings` = {:d}, `name` = {:s}, `town_id` = {:d}, `rent` = {:d}, `size` = {:d}, `beds` = {:d} WHERE `id` = {:d}",
+	         house->getOwner(), house->getPaidUntil(), house->getPayRentWarnings(), db.escapeString(house->getName()),
+	         house->getTownId(), house->getRent(), house->getTiles().size(), house->getBedCount(), house->getId()),
+	     fmt::format(
+	         "INSERT INTO `houses` (`id`, `owner`, `paid`, `warnings`, `name`, `town_id`, `rent`, `size`, `beds`) VALUES ({:d}, {:d}, {:d}, {:d}, {:s}, {:d}, {:d}, {:d}, {:d})",
+	         house->getId(), house->getOwner(), house->getPaidUntil(), house->getPayRentWarnings(),
+	         db.escapeString(house->getName()), house->getTownId(), house->getRent(), house->getTiles().size(),
+	         house->getBedCount())});
+
+	std::string listText;
+	if (house->getAccessList(GUEST_LIST, listText) && !listText.empty()) {
+		snapshot.listRows.push_back(fmt::format("{:d}, {:d}, {:s}", house->getId(), std::to_underlying(GUEST_LIST),
+		                                        db.escapeString(listText)));
+		listText.clear();
+	}
+
+	if (house->getAccessList(SUBOWNER_LIST, listText) && !listText.empty()) {
+		snapshot.listRows.push_back(fmt::format("{:d}, {:d}, {:s}", house->getId(), std::to_underlying(SUBOWNER_LIST),
+		                                        db.escapeString(listText)));
+		listText.clear();
+	}
 
+	for (Door* door : house->getDoors()) {
+		if (door->getAccessList(listText) && !listText.empty()) {
+			snapshot.listRows.push_back(
+			    fmt::format("{:d}, {:d}, {:s}", house->getId(), door->getDoorId(), db.escapeString(listText)));
 			listText.clear();
 		}
+	}
 
-		for (Door* door : house->getDoors()) {
-			if (door->getAccessList(listText) && !listText.empty()) {
-				if (!stmt.addRow(fmt::format("{:d}, {:d}, {:s}", house->getId(), door->getDoorId(),
-				                             db.escapeString(listText)))) {
-					return false;
-				}
+	PropWriteStream stream;
+	for (HouseTile* tile : house->getTiles()) {
+		saveTile(stream, tile);
 
-				listText.clear();
-			}
+		if (auto attributes = stream.getStream(); !attributes.empty()) {
+			snapshot.tileRows.push_back(fmt::format("{:d}, {:s}", house->getId(), db.escapeString(attributes)));
+			stream.clear();
 		}
 	}
+}
 
-	if (!stmt.execute()) {
-		return false;
+HousesSnapshot IOMapSerialize::snapshotHouses()
+{
+	HousesSnapshot snapshot;
+	for (const auto& it : g_game.map.houses.getHouses()) {
+		snapshotHouse(it.second, snapshot);
 	}
-
-	return transaction.commit();
+	return snapshot;
 }
 
 bool IOMapSerialize::saveHouse(House* house)
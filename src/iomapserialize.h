@@ -5,6 +5,7 @@
 #define FS_IOMAPSERIALIZE_H
 
 class Container;
+class Database;
 class House;
 class Item;
 class Map;
@@ -13,13 +14,32 @@ class PropWriteStream;
 class Thing;
 class Tile;
 
+// Everything the world save writes about the houses, taken on the dispatcher thread so that the statements can run
+// on another connection while the game goes on.
+struct HousesSnapshot
+{
+	struct HouseInfo
+	{
+		uint32_t id = 0;
+		std::string updateQuery;
+		std::string insertQuery;
+	};
+
+	std::vector<HouseInfo> houses;
+	std::vector<std::string> listRows;
+	std::vector<std::string> tileRows;
+};
+
 class IOMapSerialize
 {
 public:
-	static void loadHouseItems(Map* map);
-	static bool saveHouseItems();
+	static bool loadHouseItems(Map* map);
+	static bool saveHouseItems(Database& db, const HousesSnapshot& snapshot);
 	static bool loadHouseInfo();
-	static bool saveHouseInfo();
+	static bool saveHouseInfo(Database& db, const HousesSnapshot& snapshot);
+
+	static void snapshotHouse(House* house, HousesSnapshot& snapshot);
+	static HousesSnapshot snapshotHouses();
 
 	static bool saveHouse(House* house);
 
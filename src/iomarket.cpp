@@ -27,9 +27,9 @@ MarketOfferList getActiveOffers(MarketAction_t action, uint16_t itemId)
 {
 	MarketOfferList offerList;
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format(
-	    "SELECT `id`, `amount`, `price`, `created`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `sale` = {:d} AND `itemtype` = {:d}",
-	    std::to_underlying(action), itemId));
+	DBResult_ptr result = Database::getInstance().storeStatement(
+	    "SELECT `id`, `amount`, `price`, `created`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `sale` = ? AND `itemtype` = ?",
+	    std::to_underlying(action), itemId);
 	if (!result) {
 		return offerList;
 	}
@@ -59,9 +59,9 @@ MarketOfferList getOwnOffers(MarketAction_t action, uint32_t playerId)
 
 	const int32_t marketOfferDuration = getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format(
-	    "SELECT `id`, `amount`, `price`, `created`, `itemtype` FROM `market_offers` WHERE `player_id` = {:d} AND `sale` = {:d}",
-	    playerId, std::to_underlying(action)));
+	DBResult_ptr result = Database::getInstance().storeStatement(
+	    "SELECT `id`, `amount`, `price`, `created`, `itemtype` FROM `market_offers` WHERE `player_id` = ? AND `sale` = ?",
+	    playerId, std::to_underlying(action));
 	if (!result) {
 		return offerList;
 	}
@@ -82,9 +82,9 @@ HistoryMarketOfferList getOwnHistory(MarketAction_t action, uint32_t playerId)
 {
 	HistoryMarketOfferList offerList;
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format(
-	    "SELECT `itemtype`, `amount`, `price`, `expires_at`, `state` FROM `market_history` WHERE `player_id` = {:d} AND `sale` = {:d}",
-	    playerId, std::to_underlying(action)));
+	DBResult_ptr result = Database::getInstance().storeStatement(
+	    "SELECT `itemtype`, `amount`, `price`, `expires_at`, `state` FROM `market_history` WHERE `player_id` = ? AND `sale` = ?",
+	    playerId, std::to_underlying(action));
 	if (!result) {
 		return offerList;
 	}
@@ -204,8 +204,8 @@ void checkExpiredOffers()
 
 uint32_t getPlayerOfferCount(uint32_t playerId)
 {
-	DBResult_ptr result = Database::getInstance().storeQuery(
-	    fmt::format("SELECT COUNT(*) AS `count` FROM `market_offers` WHERE `player_id` = {:d}", playerId));
+	DBResult_ptr result = Database::getInstance().storeStatement(
+	    "SELECT COUNT(*) AS `count` FROM `market_offers` WHERE `player_id` = ?", playerId);
 	if (!result) {
 		return 0;
 	}
@@ -218,9 +218,9 @@ MarketOfferEx getOfferByCounter(uint32_t timestamp, uint16_t counter)
 
 	const int32_t created = timestamp - getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format(
-	    "SELECT `id`, `sale`, `itemtype`, `amount`, `created`, `price`, `player_id`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `created` = {:d} AND (`id` & 65535) = {:d} LIMIT 1",
-	    created, counter));
+	DBResult_ptr result = Database::getInstance().storeStatement(
+	    "SELECT `id`, `sale`, `itemtype`, `amount`, `created`, `price`, `player_id`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `created` = ? AND (`id` & 65535) = ? LIMIT 1",
+	    created, counter);
 	if (!result) {
 		offer.id = 0;
 		offer.playerId = 0;
@@ -246,29 +246,33 @@ MarketOfferEx getOfferByCounter(uint32_t timestamp, uint16_t counter)
 void createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint64_t price,
                  bool anonymous)
 {
-	Database::getInstance().executeQuery(fmt::format(
-	    "INSERT INTO `market_offers` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `created`, `anonymous`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})",
-	    playerId, std::to_underlying(action), itemId, amount, price, time(nullptr), anonymous));
+	Database::getInstance().executeStatement(
+	    "INSERT INTO `market_offers` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `created`, `anonymous`) VALUES (?, ?, ?, ?, ?, ?, ?)",
+	    playerId, std::to_underlying(action), itemId, amount, price, time(nullptr), anonymous);
 }
 
 void acceptOffer(uint32_t offerId, uint16_t amount)
 {
-	Database::getInstance().executeQuery(
-	    fmt::format("UPDATE `market_offers` SET `amount` = `amount` - {:d} WHERE `id` = {:d}", amount, offerId));
+	Database::getInstance().executeStatement("UPDATE `market_offers` SET `amount` = `amount` - ? WHERE `id` = ?", amount,
+	                                         offerId);
 }
 
 void deleteOffer(uint32_t offerId)
 {
-	Database::getInstance().executeQuery(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId));
+	Database::getInstance().executeStatement("DELETE FROM `market_offers` WHERE `id` = ?", offerId);
 }
 
 void appendHistory(uint32_t playerId, MarketAction_t action, uint16_t itemId, uint16_t amount, uint64_t price,
                    time_t timestamp, MarketOfferState_t state)
 {
-	g_databaseTasks.addTask(fmt::format(
-	    "INSERT INTO `market_history` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `inserted`, `state`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})",
-	    playerId, std::to_underlying(action), itemId, amount, price, timestamp, time(nullptr),
-	    std::to_underlying(state)));
+	g_databaseTasks.addJob(
+	    [=, inserted = time(nullptr)](Database& db) {
+		    db.executeStatement(
+		        "INSERT INTO `market_history` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `inserted`, `state`) VALUES (?, ?, ?, ?, ?, ?, ?, ?)",
+		        playerId, std::to_underlying(action), itemId, amount, price, timestamp, inserted,
+		        std::to_underlying(state));
+	    },
+	    DatabaseTasks::playerKey(playerId));
 }
 
 bool moveOfferToHistory(uint32_t offerId, MarketOfferState_t state)
@@ -277,14 +281,14 @@ bool moveOfferToHistory(uint32_t offerId, MarketOfferState_t state)
 
 	Database& db = Database::getInstance();
 
-	DBResult_ptr result = db.storeQuery(fmt::format(
-	    "SELECT `player_id`, `sale`, `itemtype`, `amount`, `price`, `created` FROM `market_offers` WHERE `id` = {:d}",
-	    offerId));
+	DBResult_ptr result = db.storeStatement(
+	    "SELECT `player_id`, `sale`, `itemtype`, `amount`, `price`, `created` FROM `market_offers` WHERE `id` = ?",
+	    offerId);
 	if (!result) {
 		return false;
 	}
 
-	if (!db.executeQuery(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId))) {
+	if (!db.executeStatement("DELETE FROM `market_offers` WHERE `id` = ?", offerId)) {
 		return false;
 	}
 
@@ -297,26 +301,23 @@ bool moveOfferToHistory(uint32_t offerId, MarketOfferState_t state)
 
 void updateStatistics()
 {
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format(
-	    "SELECT `sale` AS `sale`, `itemtype` AS `itemtype`, COUNT(`price`) AS `num`, MIN(`price`) AS `min`, MAX(`price`) AS `max`, SUM(`price`) AS `sum` FROM `market_history` WHERE `state` = {:d} GROUP BY `itemtype`, `sale`",
-	    std::to_underlying(OFFERSTATE_ACCEPTED)));
-	if (!result) {
-		return;
-	}
-
-	do {
-		MarketStatistics* statistics;
-		if (result->getNumber<uint16_t>("sale") == MARKETACTION_BUY) {
-			statistics = &purchaseStatistics[result->getNumber<uint16_t>("itemtype")];
-		} else {
-			statistics = &saleStatistics[result->getNumber<uint16_t>("itemtype")];
-		}
-
-		statistics->numTransactions = result->getNumber<uint32_t>("num");
-		statistics->lowestPrice = result->getNumber<uint64_t>("min");
-		statistics->totalPrice = result->getNumber<uint64_t>("sum");
-		statistics->highestPrice = result->getNumber<uint64_t>("max");
-	} while (result->next());
+	Database::getInstance().streamQuery(
+	    fmt::format(
+	        "SELECT `sale` AS `sale`, `itemtype` AS `itemtype`, COUNT(`price`) AS `num`, MIN(`price`) AS `min`, MAX(`price`) AS `max`, SUM(`price`) AS `sum` FROM `market_history` WHERE `state` = {:d} GROUP BY `itemtype`, `sale`",
+	        std::to_underlying(OFFERSTATE_ACCEPTED)),
+	    [](const DBResult& result) {
+		    MarketStatistics* statistics;
+		    if (result.getNumber<uint16_t>("sale") == MARKETACTION_BUY) {
+			    statistics = &purchaseStatistics[result.getNumber<uint16_t>("itemtype")];
+		    } else {
+			    statistics = &saleStatistics[result.getNumber<uint16_t>("itemtype")];
+		    }
+
+		    statistics->numTransactions = result.getNumber<uint32_t>("num");
+		    statistics->lowestPrice = result.getNumber<uint64_t>("min");
+		    statistics->totalPrice = result.getNumber<uint64_t>("sum");
+		    statistics->highestPrice = result.getNumber<uint64_t>("max");
+	    });
 }
 
 MarketStatistics* getPurchaseStatistics(uint16_t itemId)
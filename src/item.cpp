@@ -250,6 +250,9 @@ void Item::setID(uint16_t newid)
 	if (newDuration > 0 && (!prevIt.stopTime || !hasAttribute(ITEM_ATTRIBUTE_DURATION))) {
 		setDecaying(DECAYING_FALSE);
 		setDuration(newDuration);
+	} else if (getDecayDeadline() != 0 && !canDecay()) {
+		// pause right away, the remaining duration is kept until the item is transformed back
+		setDecaying(DECAYING_FALSE);
 	}
 }
 
@@ -805,7 +808,7 @@ void Item::serializeAttr(PropWriteStream& propWriteStream) const
 
 	if (hasAttribute(ITEM_ATTRIBUTE_DURATION)) {
 		propWriteStream.write<uint8_t>(ATTR_DURATION);
-		propWriteStream.write<uint32_t>(getIntAttr(ITEM_ATTRIBUTE_DURATION));
+		propWriteStream.write<uint32_t>(getDuration());
 	}
 
 	ItemDecayState_t decayState = getDecaying();
@@ -1061,6 +1064,47 @@ void Item::setUniqueId(uint16_t n)
 	}
 }
 
+void Item::setDuration(int32_t time)
+{
+	setIntAttr(ITEM_ATTRIBUTE_DURATION, time);
+
+	// a running decay continues with the new duration under a new entry, an item that still waits in toDecayItems
+	// only needs the new deadline as its entry is added with it
+	if (attributes->decayDeadline != 0) {
+		attributes->decayDeadline = OTSYS_TIME() + time;
+		if (g_game.removeDecayEntry(this)) {
+			incrementReferenceCounter();
+			g_game.toDecayItems.push_front(this);
+		}
+	}
+}
+
+uint32_t Item::getDuration() const
+{
+	if (!attributes) {
+		return 0;
+	}
+
+	if (attributes->decayDeadline != 0) {
+		return static_cast<uint32_t>(std::max<int64_t>(0, attributes->decayDeadline - OTSYS_TIME()));
+	}
+	return getIntAttr(ITEM_ATTRIBUTE_DURATION);
+}
+
+void Item::setDecaying(ItemDecayState_t decayState)
+{
+	auto& attrs = getAttributes();
+	if (decayState == DECAYING_TRUE) {
+		if (attrs->decayDeadline == 0) {
+			attrs->decayDeadline = OTSYS_TIME() + getIntAttr(ITEM_ATTRIBUTE_DURATION);
+		}
+	} else if (attrs->decayDeadline != 0) {
+		setIntAttr(ITEM_ATTRIBUTE_DURATION, getDuration());
+		attrs->decayDeadline = 0;
+	}
+	setIntAttr(ITEM_ATTRIBUTE_DECAYSTATE, decayState);
+}
+
 void Item::setDefaultDuration()
 {
 	uint32_t duration = getDefaultDurationMin();
@@ -1184,6 +1228,10 @@ void ItemAttributes::removeAttribute(itemAttrTypes type)
 		}
 	}
 	attributeBits &= ~type;
+
+	if (type == ITEM_ATTRIBUTE_DURATION || type == ITEM_ATTRIBUTE_DECAYSTATE) {
+		decayDeadline = 0;
+	}
 }
 
 int64_t ItemAttributes::getIntAttr(itemAttrTypes type) const
@@ -1269,8 +1317,7 @@ bool Item::hasMarketAttributes() const
 				return false;
 			}
 		} else if (attr.type == ITEM_ATTRIBUTE_DURATION) {
-			uint32_t duration = static_cast<uint32_t>(attr.value.integer);
-			if (duration <= getDefaultDurationMin()) {
+			if (getDuration() <= getDefaultDurationMin()) {
 				return false;
 			}
 		} else {
@@ -4,6 +4,7 @@
 #ifndef FS_ITEM_H
 #define FS_ITEM_H
 
+#include "deadlinewheel.h"
 #include "items.h"
 #include "luascript.h"
 #include "thing.h"
@@ -353,6 +354,12 @@ private:
 	std::vector<Attribute> attributes;
 	uint32_t attributeBits = 0;
 
+	// OTSYS_TIME at which the running decay ends, 0 while the item is not decaying. The duration attribute holds the
+	// remaining time only while the decay is paused.
+	int64_t decayDeadline = 0;
+	// entry of the running decay in Game::decayWheel
+	DeadlineWheelEntry decayEntry;
+
 	std::map<CombatType_t, Reflect> reflect;
 	std::map<CombatType_t, uint16_t> boostPercent;
 
@@ -679,24 +686,33 @@ public:
 		return getIntAttr(ITEM_ATTRIBUTE_CORPSEOWNER);
 	}
 
-	void setDuration(int32_t time) { setIntAttr(ITEM_ATTRIBUTE_DURATION, time); }
-	void decreaseDuration(int32_t time) { increaseIntAttr(ITEM_ATTRIBUTE_DURATION, -time); }
-	uint32_t getDuration() const
+	void setDuration(int32_t time);
+	uint32_t getDuration() const;
+
+	// Starting the decay fixes its deadline, any other state pauses it and keeps the remaining duration.
+	void setDecaying(ItemDecayState_t decayState);
+	ItemDecayState_t getDecaying() const
+	{
+		if (!attributes) {
+			return DECAYING_FALSE;
+		}
+		return static_cast<ItemDecayState_t>(getIntAttr(ITEM_ATTRIBUTE_DECAYSTATE));
+	}
+	int64_t getDecayDeadline() const
 	{
 		if (!attributes) {
 			return 0;
 		}
-		return getIntAttr(ITEM_ATTRIBUTE_DURATION);
+		return attributes->decayDeadline;
 	}
-
-	void setDecaying(ItemDecayState_t decayState) { setIntAttr(ITEM_ATTRIBUTE_DECAYSTATE, decayState); }
-	ItemDecayState_t getDecaying() const
+	DeadlineWheelEntry getDecayEntry() const
 	{
 		if (!attributes) {
-			return DECAYING_FALSE;
+			return {};
 		}
-		return static_cast<ItemDecayState_t>(getIntAttr(ITEM_ATTRIBUTE_DECAYSTATE));
+		return attributes->decayEntry;
 	}
+	void setDecayEntry(const DeadlineWheelEntry& entry) { getAttributes()->decayEntry = entry; }
 
 	int32_t getDecayTimeMin() const
 	{
@@ -0,0 +1,86 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "itemblob.h"
+
+#include <zlib.h>
+
+namespace {
+
+enum BlobFormat : uint8_t
+{
+	BLOB_FORMAT_RAW = 0,
+	BLOB_FORMAT_ZLIB = 1,
+};
+
+// format byte and the size of the inflated data
+constexpr size_t ZLIB_HEADER_SIZE = 1 + sizeof(uint32_t);
+
+// a broken size must not make the server allocate gigabytes
+constexpr uint32_t MAX_INFLATED_SIZE = 64 * 1024 * 1024;
+
+} // namespace
+
+std::string tfs::itemblob::pack(std::string_view data)
+{
+	std::string blob;
+	if (data.size() >= COMPRESS_THRESHOLD && data.size() <= std::numeric_limits<uint32_t>::max()) {
+		uLongf compressedSize = compressBound(data.size());
+		blob.resize(ZLIB_HEADER_SIZE + compressedSize);
+
+		if (compress2(reinterpret_cast<Bytef*>(blob.data() + ZLIB_HEADER_SIZE), &compressedSize,
+		              reinterpret_cast<const Bytef*>(data.data()), data.size(), Z_DEFAULT_COMPRESSION) == Z_OK &&
+		    compressedSize < data.size()) {
+			const uint32_t size = data.size();
+			blob[0] = BLOB_FORMAT_ZLIB;
+			std::memcpy(blob.data() + 1, &size, sizeof(size));
+			blob.resize(ZLIB_HEADER_SIZE + compressedSize);
+			return blob;
+		}
+		blob.clear();
+	}
+
+	blob.reserve(data.size() + 1);
+	blob.push_back(BLOB_FORMAT_RAW);
+	blob.append(data);
+	return blob;
+}
+
+std::optional<std::string_view> tfs::itemblob::unpack(std::string_view blob, std::string& buffer)
+{
+	if (blob.empty()) {
+		return std::nullopt;
+	}
+
+	switch (static_cast<uint8_t>(blob[0])) {
+		case BLOB_FORMAT_RAW:
+			return blob.substr(1);
+
+		case BLOB_FORMAT_ZLIB: {
+			if (blob.size() < ZLIB_HEADER_SIZE) {
+				return std::nullopt;
+			}
+
+			uint32_t size;
+			std::memcpy(&size, blob.data() + 1, sizeof(size));
+			if (size > MAX_INFLATED_SIZE) {
+				return std::nullopt;
+			}
+			buffer.resize(size);
+
+			uLongf inflatedSize = size;
+			if (uncompress(reinterpret_cast<Bytef*>(buffer.data()), &inflatedSize,
+			               reinterpret_cast<const Bytef*>(blob.data() + ZLIB_HEADER_SIZE),
+			               blob.size() - ZLIB_HEADER_SIZE) != Z_OK ||
+			    inflatedSize != size) {
+				return std::nullopt;
+			}
+			return std::string_view{buffer};
+		}
+
+		default:
+			return std::nullopt;
+	}
+}
@@ -0,0 +1,22 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_ITEMBLOB_H
+#define FS_ITEMBLOB_H
+
+// Framing of the serialized item trees that are stored in the player_item_blobs table. Small blobs are stored as
+// they are, larger ones are compressed with zlib.
+namespace tfs::itemblob {
+
+// blobs smaller than this are not worth compressing
+inline constexpr size_t COMPRESS_THRESHOLD = 256;
+
+std::string pack(std::string_view data);
+
+// Returns the serialized item trees of a blob, or nothing if the blob is broken. An uncompressed blob is returned as
+// a view into the blob itself, a compressed one is inflated into the buffer, which has to outlive the view.
+std::optional<std::string_view> unpack(std::string_view blob, std::string& buffer);
+
+} // namespace tfs::itemblob
+
+#endif // FS_ITEMBLOB_H
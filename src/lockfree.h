@@ -67,4 +67,74 @@ public:
 	}
 };
 
+struct LockfreeQueueNode
+{
+	std::atomic<LockfreeQueueNode*> next{nullptr};
+};
+
+/*
+ * Intrusive multi-producer single-consumer queue (Dmitry Vyukov's algorithm).
+ * push() is wait-free and may be called from any thread, pop() must only be
+ * called from the consumer thread. Elements must derive from LockfreeQueueNode
+ * and are never copied nor owned by the queue.
+ */
+template <typename T>
+class LockfreeMPSCQueue
+{
+public:
+	LockfreeMPSCQueue() = default;
+
+	// non-copyable
+	LockfreeMPSCQueue(const LockfreeMPSCQueue&) = delete;
+	LockfreeMPSCQueue& operator=(const LockfreeMPSCQueue&) = delete;
+
+	void push(T* element) { push(static_cast<LockfreeQueueNode*>(element)); }
+
+	T* pop()
+	{
+		LockfreeQueueNode* first = tail;
+		LockfreeQueueNode* next = first->next.load(std::memory_order_acquire);
+		if (first == &stub) {
+			if (!next) {
+				return nullptr;
+			}
+
+			tail = next;
+			first = next;
+			next = next->next.load(std::memory_order_acquire);
+		}
+
+		if (next) {
+			tail = next;
+			return static_cast<T*>(first);
+		}
+
+		if (first != head.load(std::memory_order_acquire)) {
+			// a producer is in the middle of a push, the element will be visible shortly
+			return nullptr;
+		}
+
+		push(&stub);
+
+		next = first->next.load(std::memory_order_acquire);
+		if (next) {
+			tail = next;
+			return static_cast<T*>(first);
+		}
+		return nullptr;
+	}
+
+private:
+	void push(LockfreeQueueNode* node)
+	{
+		node->next.store(nullptr, std::memory_order_relaxed);
+		LockfreeQueueNode* prev = head.exchange(node, std::memory_order_acq_rel);
+		prev->next.store(node, std::memory_order_release);
+	}
+
+	LockfreeQueueNode stub;
+	std::atomic<LockfreeQueueNode*> head{&stub};
+	LockfreeQueueNode* tail = &stub;
+};
+
 #endif // FS_LOCKFREE_H
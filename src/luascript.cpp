@@ -8,6 +8,7 @@
 #include "bed.h"
 #include "chat.h"
 #include "configmanager.h"
+#include "connection.h"
 #include "databasemanager.h"
 #include "databasetasks.h"
 #include "depotchest.h"
@@ -2324,8 +2325,21 @@ void LuaScriptInterface::registerFunctions()
 	registerEnumIn(L, "configKeys", ConfigManager::MANASHIELD_BREAKABLE);
 	registerEnumIn(L, "configKeys", ConfigManager::STAMINA_REGEN_MINUTE);
 	registerEnumIn(L, "configKeys", ConfigManager::STAMINA_REGEN_PREMIUM);
+	registerEnumIn(L, "configKeys", ConfigManager::PATHFINDING_THREADS);
 	registerEnumIn(L, "configKeys", ConfigManager::HOUSE_DOOR_SHOW_PRICE);
 	registerEnumIn(L, "configKeys", ConfigManager::MONSTER_OVERSPAWN);
+	registerEnumIn(L, "configKeys", ConfigManager::MAP_TILE_GRID);
+	registerEnumIn(L, "configKeys", ConfigManager::WORLD_SAVE_ASYNC);
+	registerEnumIn(L, "configKeys", ConfigManager::INCREMENTAL_PLAYER_SAVE);
+	registerEnumIn(L, "configKeys", ConfigManager::PLAYER_ITEM_BLOBS);
+	registerEnumIn(L, "configKeys", ConfigManager::WORLD_SAVE_SLICE_TIME);
+	registerEnumIn(L, "configKeys", ConfigManager::NETWORK_THREADS);
+	registerEnumIn(L, "configKeys", ConfigManager::PACKET_COMPRESSION);
+	registerEnumIn(L, "configKeys", ConfigManager::PACKET_COMPRESSION_THRESHOLD);
+	registerEnumIn(L, "configKeys", ConfigManager::PACKET_COMPRESSION_LEVEL);
+	registerEnumIn(L, "configKeys", ConfigManager::MAX_OUTBOUND_QUEUE_BYTES);
+	registerEnumIn(L, "configKeys", ConfigManager::AUTH_THREADS);
+	registerEnumIn(L, "configKeys", ConfigManager::DATABASE_THREADS);
 
 	registerEnumIn(L, "configKeys", ConfigManager::QUEST_TRACKER_FREE_LIMIT);
 	registerEnumIn(L, "configKeys", ConfigManager::QUEST_TRACKER_PREMIUM_LIMIT);
@@ -2367,6 +2381,11 @@ void LuaScriptInterface::registerFunctions()
 	registerMethod(L, "Game", "getMonsterCount", LuaScriptInterface::luaGameGetMonsterCount);
 	registerMethod(L, "Game", "getPlayerCount", LuaScriptInterface::luaGameGetPlayerCount);
 	registerMethod(L, "Game", "getNpcCount", LuaScriptInterface::luaGameGetNpcCount);
+	registerMethod(L, "Game", "getCreatureCheckStats", LuaScriptInterface::luaGameGetCreatureCheckStats);
+	registerMethod(L, "Game", "getWorldSaveStats", LuaScriptInterface::luaGameGetWorldSaveStats);
+	registerMethod(L, "Game", "getNetworkStats", LuaScriptInterface::luaGameGetNetworkStats);
+	registerMethod(L, "Game", "getCompressionStats", LuaScriptInterface::luaGameGetCompressionStats);
+	registerMethod(L, "Game", "getDatabaseTaskStats", LuaScriptInterface::luaGameGetDatabaseTaskStats);
 	registerMethod(L, "Game", "getMonsterTypes", LuaScriptInterface::luaGameGetMonsterTypes);
 	registerMethod(L, "Game", "getBestiary", LuaScriptInterface::luaGameGetBestiary);
 	registerMethod(L, "Game", "getCurrencyItems", LuaScriptInterface::luaGameGetCurrencyItems);
@@ -4008,7 +4027,11 @@ int LuaScriptInterface::luaStopEvent(lua_State* L)
 int LuaScriptInterface::luaSaveServer(lua_State* L)
 {
 	g_globalEvents->save();
-	g_game.saveGameState();
+	if (getBoolean(ConfigManager::WORLD_SAVE_ASYNC)) {
+		g_game.startWorldSave();
+	} else {
+		g_game.saveGameState();
+	}
 	tfs::lua::pushBoolean(L, true);
 	return 1;
 }
@@ -4192,7 +4215,14 @@ int LuaScriptInterface::luaDatabaseExecute(lua_State* L)
 
 int LuaScriptInterface::luaDatabaseAsyncExecute(lua_State* L)
 {
-	// db.asyncQuery(query, callback)
+	// db.asyncQuery(query[, callback[, playerGuid]])
+	// with a player guid the query keeps its order with the saves of that player instead of the other queries
+	uint64_t key = DatabaseTasks::DEFAULT_KEY;
+	if (lua_gettop(L) > 2) {
+		key = DatabaseTasks::playerKey(tfs::lua::getNumber<uint32_t>(L, 3));
+		lua_settop(L, lua_isnil(L, 2) ? 1 : 2);
+	}
+
 	std::function<void(const DBResult_ptr&, bool)> callback;
 	if (lua_gettop(L) > 1) {
 		int32_t ref = luaL_ref(L, LUA_REGISTRYINDEX);
@@ -4217,7 +4247,7 @@ int LuaScriptInterface::luaDatabaseAsyncExecute(lua_State* L)
 			luaL_unref(L, LUA_REGISTRYINDEX, ref);
 		};
 	}
-	g_databaseTasks.addTask(tfs::lua::getString(L, -1), callback);
+	g_databaseTasks.addTask(tfs::lua::getString(L, -1), callback, false, key);
 	return 0;
 }
 
@@ -4234,7 +4264,14 @@ int LuaScriptInterface::luaDatabaseStoreQuery(lua_State* L)
 
 int LuaScriptInterface::luaDatabaseAsyncStoreQuery(lua_State* L)
 {
-	// db.asyncStoreQuery(query, callback)
+	// db.asyncStoreQuery(query[, callback[, playerGuid]])
+	// with a player guid the query keeps its order with the saves of that player instead of the other queries
+	uint64_t key = DatabaseTasks::DEFAULT_KEY;
+	if (lua_gettop(L) > 2) {
+		key = DatabaseTasks::playerKey(tfs::lua::getNumber<uint32_t>(L, 3));
+		lua_settop(L, lua_isnil(L, 2) ? 1 : 2);
+	}
+
 	std::function<void(const DBResult_ptr&, bool)> callback;
 	if (lua_gettop(L) > 1) {
 		int32_t ref = luaL_ref(L, LUA_REGISTRYINDEX);
@@ -4263,7 +4300,7 @@ int LuaScriptInterface::luaDatabaseAsyncStoreQuery(lua_State* L)
 			luaL_unref(L, LUA_REGISTRYINDEX, ref);
 		};
 	}
-	g_databaseTasks.addTask(tfs::lua::getString(L, -1), callback, true);
+	g_databaseTasks.addTask(tfs::lua::getString(L, -1), callback, true, key);
 	return 0;
 }
 
@@ -4649,6 +4686,114 @@ int LuaScriptInterface::luaGameGetNpcCount(lua_State* L)
 	return 1;
 }
 
+int LuaScriptInterface::luaGameGetCreatureCheckStats(lua_State* L)
+{
+	// Game.getCreatureCheckStats()
+	lua_createtable(L, EVENT_CREATURECOUNT, 0);
+	for (size_t i = 0; i < EVENT_CREATURECOUNT; ++i) {
+		lua_createtable(L, 0, 2);
+		setField(L, "creatures", g_game.getCreatureCheckBucketSize(i));
+		setField(L, "time", g_game.getCreatureCheckBucketTime(i).count());
+		lua_rawseti(L, -2, i + 1);
+	}
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetWorldSaveStats(lua_State* L)
+{
+	// Game.getWorldSaveStats()
+	const WorldSaveStats& stats = g_game.getWorldSaveStats();
+	lua_createtable(L, 0, 7);
+	setField(L, "snapshotTime", stats.snapshotTime);
+	setField(L, "longestSlice", stats.longestSlice);
+	setField(L, "writeTime", stats.writeTime);
+	setField(L, "slices", stats.slices);
+	setField(L, "players", stats.players);
+	tfs::lua::pushBoolean(L, stats.success);
+	lua_setfield(L, -2, "success");
+	tfs::lua::pushBoolean(L, g_game.isWorldSaveRunning());
+	lua_setfield(L, -2, "running");
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetNetworkStats(lua_State* L)
+{
+	// Game.getNetworkStats()
+	auto& connectionManager = ConnectionManager::getInstance();
+	const auto stats = connectionManager.getWriteStats();
+	const auto queueStats = connectionManager.getQueueStats();
+	lua_createtable(L, 0, 10);
+	setField(L, "writes", stats.writes);
+	setField(L, "messages", stats.messages);
+	setField(L, "bytes", stats.bytes);
+	// every message used to be written on its own
+	setField(L, "savedWrites", stats.messages - stats.writes);
+	setField(L, "bytesPerWrite", stats.writes != 0 ? static_cast<double>(stats.bytes) / stats.writes : 0.);
+	// microseconds from the first packet written into a message until the message is written to the socket
+	setField(L, "latencyPerMessage",
+	         stats.messages != 0 ? static_cast<double>(stats.latency.count()) / stats.messages : 0.);
+	setField(L, "queuedBytes", queueStats.queuedBytes);
+	setField(L, "maxQueuedBytes", queueStats.maxQueuedBytes);
+	setField(L, "shedMessages", queueStats.shedMessages);
+	setField(L, "overflowDisconnects", queueStats.overflowDisconnects);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetCompressionStats(lua_State* L)
+{
+	// Game.getCompressionStats()
+	lua_newtable(L);
+	const auto stats = Protocol::getCompressionStats();
+	for (size_t opcode = 0; opcode < stats.size(); ++opcode) {
+		const auto& opcodeStats = stats[opcode];
+		if (opcodeStats.packets == 0) {
+			continue;
+		}
+
+		lua_createtable(L, 0, 6);
+		setField(L, "packets", opcodeStats.packets);
+		setField(L, "compressed", opcodeStats.compressed);
+		setField(L, "bytesIn", opcodeStats.bytesIn);
+		setField(L, "bytesOut", opcodeStats.bytesOut);
+		setField(L, "ratio", static_cast<double>(opcodeStats.bytesOut) / opcodeStats.bytesIn);
+		// microseconds per packet
+		setField(L, "time", opcodeStats.nanoseconds / 1000. / opcodeStats.packets);
+		lua_rawseti(L, -2, opcode);
+	}
+	return 1;
+}
+
+static void pushHistogram(lua_State* L, const DatabaseTasks::Histogram& histogram)
+{
+	// counts by the upper bound of their bucket, the values are below it
+	lua_newtable(L);
+	for (size_t i = 0; i < histogram.size(); ++i) {
+		if (histogram[i] != 0) {
+			lua_pushnumber(L, static_cast<lua_Number>(uint64_t{1} << i));
+			lua_pushnumber(L, histogram[i]);
+			lua_rawset(L, -3);
+		}
+	}
+}
+
+int LuaScriptInterface::luaGameGetDatabaseTaskStats(lua_State* L)
+{
+	// Game.getDatabaseTaskStats()
+	const auto stats = g_databaseTasks.getStats();
+	lua_createtable(L, 0, 6);
+	setField(L, "threads", stats.threads);
+	setField(L, "queued", stats.queued);
+	setField(L, "tasks", stats.tasks);
+	pushHistogram(L, stats.queueDepth);
+	lua_setfield(L, -2, "queueDepth");
+	// microseconds
+	pushHistogram(L, stats.waitTime);
+	lua_setfield(L, -2, "waitTime");
+	pushHistogram(L, stats.runTime);
+	lua_setfield(L, -2, "runTime");
+	return 1;
+}
+
 int LuaScriptInterface::luaGameGetMonsterTypes(lua_State* L)
 {
 	// Game.getMonsterTypes()
@@ -6976,7 +7121,9 @@ int LuaScriptInterface::luaItemGetAttribute(lua_State* L)
 		attribute = ITEM_ATTRIBUTE_NONE;
 	}
 
-	if (ItemAttributes::isIntAttrType(attribute)) {
+	if (attribute == ITEM_ATTRIBUTE_DURATION) {
+		lua_pushnumber(L, item->getDuration());
+	} else if (ItemAttributes::isIntAttrType(attribute)) {
 		lua_pushnumber(L, item->getIntAttr(attribute));
 	} else if (ItemAttributes::isStrAttrType(attribute)) {
 		tfs::lua::pushString(L, item->getStrAttr(attribute));
@@ -7011,7 +7158,14 @@ int LuaScriptInterface::luaItemSetAttribute(lua_State* L)
 			return 1;
 		}
 
-		item->setIntAttr(attribute, tfs::lua::getNumber<int32_t>(L, 3));
+		// the decay attributes go through the item, it keeps the deadline of a running decay in sync
+		if (attribute == ITEM_ATTRIBUTE_DURATION) {
+			item->setDuration(tfs::lua::getNumber<int32_t>(L, 3));
+		} else if (attribute == ITEM_ATTRIBUTE_DECAYSTATE) {
+			item->setDecaying(tfs::lua::getNumber<ItemDecayState_t>(L, 3));
+		} else {
+			item->setIntAttr(attribute, tfs::lua::getNumber<int32_t>(L, 3));
+		}
 		tfs::lua::pushBoolean(L, true);
 	} else if (ItemAttributes::isStrAttrType(attribute)) {
 		item->setStrAttr(attribute, tfs::lua::getString(L, 3));
@@ -274,6 +274,11 @@ private:
 	static int luaGameGetMonsterCount(lua_State* L);
 	static int luaGameGetPlayerCount(lua_State* L);
 	static int luaGameGetNpcCount(lua_State* L);
+	static int luaGameGetCreatureCheckStats(lua_State* L);
+	static int luaGameGetWorldSaveStats(lua_State* L);
+	static int luaGameGetNetworkStats(lua_State* L);
+	static int luaGameGetCompressionStats(lua_State* L);
+	static int luaGameGetDatabaseTaskStats(lua_State* L);
 	static int luaGameGetMonsterTypes(lua_State* L);
 	static int luaGameGetBestiary(lua_State* L);
 	static int luaGameGetCurrencyItems(lua_State* L);
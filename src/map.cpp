@@ -33,16 +33,21 @@ bool Map::loadMap(const std::string& identifier, bool loadHouses, bool isCalledB
 		}
 
 		IOMapSerialize::loadHouseInfo();
-		IOMapSerialize::loadHouseItems(this);
+		if (!IOMapSerialize::loadHouseItems(this)) {
+			std::cout << "[Fatal - Map::loadMap] Failed to load house items." << std::endl;
+			return false;
+		}
 	}
 	return true;
 }
 
-bool Map::save()
+bool Map::save() { return save(Database::getInstance(), IOMapSerialize::snapshotHouses()); }
+
+bool Map::save(Database& db, const HousesSnapshot& snapshot)
 {
 	bool saved = false;
 	for (uint32_t tries = 0; tries < 3; tries++) {
-		if (IOMapSerialize::saveHouseInfo()) {
+		if (IOMapSerialize::saveHouseInfo(db, snapshot)) {
 			saved = true;
 			break;
 		}
@@ -54,7 +59,7 @@ bool Map::save()
 
 	saved = false;
 	for (uint32_t tries = 0; tries < 3; tries++) {
-		if (IOMapSerialize::saveHouseItems()) {
+		if (IOMapSerialize::saveHouseItems(db, snapshot)) {
 			saved = true;
 			break;
 		}
@@ -68,6 +73,10 @@ Tile* Map::getTile(uint16_t x, uint16_t y, uint8_t z) const
 		return nullptr;
 	}
 
+	if (grid.contains(x, y)) {
+		return grid.getTile(x, y, z);
+	}
+
 	const QTreeLeafNode* leaf = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, x, y);
 	if (!leaf) {
 		return nullptr;
@@ -91,6 +100,10 @@ void Map::setTile(uint16_t x, uint16_t y, uint8_t z, Tile* newTile)
 	QTreeLeafNode* leaf = root.createLeaf(x, y, 15);
 
 	if (QTreeLeafNode::newLeaf) {
+		if (grid.contains(x, y)) {
+			grid.setLeaf(x, y, leaf);
+		}
+
 		// update north
 		QTreeLeafNode* northLeaf = root.getLeaf(x, y - FLOOR_SIZE);
 		if (northLeaf) {
@@ -138,7 +151,83 @@ void Map::setTile(uint16_t x, uint16_t y, uint8_t z, Tile* newTile)
 		delete newTile;
 	} else {
 		tile = newTile;
+
+		if (grid.contains(x, y)) {
+			grid.setTile(x, y, z, tile);
+		}
+	}
+}
+
+template <typename Callback>
+void Map::forEachLeaf(QTreeNode* node, uint32_t x, uint32_t y, uint32_t size, Callback&& callback)
+{
+	uint32_t half = size / 2;
+	for (uint32_t i = 0; i < 4; ++i) {
+		QTreeNode* child = node->child[i];
+		if (!child) {
+			continue;
+		}
+
+		uint32_t childX = x + (i & 1) * half;
+		uint32_t childY = y + (i >> 1) * half;
+		if (child->isLeaf()) {
+			callback(static_cast<QTreeLeafNode*>(child), childX, childY);
+		} else {
+			forEachLeaf(child, childX, childY, half, callback);
+		}
+	}
+}
+
+void Map::buildTileGrid()
+{
+	if (grid.isInitialized()) {
+		return;
 	}
+
+	uint32_t minX = std::numeric_limits<uint16_t>::max(), minY = std::numeric_limits<uint16_t>::max();
+	uint32_t maxX = 0, maxY = 0;
+	forEachLeaf(&root, 0, 0, 0x10000, [&](QTreeLeafNode*, uint32_t x, uint32_t y) {
+		minX = std::min(minX, x);
+		minY = std::min(minY, y);
+		maxX = std::max(maxX, x + FLOOR_SIZE);
+		maxY = std::max(maxY, y + FLOOR_SIZE);
+	});
+
+	if (maxX <= minX || maxY <= minY) {
+		return;
+	}
+
+	// align the start to whole sectors so sectors and leaves share the same origin
+	minX &= ~static_cast<uint32_t>(SECTOR_MASK);
+	minY &= ~static_cast<uint32_t>(SECTOR_MASK);
+
+	uint32_t gridWidth = maxX - minX, gridHeight = maxY - minY;
+	if (gridWidth > MAP_GRID_MAX_SIZE || gridHeight > MAP_GRID_MAX_SIZE) {
+		std::cout << "[Warning - Map::buildTileGrid] The loaded area of " << gridWidth << "x" << gridHeight
+		          << " exceeds the tile grid limit of " << MAP_GRID_MAX_SIZE << "x" << MAP_GRID_MAX_SIZE
+		          << ", tiles are looked up through the quadtree." << std::endl;
+		return;
+	}
+
+	grid.init(minX, minY, gridWidth, gridHeight);
+
+	forEachLeaf(&root, 0, 0, 0x10000, [this](QTreeLeafNode* leaf, uint32_t x, uint32_t y) {
+		grid.setLeaf(x, y, leaf);
+		for (uint8_t z = 0; z < MAP_MAX_LAYERS; ++z) {
+			const Floor* floor = leaf->getFloor(z);
+			if (!floor) {
+				continue;
+			}
+
+			for (uint32_t offsetX = 0; offsetX < FLOOR_SIZE; ++offsetX) {
+				for (uint32_t offsetY = 0; offsetY < FLOOR_SIZE; ++offsetY) {
+					if (Tile* tile = floor->tiles[offsetX][offsetY]) {
+						grid.setTile(x + offsetX, y + offsetY, z, tile);
+					}
+				}
+			}
+		}
+	});
 }
 
 void Map::removeTile(uint16_t x, uint16_t y, uint8_t z)
@@ -281,6 +370,9 @@ void Map::moveCreature(Creature& creature, Tile& newTile, bool forceTeleport /*
 	// remove the creature
 	oldTile.removeThing(&creature, 0);
 
+	// add the creature
+	newTile.addThing(&creature);
+
 	QTreeLeafNode* leaf = getQTNode(oldPos.x, oldPos.y);
 	QTreeLeafNode* new_leaf = getQTNode(newPos.x, newPos.y);
 
@@ -288,11 +380,10 @@ void Map::moveCreature(Creature& creature, Tile& newTile, bool forceTeleport /*
 	if (leaf != new_leaf) {
 		leaf->removeCreature(&creature);
 		new_leaf->addCreature(&creature);
+	} else {
+		leaf->moveCreature(&creature);
 	}
 
-	// add the creature
-	newTile.addThing(&creature);
-
 	if (!teleport) {
 		if (oldPos.y > newPos.y) {
 			creature.setDirection(DIRECTION_NORTH);
@@ -360,21 +451,8 @@ void Map::getSpectatorsInternal(SpectatorVec& spectators, const Position& center
 		leafE = leafS;
 		for (int_fast32_t nx = startx1; nx <= endx2; nx += FLOOR_SIZE) {
 			if (leafE) {
-				const CreatureVector& node_list = (onlyPlayers ? leafE->player_list : leafE->creature_list);
-				for (Creature* creature : node_list) {
-					const Position& cpos = creature->getPosition();
-					if (minRangeZ > cpos.z || maxRangeZ < cpos.z) {
-						continue;
-					}
-
-					int16_t offsetZ = centerPos.getOffsetZ(cpos);
-					if ((min_y + offsetZ) > cpos.y || (max_y + offsetZ) < cpos.y || (min_x + offsetZ) > cpos.x ||
-					    (max_x + offsetZ) < cpos.x) {
-						continue;
-					}
-
-					spectators.emplace_back(creature);
-				}
+				const CreatureCell& cell = (onlyPlayers ? leafE->players : leafE->creatures);
+				cell.getSpectators(spectators, centerPos, min_x, max_x, min_y, max_y, minRangeZ, maxRangeZ);
 				leafE = leafE->leafE;
 			} else {
 				leafE = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, nx + FLOOR_SIZE, ny);
@@ -398,7 +476,7 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, boo
 	}
 
 	bool foundCache = false;
-	bool cacheResult = false;
+	QTreeLeafNode* cacheLeaf = nullptr;
 
 	minRangeX = (minRangeX == 0 ? -maxViewportX : -minRangeX);
 	maxRangeX = (maxRangeX == 0 ? maxViewportX : maxRangeX);
@@ -407,9 +485,10 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, boo
 
 	if (minRangeX == -maxViewportX && maxRangeX == maxViewportX && minRangeY == -maxViewportY &&
 	    maxRangeY == maxViewportY && multifloor) {
-		if (onlyPlayers) {
-			auto it = playersSpectatorCache.find(centerPos);
-			if (it != playersSpectatorCache.end()) {
+		QTreeLeafNode* leaf = getQTNode(centerPos.x, centerPos.y);
+		if (leaf && onlyPlayers) {
+			auto it = leaf->playersSpectatorCache.find(centerPos);
+			if (it != leaf->playersSpectatorCache.end()) {
 				if (!spectators.empty()) {
 					spectators.addSpectators(it->second);
 				} else {
@@ -420,9 +499,9 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, boo
 			}
 		}
 
-		if (!foundCache) {
-			auto it = spectatorCache.find(centerPos);
-			if (it != spectatorCache.end()) {
+		if (leaf && !foundCache) {
+			auto it = leaf->spectatorCache.find(centerPos);
+			if (it != leaf->spectatorCache.end()) {
 				if (!onlyPlayers) {
 					if (!spectators.empty()) {
 						const SpectatorVec& cachedSpectators = it->second;
@@ -441,7 +520,7 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, boo
 
 				foundCache = true;
 			} else {
-				cacheResult = true;
+				cacheLeaf = leaf;
 			}
 		}
 	}
@@ -473,19 +552,42 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, boo
 		getSpectatorsInternal(spectators, centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ,
 		                      onlyPlayers);
 
-		if (cacheResult) {
+		if (cacheLeaf) {
 			if (onlyPlayers) {
-				playersSpectatorCache[centerPos] = spectators;
+				cacheLeaf->playersSpectatorCache[centerPos] = spectators;
 			} else {
-				spectatorCache[centerPos] = spectators;
+				cacheLeaf->spectatorCache[centerPos] = spectators;
 			}
 		}
 	}
 }
 
-void Map::clearSpectatorCache() { spectatorCache.clear(); }
+void Map::clearSpectatorCache(const Position& pos, bool players)
+{
+	// only results of the default multifloor viewport are cached, a center position sees pos if it is within the
+	// viewport, shifted by one tile for every floor between them
+	static constexpr int32_t rangeX = maxViewportX + MAP_MAX_LAYERS / 2;
+	static constexpr int32_t rangeY = maxViewportY + MAP_MAX_LAYERS / 2;
+
+	const int32_t startX = std::max<int32_t>(0, pos.x - rangeX) & ~FLOOR_MASK;
+	const int32_t startY = std::max<int32_t>(0, pos.y - rangeY) & ~FLOOR_MASK;
+	const int32_t endX = std::min<int32_t>(0xFFFF, pos.x + rangeX);
+	const int32_t endY = std::min<int32_t>(0xFFFF, pos.y + rangeY);
+
+	for (int32_t y = startY; y <= endY; y += FLOOR_SIZE) {
+		for (int32_t x = startX; x <= endX; x += FLOOR_SIZE) {
+			QTreeLeafNode* leaf = getQTNode(x, y);
+			if (!leaf) {
+				continue;
+			}
 
-void Map::clearPlayersSpectatorCache() { playersSpectatorCache.clear(); }
+			leaf->spectatorCache.clear();
+			if (players) {
+				leaf->playersSpectatorCache.clear();
+			}
+		}
+	}
+}
 
 bool Map::canThrowObjectTo(const Position& fromPos, const Position& toPos, bool checkLineOfSight /*= true*/,
                            bool sameFloor /*= false*/, int32_t rangex /*= Map::maxClientViewportX*/,
@@ -933,6 +1035,31 @@ uint16_t AStarNodes::getTileWalkCost(const Creature& creature, const Tile* tile)
 	return cost;
 }
 
+// MapGrid
+void MapGrid::init(uint16_t startX, uint16_t startY, uint32_t width, uint32_t height)
+{
+	this->startX = startX;
+	this->startY = startY;
+	this->width = width;
+	this->height = height;
+
+	sectorsX = (width + SECTOR_MASK) >> SECTOR_BITS;
+	sectorsY = (height + SECTOR_MASK) >> SECTOR_BITS;
+	sectors.resize(static_cast<size_t>(sectorsX) * sectorsY * MAP_MAX_LAYERS);
+
+	leavesX = (width + FLOOR_MASK) >> FLOOR_BITS;
+	leaves.resize(static_cast<size_t>(leavesX) * ((height + FLOOR_MASK) >> FLOOR_BITS));
+}
+
+void MapGrid::setTile(uint16_t x, uint16_t y, uint8_t z, Tile* tile)
+{
+	auto& sector = sectors[getSectorIndex(x, y, z)];
+	if (!sector) {
+		sector = std::make_unique<MapSector>();
+	}
+	sector->tiles[((y & SECTOR_MASK) << SECTOR_BITS) | (x & SECTOR_MASK)] = tile;
+}
+
 // Floor
 Floor::~Floor()
 {
@@ -1001,28 +1128,88 @@ Floor* QTreeLeafNode::createFloor(uint32_t z)
 
 void QTreeLeafNode::addCreature(Creature* c)
 {
-	creature_list.push_back(c);
+	creatures.addCreature(c, c->getPosition());
 
 	if (c->getPlayer()) {
-		player_list.push_back(c);
+		players.addCreature(c, c->getPosition());
 	}
 }
 
 void QTreeLeafNode::removeCreature(Creature* c)
 {
-	auto iter = std::find(creature_list.begin(), creature_list.end(), c);
-	assert(iter != creature_list.end());
-	*iter = creature_list.back();
-	creature_list.pop_back();
+	creatures.removeCreature(c);
 
 	if (c->getPlayer()) {
-		iter = std::find(player_list.begin(), player_list.end(), c);
-		assert(iter != player_list.end());
-		*iter = player_list.back();
-		player_list.pop_back();
+		players.removeCreature(c);
 	}
 }
 
+void QTreeLeafNode::moveCreature(Creature* c)
+{
+	creatures.moveCreature(c, c->getPosition());
+
+	if (c->getPlayer()) {
+		players.moveCreature(c, c->getPosition());
+	}
+}
+
+// CreatureCell
+void CreatureCell::addCreature(Creature* creature, const Position& pos)
+{
+	creatures.push_back(creature);
+	positionsX.push_back(pos.x);
+	positionsY.push_back(pos.y);
+	positionsZ.push_back(pos.z);
+}
+
+void CreatureCell::removeCreature(Creature* creature)
+{
+	size_t index = getIndex(creature);
+	creatures[index] = creatures.back();
+	creatures.pop_back();
+	positionsX[index] = positionsX.back();
+	positionsX.pop_back();
+	positionsY[index] = positionsY.back();
+	positionsY.pop_back();
+	positionsZ[index] = positionsZ.back();
+	positionsZ.pop_back();
+}
+
+void CreatureCell::moveCreature(Creature* creature, const Position& pos)
+{
+	size_t index = getIndex(creature);
+	positionsX[index] = pos.x;
+	positionsY[index] = pos.y;
+	positionsZ[index] = pos.z;
+}
+
+void CreatureCell::getSpectators(SpectatorVec& spectators, const Position& centerPos, int32_t minRangeX,
+                                 int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY, int32_t minRangeZ,
+                                 int32_t maxRangeZ) const
+{
+	const int32_t centerZ = centerPos.z;
+	for (size_t i = 0, size = creatures.size(); i < size; ++i) {
+		// every creature on another floor is seen with the range shifted by the floor difference, the comparisons
+		// are combined without branches so the loop can be vectorized
+		const int32_t x = positionsX[i];
+		const int32_t y = positionsY[i];
+		const int32_t z = positionsZ[i];
+		const int32_t offsetZ = centerZ - z;
+		const bool inRange = (z >= minRangeZ) & (z <= maxRangeZ) & (x >= minRangeX + offsetZ) &
+		                     (x <= maxRangeX + offsetZ) & (y >= minRangeY + offsetZ) & (y <= maxRangeY + offsetZ);
+		if (inRange) {
+			spectators.emplace_back(creatures[i]);
+		}
+	}
+}
+
+size_t CreatureCell::getIndex(Creature* creature) const
+{
+	auto it = std::find(creatures.begin(), creatures.end(), creature);
+	assert(it != creatures.end());
+	return std::distance(creatures.begin(), it);
+}
+
 uint32_t Map::clean() const
 {
 	uint64_t start = OTSYS_TIME();
@@ -11,6 +11,8 @@
 #include "town.h"
 
 class Creature;
+class Database;
+struct HousesSnapshot;
 
 static constexpr int32_t MAP_MAX_LAYERS = 16;
 
@@ -73,9 +75,106 @@ struct Floor
 	Tile* tiles[FLOOR_SIZE][FLOOR_SIZE] = {};
 };
 
+/**
+ * Creatures standing in one quadtree leaf.
+ * The positions are kept next to the creature pointers in separate arrays,
+ * so a spectator query only reads the arrays instead of dereferencing every
+ * creature. They are updated by the map whenever a creature moves.
+ */
+class CreatureCell
+{
+public:
+	void addCreature(Creature* creature, const Position& pos);
+	void removeCreature(Creature* creature);
+	void moveCreature(Creature* creature, const Position& pos);
+
+	void getSpectators(SpectatorVec& spectators, const Position& centerPos, int32_t minRangeX, int32_t maxRangeX,
+	                   int32_t minRangeY, int32_t maxRangeY, int32_t minRangeZ, int32_t maxRangeZ) const;
+
+	bool empty() const { return creatures.empty(); }
+
+private:
+	size_t getIndex(Creature* creature) const;
+
+	std::vector<Creature*> creatures;
+	std::vector<uint16_t> positionsX;
+	std::vector<uint16_t> positionsY;
+	std::vector<uint8_t> positionsZ;
+};
+
 class FrozenPathingConditionCall;
 class QTreeLeafNode;
 
+static constexpr int32_t SECTOR_BITS = 5;
+static constexpr int32_t SECTOR_SIZE = (1 << SECTOR_BITS);
+static constexpr int32_t SECTOR_MASK = (SECTOR_SIZE - 1);
+
+// largest width and height of the loaded area the tile grid is built for, the lookup tables of a grid this size take
+// about 16 MB
+static constexpr uint32_t MAP_GRID_MAX_SIZE = 8192;
+
+struct MapSector
+{
+	Tile* tiles[SECTOR_SIZE * SECTOR_SIZE] = {};
+};
+
+/**
+ * Flat index over the tiles of the loaded map area.
+ * The bounding box of the loaded tiles is split in 32x32 sectors per floor,
+ * looked up through a table relative to the corner of that box, so getting a
+ * tile only costs one indirection. Tiles and creature lists are still owned by the quadtree, the
+ * grid only mirrors them.
+ */
+class MapGrid
+{
+public:
+	void init(uint16_t startX, uint16_t startY, uint32_t width, uint32_t height);
+	bool isInitialized() const { return !sectors.empty(); }
+
+	// coordinates below the start wrap around to values past the grid size
+	bool contains(uint16_t x, uint16_t y) const
+	{
+		return static_cast<uint16_t>(x - startX) < width && static_cast<uint16_t>(y - startY) < height;
+	}
+
+	Tile* getTile(uint16_t x, uint16_t y, uint8_t z) const
+	{
+		const MapSector* sector = sectors[getSectorIndex(x, y, z)].get();
+		if (!sector) {
+			return nullptr;
+		}
+		return sector->tiles[((y & SECTOR_MASK) << SECTOR_BITS) | (x & SECTOR_MASK)];
+	}
+
+	void setTile(uint16_t x, uint16_t y, uint8_t z, Tile* tile);
+
+	QTreeLeafNode* getLeaf(uint16_t x, uint16_t y) const { return leaves[getLeafIndex(x, y)]; }
+
+	void setLeaf(uint16_t x, uint16_t y, QTreeLeafNode* leaf) { leaves[getLeafIndex(x, y)] = leaf; }
+
+private:
+	size_t getSectorIndex(uint16_t x, uint16_t y, uint8_t z) const
+	{
+		return (z * sectorsY + ((y - startY) >> SECTOR_BITS)) * sectorsX + ((x - startX) >> SECTOR_BITS);
+	}
+
+	size_t getLeafIndex(uint16_t x, uint16_t y) const
+	{
+		return ((y - startY) >> FLOOR_BITS) * leavesX + ((x - startX) >> FLOOR_BITS);
+	}
+
+	std::vector<std::unique_ptr<MapSector>> sectors;
+	std::vector<QTreeLeafNode*> leaves;
+
+	uint16_t startX = 0;
+	uint16_t startY = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t sectorsX = 0;
+	uint32_t sectorsY = 0;
+	uint32_t leavesX = 0;
+};
+
 class QTreeNode
 {
 public:
@@ -135,14 +234,20 @@ public:
 
 	void addCreature(Creature* c);
 	void removeCreature(Creature* c);
+	// updates the stored position of a creature that moved inside this leaf
+	void moveCreature(Creature* c);
 
 private:
 	static bool newLeaf;
 	QTreeLeafNode* leafS = nullptr;
 	QTreeLeafNode* leafE = nullptr;
 	Floor* array[MAP_MAX_LAYERS] = {};
-	CreatureVector creature_list;
-	CreatureVector player_list;
+	CreatureCell creatures;
+	CreatureCell players;
+
+	// spectators of the default viewport, for center positions inside this leaf
+	SpectatorCache spectatorCache;
+	SpectatorCache playersSpectatorCache;
 
 	friend class Map;
 	friend class QTreeNode;
@@ -176,6 +281,12 @@ public:
 	 */
 	static bool save();
 
+	/**
+	 * Write a snapshot of the houses that was taken earlier.
+	 * \returns true if the snapshot was saved successfully
+	 */
+	static bool save(Database& db, const HousesSnapshot& snapshot);
+
 	/**
 	 * Get a single tile.
 	 * \returns A pointer to that tile.
@@ -212,8 +323,12 @@ public:
 	                   bool onlyPlayers = false, int32_t minRangeX = 0, int32_t maxRangeX = 0, int32_t minRangeY = 0,
 	                   int32_t maxRangeY = 0);
 
-	void clearSpectatorCache();
-	void clearPlayersSpectatorCache();
+	/**
+	 * Drops the cached spectators of every center position that can see pos.
+	 * Called whenever a creature enters or leaves the tile at pos.
+	 * \param players also drop the cached player-only results
+	 */
+	void clearSpectatorCache(const Position& pos, bool players);
 
 	/**
 	 * Checks if you can throw an object to that position
@@ -256,18 +371,30 @@ public:
 
 	QTreeLeafNode* getQTNode(uint16_t x, uint16_t y)
 	{
+		if (grid.contains(x, y)) {
+			return grid.getLeaf(x, y);
+		}
 		return QTreeNode::getLeafStatic<QTreeLeafNode*, QTreeNode*>(&root, x, y);
 	}
 
+	/**
+	 * Enables the flat tile grid for the bounding box of the tiles loaded so far.
+	 * Tiles set later inside that box are added to the grid, tiles outside of it
+	 * are only found through the quadtree. Later calls are ignored, and so is
+	 * a box larger than MAP_GRID_MAX_SIZE, which keeps the quadtree lookups.
+	 */
+	void buildTileGrid();
+
 	Spawns spawns;
 	Towns towns;
 	Houses houses;
 
 private:
-	SpectatorCache spectatorCache;
-	SpectatorCache playersSpectatorCache;
+	template <typename Callback>
+	static void forEachLeaf(QTreeNode* node, uint32_t x, uint32_t y, uint32_t size, Callback&& callback);
 
 	QTreeNode root;
+	MapGrid grid;
 
 	std::filesystem::path spawnfile;
 	std::filesystem::path housefile;
@@ -611,6 +611,21 @@ void Monster::goToFollowCreature()
 	onFollowCreatureComplete();
 }
 
+bool Monster::walksByDistanceStep() const
+{
+	if (!followCreature || isSummon()) {
+		return false;
+	} else if (isFleeing()) {
+		return true;
+	}
+
+	// same checks as getDistanceStep, which leaves everything else to the A*
+	const Position& creaturePos = getPosition();
+	const Position& targetPos = followCreature->getPosition();
+	int32_t distance = std::max(creaturePos.getDistanceX(targetPos), creaturePos.getDistanceY(targetPos));
+	return distance <= mType->info.targetDistance && g_game.isSightClear(creaturePos, targetPos, true);
+}
+
 void Monster::onFollowCreatureComplete()
 {
 	auto it = std::find(targetList.begin(), targetList.end(), followCreature);
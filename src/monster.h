@@ -99,6 +99,7 @@ public:
 	void onWalkComplete() override;
 	bool getNextStep(Direction& direction, uint32_t& flags) override;
 	void goToFollowCreature() override;
+	bool walksByDistanceStep() const override;
 	void onFollowCreatureComplete();
 
 	void onThink(uint32_t interval) override;
@@ -10,7 +10,7 @@
 
 #include <boost/locale.hpp>
 
-std::string NetworkMessage::getString(uint16_t stringLen /* = 0*/)
+std::string_view NetworkMessage::getStringView(uint16_t stringLen /* = 0*/)
 {
 	if (stringLen == 0) {
 		stringLen = get<uint16_t>();
@@ -22,8 +22,18 @@ std::string NetworkMessage::getString(uint16_t stringLen /* = 0*/)
 
 	auto it = buffer.data() + info.position;
 	info.position += stringLen;
+	return {reinterpret_cast<char*>(it), stringLen};
+}
+
+std::string NetworkMessage::getString(uint16_t stringLen /* = 0*/)
+{
+	auto latin1Str = getStringView(stringLen);
+
+	// plain ASCII is the same in ISO-8859-1 and UTF-8, which is what almost every string a client sends is
+	if (std::all_of(latin1Str.begin(), latin1Str.end(), [](char c) { return static_cast<uint8_t>(c) < 0x80; })) {
+		return std::string{latin1Str};
+	}
 
-	std::string_view latin1Str{reinterpret_cast<char*>(it), stringLen};
 	return boost::locale::conv::to_utf<char>(latin1Str.data(), latin1Str.data() + latin1Str.size(), "ISO-8859-1",
 	                                         boost::locale::conv::skip);
 }
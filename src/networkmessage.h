@@ -74,6 +74,8 @@ public:
 	}
 
 	std::string getString(uint16_t stringLen = 0);
+	// the string bytes as they were received in ISO-8859-1, only valid as long as the message buffer is
+	std::string_view getStringView(uint16_t stringLen = 0);
 	Position getPosition();
 
 	// skips count unknown/unused bytes in an incoming message
@@ -14,6 +14,7 @@
 #include <bitset>
 #include <boost/algorithm/string.hpp>
 #include <boost/asio.hpp>
+#include <boost/circular_buffer.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/lockfree/stack.hpp>
 #include <boost/variant.hpp>
@@ -39,6 +40,7 @@
 #include <queue>
 #include <random>
 #include <set>
+#include <span>
 #include <sstream>
 #include <string>
 #include <string_view>
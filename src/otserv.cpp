@@ -5,6 +5,7 @@
 
 #include "otserv.h"
 
+#include "authworkers.h"
 #include "configmanager.h"
 #include "databasemanager.h"
 #include "databasetasks.h"
@@ -26,6 +27,7 @@
 #include "gitmetadata.h"
 #endif
 
+AuthWorkers g_authWorkers;
 DatabaseTasks g_databaseTasks;
 Dispatcher g_dispatcher;
 Scheduler g_scheduler;
@@ -126,7 +128,15 @@ void mainLoader(ServiceManager* services)
 		    "The database you have specified in config.lua is empty, please import the schema.sql to your database.");
 		return;
 	}
-	g_databaseTasks.start();
+	if (!g_databaseTasks.start(getNumber(ConfigManager::DATABASE_THREADS))) {
+		startupErrorMessage("Failed to connect the database tasks to the database.");
+		return;
+	}
+
+	if (!g_authWorkers.start(getNumber(ConfigManager::AUTH_THREADS))) {
+		startupErrorMessage("Failed to connect the auth workers to the database.");
+		return;
+	}
 
 	DatabaseManager::updateDatabase();
 
@@ -288,6 +298,7 @@ void startServer()
 	} else {
 		std::cout << ">> No services running. The server is NOT online." << std::endl;
 		g_scheduler.shutdown();
+		g_authWorkers.shutdown();
 		g_databaseTasks.shutdown();
 		g_dispatcher.shutdown();
 	}
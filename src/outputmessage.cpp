@@ -7,39 +7,10 @@
 
 #include "lockfree.h"
 #include "protocol.h"
-#include "scheduler.h"
-
-extern Scheduler g_scheduler;
 
 namespace {
 
 const uint16_t OUTPUTMESSAGE_FREE_LIST_CAPACITY = 2048;
-const std::chrono::milliseconds OUTPUTMESSAGE_AUTOSEND_DELAY{10};
-
-// NOTE: A vector is used here because this container is mostly read and relatively rarely modified (only when a
-// client connects/disconnects)
-std::vector<Protocol_ptr> bufferedProtocols;
-
-void sendAll(const std::vector<Protocol_ptr>& protocols);
-
-void scheduleSendAll(const std::vector<Protocol_ptr>& protocols)
-{
-	g_scheduler.addEvent(createSchedulerTask(OUTPUTMESSAGE_AUTOSEND_DELAY.count(), [&]() { sendAll(protocols); }));
-}
-
-void sendAll(const std::vector<Protocol_ptr>& protocols)
-{
-	// dispatcher thread
-	for (auto& protocol : protocols) {
-		if (auto& msg = protocol->getCurrentBuffer()) {
-			protocol->send(std::move(msg));
-		}
-	}
-
-	if (!protocols.empty()) {
-		scheduleSendAll(protocols);
-	}
-}
 
 } // namespace
 
@@ -53,18 +24,11 @@ OutputMessage_ptr tfs::net::make_output_message()
 void tfs::net::insert_protocol_to_autosend(const Protocol_ptr& protocol)
 {
 	// dispatcher thread
-	if (bufferedProtocols.empty()) {
-		scheduleSendAll(bufferedProtocols);
-	}
-	bufferedProtocols.emplace_back(protocol);
+	protocol->setAutosend(true);
 }
 
 void tfs::net::remove_protocol_from_autosend(const Protocol_ptr& protocol)
 {
 	// dispatcher thread
-	auto it = std::find(bufferedProtocols.begin(), bufferedProtocols.end(), protocol);
-	if (it != bufferedProtocols.end()) {
-		std::swap(*it, bufferedProtocols.back());
-		bufferedProtocols.pop_back();
-	}
+	protocol->setAutosend(false);
 }
@@ -51,6 +51,8 @@ public:
 	void setSequenceId(uint32_t sequence) { sequenceId = sequence; }
 	uint32_t getSequenceId() const { return sequenceId; }
 
+	std::chrono::steady_clock::time_point getCreationTime() const { return creationTime; }
+
 private:
 	template <typename T>
 	void add_header(T add)
@@ -64,6 +66,8 @@ private:
 
 	MsgSize_t outputBufferStart = INITIAL_BUFFER_POSITION;
 	uint32_t sequenceId;
+	// for the latency from the first packet written into the message to the message being written to the socket
+	std::chrono::steady_clock::time_point creationTime = std::chrono::steady_clock::now();
 };
 
 namespace tfs::net {
@@ -1560,6 +1560,9 @@ void Player::onThink(uint32_t interval)
 	Creature::onThink(interval);
 
 	sendPing();
+	if (client) {
+		client->sendPendingHealth();
+	}
 
 	MessageBufferTicks += interval;
 	if (MessageBufferTicks >= 1500) {
@@ -3915,6 +3918,15 @@ bool Player::hasOutfit(uint32_t lookType, uint8_t addons)
 	return false;
 }
 
+void Player::confirmSave(uint32_t sequence, bool written)
+{
+	savedStorage.confirm(sequence, written);
+	savedOutfits.confirm(sequence, written);
+	savedMounts.confirm(sequence, written);
+	savedSpells.confirm(sequence, written);
+	savedItemDigests.confirm(sequence, written);
+}
+
 void Player::addOutfit(uint16_t lookType, uint8_t addons)
 {
 	for (auto& [outfit, addon] : outfits) {
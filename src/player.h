@@ -12,6 +12,7 @@
 #include "guild.h"
 #include "inbox.h"
 #include "protocolgame.h"
+#include "savedrows.h"
 #include "town.h"
 #include "vocation.h"
 
@@ -300,6 +301,9 @@ public:
 
 	time_t getLastLogout() const { return lastLogout; }
 
+	// the write of a snapshot finished, its rows become the saved rows if it was written
+	void confirmSave(uint32_t sequence, bool written);
+
 	const Position& getLoginPosition() const { return loginPosition; }
 	const Position& getTemplePosition() const { return town->templePosition; }
 	const Town* getTown() const { return town; }
@@ -618,12 +622,12 @@ public:
 			client->sendMoveCreature(creature, newPos, newStackPos, oldPos, oldStackPos, teleport);
 		}
 	}
-	void sendCreatureTurn(const Creature* creature)
+	void sendCreatureTurn(const Creature* creature, CreatureTurnPackets& packets)
 	{
 		if (client && canSeeCreature(creature)) {
 			int32_t stackpos = creature->getTile()->getClientIndexOfCreature(this, creature);
 			if (stackpos != -1) {
-				client->sendCreatureTurn(creature, stackpos);
+				client->sendCreatureTurn(creature, stackpos, packets);
 			}
 		}
 	}
@@ -868,12 +872,24 @@ public:
 			client->sendCreatureHealth(creature);
 		}
 	}
+	void sendCreatureHealth(const Creature* creature, const NetworkMessage& encoded) const
+	{
+		if (client) {
+			client->sendCreatureHealth(creature, encoded);
+		}
+	}
 	void sendDistanceShoot(const Position& from, const Position& to, unsigned char type) const
 	{
 		if (client) {
 			client->sendDistanceShoot(from, to, type);
 		}
 	}
+	void sendDistanceShoot(const NetworkMessage& encoded) const
+	{
+		if (client) {
+			client->sendDistanceShoot(encoded);
+		}
+	}
 	void sendHouseWindow(House* house, uint32_t listId) const;
 	void sendCreatePrivateChannel(uint16_t channelId, const std::string& channelName)
 	{
@@ -900,6 +916,19 @@ public:
 			client->sendMagicEffect(pos, type);
 		}
 	}
+	void sendMagicEffect(const Position& pos, const NetworkMessage& encoded) const
+	{
+		if (client) {
+			client->sendMagicEffect(pos, encoded);
+		}
+	}
+	// appends a packet that was encoded once for all spectators, see ProtocolGame::encodeCreatureSay
+	void sendEncodedPacket(const NetworkMessage& encoded) const
+	{
+		if (client) {
+			client->writeToOutputBuffer(encoded);
+		}
+	}
 	void sendPing();
 	void sendPingBack() const
 	{
@@ -1215,6 +1244,15 @@ private:
 
 	std::map<uint16_t, uint8_t> outfits;
 	std::unordered_set<uint16_t> mounts;
+
+	// rows of the player tables as the database holds them since the last save, see IOLoginData::snapshotPlayer
+	SavedRows<uint32_t, int32_t> savedStorage;
+	SavedRows<uint16_t, uint8_t> savedOutfits;
+	SavedRows<uint16_t> savedMounts;
+	SavedRows<std::string> savedSpells;
+	// the item tables are rewritten as a whole when their rows change, digests of the saved rows by PlayerItemTable_t
+	SavedRows<uint8_t, std::string> savedItemDigests;
+	uint32_t lastSaveSequence = 0;
 	GuildWarVector guildWarVector;
 
 	std::list<ShopInfo> shopItemList;
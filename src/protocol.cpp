@@ -5,12 +5,29 @@
 
 #include "protocol.h"
 
+#include "configmanager.h"
 #include "outputmessage.h"
 #include "rsa.h"
 #include "xtea.h"
 
 namespace {
 
+struct AtomicCompressionStats
+{
+	std::atomic<uint64_t> packets{0};
+	std::atomic<uint64_t> compressed{0};
+	std::atomic<uint64_t> bytesIn{0};
+	std::atomic<uint64_t> bytesOut{0};
+	std::atomic<uint64_t> nanoseconds{0};
+};
+
+// updated by every network thread
+std::array<AtomicCompressionStats, 256> compressionStats;
+
+// dispatcher thread, autosend protocols with messages in their output buffer in the order they were first written to
+std::shared_ptr<Protocol> dirtyHead;
+Protocol* dirtyTail = nullptr;
+
 void XTEA_encrypt(OutputMessage& msg, const xtea::round_keys& key)
 {
 	// The message must be a multiple of 8
@@ -45,6 +62,10 @@ bool XTEA_decrypt(NetworkMessage& msg, const xtea::round_keys& key)
 
 Protocol::~Protocol()
 {
+	if (!compressionEnabled) {
+		return;
+	}
+
 	const auto zlibEndResult = deflateEnd(&zstream);
 	if (zlibEndResult == Z_DATA_ERROR) {
 		std::cout << "ZLIB discarded pending output or unprocessed input while cleaning up stream state" << std::endl;
@@ -58,7 +79,8 @@ void Protocol::onSendMessage(const OutputMessage_ptr& msg)
 	if (!rawMessages) {
 		if (encryptionEnabled && checksumMode == CHECKSUM_SEQUENCE) {
 			uint32_t compressionChecksum = 0;
-			if (msg->getLength() >= 128 && deflateMessage(*msg)) {
+			if (compressionEnabled && getBoolean(ConfigManager::PACKET_COMPRESSION) &&
+			    msg->getLength() >= getNumber(ConfigManager::PACKET_COMPRESSION_THRESHOLD) && deflateMessage(*msg)) {
 				compressionChecksum = 0x80000000;
 			}
 
@@ -74,9 +96,9 @@ void Protocol::onSendMessage(const OutputMessage_ptr& msg)
 	}
 }
 
-void Protocol::onRecvMessage(NetworkMessage& msg)
+void Protocol::onRecvMessage(NetworkMessage_ptr& msg)
 {
-	if (encryptionEnabled && !XTEA_decrypt(msg, key)) {
+	if (encryptionEnabled && !XTEA_decrypt(*msg, key)) {
 		return;
 	}
 
@@ -88,6 +110,7 @@ OutputMessage_ptr Protocol::getOutputBuffer(int32_t size)
 	// dispatcher thread
 	if (!outputBuffer) {
 		outputBuffer = tfs::net::make_output_message();
+		linkDirty();
 	} else if ((outputBuffer->getLength() + size) > NetworkMessage::MAX_PROTOCOL_BODY_LENGTH) {
 		send(outputBuffer);
 		outputBuffer = tfs::net::make_output_message();
@@ -95,6 +118,53 @@ OutputMessage_ptr Protocol::getOutputBuffer(int32_t size)
 	return outputBuffer;
 }
 
+void Protocol::setAutosend(bool value)
+{
+	autosend = value;
+	if (!autosend) {
+		unlinkDirty();
+	} else if (outputBuffer) {
+		linkDirty();
+	}
+}
+
+void Protocol::sendAutosendMessages()
+{
+	while (dirtyHead) {
+		auto protocol = dirtyHead;
+		protocol->unlinkDirty();
+		if (protocol->outputBuffer) {
+			protocol->send(std::move(protocol->outputBuffer));
+		}
+	}
+}
+
+void Protocol::linkDirty()
+{
+	if (!autosend || dirty) {
+		return;
+	}
+
+	dirty = true;
+	prevDirty = dirtyTail;
+	(dirtyTail ? dirtyTail->nextDirty : dirtyHead) = shared_from_this();
+	dirtyTail = this;
+}
+
+void Protocol::unlinkDirty()
+{
+	if (!dirty) {
+		return;
+	}
+
+	// the predecessor owns this protocol, keep it alive until it has been unlinked
+	auto self = shared_from_this();
+	dirty = false;
+	(nextDirty ? nextDirty->prevDirty : dirtyTail) = prevDirty;
+	(prevDirty ? prevDirty->nextDirty : dirtyHead) = std::move(nextDirty);
+	prevDirty = nullptr;
+}
+
 bool Protocol::RSA_decrypt(NetworkMessage& msg)
 {
 	if (msg.getRemainingBufferLength() < RSA_BUFFER_LENGTH) {
@@ -105,10 +175,46 @@ bool Protocol::RSA_decrypt(NetworkMessage& msg)
 	return msg.getByte() == 0;
 }
 
+void Protocol::enableCompression()
+{
+	if (compressionEnabled) {
+		return;
+	}
+
+	const int level = std::clamp<int>(getNumber(ConfigManager::PACKET_COMPRESSION_LEVEL), Z_BEST_SPEED,
+	                                  Z_BEST_COMPRESSION);
+	if (deflateInit2(&zstream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+		std::cout << "ZLIB initialization error: " << (zstream.msg ? zstream.msg : "unknown") << std::endl;
+		return;
+	}
+	compressionEnabled = true;
+}
+
+std::array<Protocol::CompressionStats, 256> Protocol::getCompressionStats()
+{
+	std::array<CompressionStats, 256> stats;
+	for (size_t opcode = 0; opcode < stats.size(); ++opcode) {
+		const auto& counters = compressionStats[opcode];
+		stats[opcode] = {
+		    .packets = counters.packets.load(std::memory_order_relaxed),
+		    .compressed = counters.compressed.load(std::memory_order_relaxed),
+		    .bytesIn = counters.bytesIn.load(std::memory_order_relaxed),
+		    .bytesOut = counters.bytesOut.load(std::memory_order_relaxed),
+		    .nanoseconds = counters.nanoseconds.load(std::memory_order_relaxed),
+		};
+	}
+	return stats;
+}
+
 bool Protocol::deflateMessage(OutputMessage& msg)
 {
 	static thread_local std::vector<uint8_t> buffer(NETWORKMESSAGE_MAXSIZE);
 
+	const auto start = std::chrono::steady_clock::now();
+	auto& stats = compressionStats[msg.getOutputBuffer()[0]];
+	stats.packets.fetch_add(1, std::memory_order_relaxed);
+	stats.bytesIn.fetch_add(msg.getLength(), std::memory_order_relaxed);
+
 	zstream.next_in = msg.getOutputBuffer();
 	zstream.avail_in = msg.getLength();
 	zstream.next_out = buffer.data();
@@ -118,6 +224,7 @@ bool Protocol::deflateMessage(OutputMessage& msg)
 	if (result != Z_OK && result != Z_STREAM_END) {
 		std::cout << "Error while deflating packet data error: " << (zstream.msg ? zstream.msg : "unknown")
 		          << std::endl;
+		deflateReset(&zstream);
 		return false;
 	}
 
@@ -130,9 +237,21 @@ bool Protocol::deflateMessage(OutputMessage& msg)
 		return false;
 	}
 
+	// a message that does not get smaller is sent as it is
+	if (size >= msg.getLength()) {
+		stats.bytesOut.fetch_add(msg.getLength(), std::memory_order_relaxed);
+		stats.nanoseconds.fetch_add(std::chrono::nanoseconds(std::chrono::steady_clock::now() - start).count(),
+		                            std::memory_order_relaxed);
+		return false;
+	}
+
 	msg.reset();
 	msg.addBytes(reinterpret_cast<const char*>(buffer.data()), size);
 
+	stats.compressed.fetch_add(1, std::memory_order_relaxed);
+	stats.bytesOut.fetch_add(size, std::memory_order_relaxed);
+	stats.nanoseconds.fetch_add(std::chrono::nanoseconds(std::chrono::steady_clock::now() - start).count(),
+	                            std::memory_order_relaxed);
 	return true;
 }
 
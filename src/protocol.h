@@ -12,23 +12,29 @@
 class Protocol : public std::enable_shared_from_this<Protocol>
 {
 public:
-	explicit Protocol(Connection_ptr connection) : connection(connection)
+	struct CompressionStats
 	{
-		if (deflateInit2(&zstream, 6, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
-			std::cout << "ZLIB initialization error: " << (zstream.msg ? zstream.msg : "unknown") << std::endl;
-		}
-	}
+		uint64_t packets = 0;
+		uint64_t compressed = 0;
+		uint64_t bytesIn = 0;
+		uint64_t bytesOut = 0;
+		uint64_t nanoseconds = 0;
+	};
+
+	explicit Protocol(Connection_ptr connection) : connection(connection) {}
 	virtual ~Protocol();
 
 	// non-copyable
 	Protocol(const Protocol&) = delete;
 	Protocol& operator=(const Protocol&) = delete;
 
-	virtual void parsePacket(NetworkMessage&) {}
+	// the packet may be taken over by the protocol, the connection reads the next one into another buffer then
+	virtual void parsePacket(NetworkMessage_ptr&) {}
 
 	virtual void onSendMessage(const OutputMessage_ptr& msg);
-	void onRecvMessage(NetworkMessage& msg);
-	virtual void onRecvFirstMessage(NetworkMessage& msg) = 0;
+	void onRecvMessage(NetworkMessage_ptr& msg);
+	// may take the packet over as well, to finish the login on another thread
+	virtual void onRecvFirstMessage(NetworkMessage_ptr& msg) = 0;
 	virtual void onConnect() {}
 
 	bool isConnectionExpired() const { return connection.expired(); }
@@ -40,7 +46,11 @@ public:
 	// Use this function for autosend messages only
 	OutputMessage_ptr getOutputBuffer(int32_t size);
 
-	OutputMessage_ptr& getCurrentBuffer() { return outputBuffer; }
+	// dispatcher thread, the output buffer of an autosend protocol is sent at the end of the dispatcher batch that
+	// wrote to it
+	void setAutosend(bool value);
+	// dispatcher thread, sends the output buffer of every autosend protocol that has been written to since the last call
+	static void sendAutosendMessages();
 
 	void send(OutputMessage_ptr msg) const
 	{
@@ -59,6 +69,10 @@ public:
 		return sequence;
 	}
 
+	// Deflate statistics of every message that was big enough to be compressed, by the opcode of the first packet in
+	// the message. Compressed counts the messages that came out smaller and were sent deflated.
+	static std::array<CompressionStats, 256> getCompressionStats();
+
 protected:
 	static constexpr size_t RSA_BUFFER_LENGTH = 128;
 
@@ -71,6 +85,8 @@ protected:
 	void enableXTEAEncryption() { encryptionEnabled = true; }
 	void setXTEAKey(const xtea::key& key) { this->key = xtea::expand_key(key); }
 	void setChecksumMode(checksumMode_t newMode) { checksumMode = newMode; }
+	// only for clients that use sequence checksums, they tell deflated messages apart by the sequence id
+	void enableCompression();
 
 	static bool RSA_decrypt(NetworkMessage& msg);
 
@@ -83,14 +99,26 @@ protected:
 private:
 	friend class Connection;
 
+	void linkDirty();
+	void unlinkDirty();
+
 	OutputMessage_ptr outputBuffer;
 
+	// Autosend protocols with messages in their output buffer are linked into the dirty list, a linked protocol is owned
+	// by its predecessor so it stays alive until it has been flushed or unlinked.
+	bool autosend = false;
+	bool dirty = false;
+	Protocol* prevDirty = nullptr;
+	std::shared_ptr<Protocol> nextDirty;
+
 	const ConnectionWeak_ptr connection;
 	xtea::round_keys key;
 	uint32_t sequenceNumber = 0;
 	bool encryptionEnabled = false;
 	checksumMode_t checksumMode = CHECKSUM_ADLER;
 	bool rawMessages = false;
+	// the deflate state takes a few hundred kilobytes, it is only allocated for clients that accept compression
+	bool compressionEnabled = false;
 
 	z_stream zstream{};
 };
@@ -5,6 +5,7 @@
 
 #include "protocolgame.h"
 
+#include "authworkers.h"
 #include "ban.h"
 #include "base64.h"
 #include "condition.h"
@@ -42,6 +43,15 @@ auto findClient(uint32_t guid)
 	return std::make_pair(waitList.end(), slot);
 }
 
+uint8_t getHealthPercent(const Creature* creature)
+{
+	if (creature->isHealthHidden()) {
+		return 0x00;
+	}
+	return std::ceil((static_cast<double>(creature->getHealth()) / std::max<int32_t>(creature->getMaxHealth(), 1)) *
+	                 100);
+}
+
 constexpr int64_t getWaitTime(std::size_t slot)
 {
 	if (slot < 5) {
@@ -172,6 +182,11 @@ void ProtocolGame::login(uint32_t characterId, uint32_t accountId, OperatingSyst
 			return;
 		}
 
+		if (g_game.isPlayerSavePending(player->getGUID())) {
+			disconnectClient("Your character is still being saved.\nPlease try again in a moment.");
+			return;
+		}
+
 		if (g_game.getGameState() == GAME_STATE_CLOSING && !player->hasFlag(PlayerFlag_CanAlwaysLogin)) {
 			disconnectClient("The game is just going down.\nPlease try again later.");
 			return;
@@ -335,7 +350,7 @@ void ProtocolGame::logout(bool displayEffect, bool forced)
 }
 
 // Login to the game world request
-void ProtocolGame::onRecvFirstMessage(NetworkMessage& msg)
+void ProtocolGame::onRecvFirstMessage(NetworkMessage_ptr& packet)
 {
 	// Server is shutting down
 	if (g_game.getGameState() == GAME_STATE_SHUTDOWN) {
@@ -343,6 +358,8 @@ void ProtocolGame::onRecvFirstMessage(NetworkMessage& msg)
 		return;
 	}
 
+	NetworkMessage& msg = *packet;
+
 	// Client type and OS used
 	OperatingSystem_t operatingSystem = static_cast<OperatingSystem_t>(msg.get<uint16_t>());
 
@@ -352,106 +369,164 @@ void ProtocolGame::onRecvFirstMessage(NetworkMessage& msg)
 	// String client version
 	if (version >= 1240) {
 		if (msg.getRemainingBufferLength() > 132) {
-			msg.getString();
+			msg.getStringView();
 		}
 	}
 
 	msg.skipBytes(3); // U16 dat revision, U8 preview state
 
-	// Disconnect if RSA decrypt fails
-	if (!Protocol::RSA_decrypt(msg)) {
-		disconnect();
+	// the decryption and the queries run on an auth worker, a burst of logins must not hold up the network threads
+	g_authWorkers.addTask(
+	    [thisPtr = getThis(), msg = std::shared_ptr<NetworkMessage>(std::move(packet)), operatingSystem](Database& db) {
+		    thisPtr->authenticate(*msg, operatingSystem, db);
+	    });
+}
+
+void ProtocolGame::authenticate(NetworkMessage& msg, OperatingSystem_t operatingSystem, Database& db)
+{
+	auto connection = getConnection();
+	if (!connection) {
 		return;
 	}
 
-	// Get XTEA key
-	xtea::key key;
-	key[0] = msg.get<uint32_t>();
-	key[1] = msg.get<uint32_t>();
-	key[2] = msg.get<uint32_t>();
-	key[3] = msg.get<uint32_t>();
-	enableXTEAEncryption();
-	setXTEAKey(std::move(key));
+	AuthResult result;
+	result.operatingSystem = operatingSystem;
 
-	// Enable extended opcode feature for otclient
-	if (operatingSystem >= CLIENTOS_OTCLIENT_LINUX) {
-		NetworkMessage opcodeMessage;
-		opcodeMessage.addByte(0x32);
-		opcodeMessage.addByte(0x00);
-		opcodeMessage.add<uint16_t>(0x00);
-		writeToOutputBuffer(opcodeMessage);
-	}
+	auto finish = [&]() {
+		connection->post([thisPtr = getThis(), result = std::move(result)]() { thisPtr->onAuthenticated(result); });
+	};
 
-	// Change packet verifying mode for QT clients
-	if (version >= 1111 && operatingSystem >= CLIENTOS_QT_LINUX && operatingSystem <= CLIENTOS_OTCLIENT_MAC) {
-		setChecksumMode(CHECKSUM_SEQUENCE);
+	// Disconnect if RSA decrypt fails
+	if (!Protocol::RSA_decrypt(msg)) {
+		finish();
+		return;
 	}
 
+	// Get XTEA key
+	result.decrypted = true;
+	result.key[0] = msg.get<uint32_t>();
+	result.key[1] = msg.get<uint32_t>();
+	result.key[2] = msg.get<uint32_t>();
+	result.key[3] = msg.get<uint32_t>();
+
 	// Web login skips the character list request so we need to check the client version again
 	if (version < CLIENT_VERSION_MIN || version > CLIENT_VERSION_MAX) {
-		disconnectClient(fmt::format("Only clients with protocol {:s} allowed!", CLIENT_VERSION_STR));
+		result.error = fmt::format("Only clients with protocol {:s} allowed!", CLIENT_VERSION_STR);
+		finish();
 		return;
 	}
 
 	msg.skipBytes(1); // Gamemaster flag
 
-	auto sessionToken = tfs::base64::decode(msg.getString());
+	auto sessionToken = tfs::base64::decode(msg.getStringView());
 	if (sessionToken.empty()) {
-		disconnectClient("Malformed session key.");
+		result.error = "Malformed session key.";
+		finish();
 		return;
 	}
 
 	if (operatingSystem == CLIENTOS_QT_LINUX) {
-		msg.getString(); // OS name (?)
-		msg.getString(); // OS version (?)
+		msg.getStringView(); // OS name (?)
+		msg.getStringView(); // OS version (?)
 	}
 
 	auto characterName = msg.getString();
 	uint32_t timeStamp = msg.get<uint32_t>();
 	uint8_t randNumber = msg.getByte();
 	if (challengeTimestamp != timeStamp || challengeRandom != randNumber) {
-		disconnect();
+		result.drop = true;
+		finish();
 		return;
 	}
 
 	if (g_game.getGameState() == GAME_STATE_STARTUP) {
-		disconnectClient("Gameworld is starting up. Please wait.");
+		result.error = "Gameworld is starting up. Please wait.";
+		finish();
 		return;
 	}
 
 	if (g_game.getGameState() == GAME_STATE_MAINTAIN) {
-		disconnectClient("Gameworld is under maintenance. Please re-connect in a while.");
+		result.error = "Gameworld is under maintenance. Please re-connect in a while.";
+		finish();
 		return;
 	}
 
-	auto ip = getIP();
-	if (const auto& banInfo = IOBan::getIpBanInfo(ip)) {
-		disconnectClient(fmt::format("Your IP has been banned until {:s} by {:s}.\n\nReason specified:\n{:s}",
-		                             formatDateShort(banInfo->expiresAt), banInfo->bannedBy, banInfo->reason));
+	const auto& ip = connection->getIP();
+	if (const auto& banInfo = IOBan::getIpBanInfo(ip, db)) {
+		result.error = fmt::format("Your IP has been banned until {:s} by {:s}.\n\nReason specified:\n{:s}",
+		                           formatDateShort(banInfo->expiresAt), banInfo->bannedBy, banInfo->reason);
+		finish();
 		return;
 	}
 
-	Database& db = Database::getInstance();
-	auto result = db.storeQuery(fmt::format(
+	auto dbResult = db.storeQuery(fmt::format(
 	    "SELECT `a`.`id` AS `account_id`, INET6_NTOA(`s`.`ip`) AS `session_ip`, `p`.`id` AS `character_id` FROM `accounts` `a` JOIN `sessions` `s` ON `a`.`id` = `s`.`account_id` JOIN `players` `p` ON `a`.`id` = `p`.`account_id` WHERE `s`.`token` = {:s} AND `s`.`expired_at` IS NULL AND `p`.`name` = {:s} AND `p`.`deletion` = 0",
 	    db.escapeString(sessionToken), db.escapeString(characterName)));
-	if (!result) {
-		disconnectClient("Account name or password is not correct.");
+	if (!dbResult) {
+		result.error = "Account name or password is not correct.";
+		finish();
 		return;
 	}
 
-	uint32_t accountId = result->getNumber<uint32_t>("account_id");
-	if (accountId == 0) {
-		disconnectClient("Account name or password is not correct.");
+	result.accountId = dbResult->getNumber<uint32_t>("account_id");
+	if (result.accountId == 0) {
+		result.error = "Account name or password is not correct.";
+		finish();
 		return;
 	}
 
-	Connection::Address sessionIP = boost::asio::ip::make_address(result->getString("session_ip"));
+	Connection::Address sessionIP = boost::asio::ip::make_address(dbResult->getString("session_ip"));
 	if (!sessionIP.is_loopback() && ip != sessionIP) {
-		disconnectClient("Your game session is already locked to a different IP. Please log in again.");
+		result.error = "Your game session is already locked to a different IP. Please log in again.";
+		finish();
+		return;
+	}
+
+	result.characterId = dbResult->getNumber<uint32_t>("character_id");
+	finish();
+}
+
+void ProtocolGame::onAuthenticated(const AuthResult& result)
+{
+	if (!result.decrypted) {
+		disconnect();
+		return;
 	}
 
-	g_dispatcher.addTask([=, thisPtr = getThis(), characterId = result->getNumber<uint32_t>("character_id")]() {
+	enableXTEAEncryption();
+	setXTEAKey(result.key);
+
+	const auto operatingSystem = result.operatingSystem;
+
+	// Enable extended opcode feature for otclient
+	if (operatingSystem >= CLIENTOS_OTCLIENT_LINUX) {
+		NetworkMessage opcodeMessage;
+		opcodeMessage.addByte(0x32);
+		opcodeMessage.addByte(0x00);
+		opcodeMessage.add<uint16_t>(0x00);
+		writeToOutputBuffer(opcodeMessage);
+	}
+
+	// Change packet verifying mode for QT clients, the sequence ids also tell them which packets are deflated
+	if (version >= 1111 && operatingSystem >= CLIENTOS_QT_LINUX && operatingSystem <= CLIENTOS_OTCLIENT_MAC) {
+		setChecksumMode(CHECKSUM_SEQUENCE);
+		if (getBoolean(ConfigManager::PACKET_COMPRESSION)) {
+			enableCompression();
+		}
+	}
+
+	if (result.drop) {
+		disconnect();
+		return;
+	}
+
+	if (!result.error.empty()) {
+		disconnectClient(result.error);
+		return;
+	}
+
+	// only the world insertion runs on the dispatcher
+	g_dispatcher.addTask([=, thisPtr = getThis(), characterId = result.characterId, accountId = result.accountId]() {
 		thisPtr->login(characterId, accountId, operatingSystem);
 	});
 }
@@ -500,8 +575,20 @@ void ProtocolGame::writeToOutputBuffer(const NetworkMessage& msg)
 	out->append(msg);
 }
 
-void ProtocolGame::parsePacket(NetworkMessage& msg)
+bool ProtocolGame::skipUpdate()
+{
+	auto connection = getConnection();
+	if (!connection || !connection->isCongested()) {
+		return false;
+	}
+
+	ConnectionManager::getInstance().recordShed();
+	return true;
+}
+
+void ProtocolGame::parsePacket(NetworkMessage_ptr& packet)
 {
+	NetworkMessage& msg = *packet;
 	if (!acceptPackets || g_game.getGameState() == GAME_STATE_SHUTDOWN || msg.isEmpty()) {
 		return;
 	}
@@ -793,12 +880,11 @@ void ProtocolGame::parsePacket(NetworkMessage& msg)
 			// case 0xFE: break; // store window history 2
 
 		default:
-			// we cannot pass an unique_ptr as capture here because
-			// std::function requires the callable object to be *copyable*
-			g_dispatcher.addTask([=, playerID = player->getID(), msg = new NetworkMessage(msg)]() {
-				g_game.parsePlayerNetworkMessage(playerID, recvbyte, NetworkMessage_ptr(msg));
+			// the receive buffer itself is handed to the dispatcher, nothing has been read past the opcode yet
+			g_dispatcher.addTask([=, playerID = player->getID(), msg = std::move(packet)]() mutable {
+				g_game.parsePlayerNetworkMessage(playerID, recvbyte, std::move(msg));
 			});
-			break;
+			return;
 	}
 
 	if (msg.isOverrun()) {
@@ -923,6 +1009,7 @@ void ProtocolGame::checkCreatureAsKnown(uint32_t id, bool& known, uint32_t& remo
 			if (!canSee(creature)) {
 				removedKnown = *it;
 				knownCreatureSet.erase(it);
+				pendingHealth.erase(removedKnown);
 				return;
 			}
 		}
@@ -935,6 +1022,7 @@ void ProtocolGame::checkCreatureAsKnown(uint32_t id, bool& known, uint32_t& remo
 
 		removedKnown = *it;
 		knownCreatureSet.erase(it);
+		pendingHealth.erase(removedKnown);
 	} else {
 		removedKnown = 0;
 	}
@@ -989,14 +1077,14 @@ void ProtocolGame::parseChannelInvite(NetworkMessage& msg)
 {
 	auto name = msg.getString();
 	g_dispatcher.addTask(
-	    [playerID = player->getID(), name = std::string{name}]() { g_game.playerChannelInvite(playerID, name); });
+	    [playerID = player->getID(), name = std::move(name)]() { g_game.playerChannelInvite(playerID, name); });
 }
 
 void ProtocolGame::parseChannelExclude(NetworkMessage& msg)
 {
 	auto name = msg.getString();
 	g_dispatcher.addTask(
-	    [=, playerID = player->getID(), name = std::string{name}]() { g_game.playerChannelExclude(playerID, name); });
+	    [playerID = player->getID(), name = std::move(name)]() { g_game.playerChannelExclude(playerID, name); });
 }
 
 void ProtocolGame::parseOpenChannel(NetworkMessage& msg)
@@ -1014,7 +1102,7 @@ void ProtocolGame::parseCloseChannel(NetworkMessage& msg)
 void ProtocolGame::parseOpenPrivateChannel(NetworkMessage& msg)
 {
 	auto receiver = msg.getString();
-	g_dispatcher.addTask([playerID = player->getID(), receiver = std::string{receiver}]() {
+	g_dispatcher.addTask([playerID = player->getID(), receiver = std::move(receiver)]() {
 		g_game.playerOpenPrivateChannel(playerID, receiver);
 	});
 }
@@ -1259,7 +1347,7 @@ void ProtocolGame::parseSay(NetworkMessage& msg)
 		return;
 	}
 
-	g_dispatcher.addTask([=, playerID = player->getID(), receiver = std::string{receiver}, text = std::string{text}]() {
+	g_dispatcher.addTask([=, playerID = player->getID(), receiver = std::move(receiver), text = std::move(text)]() {
 		g_game.playerSay(playerID, channelId, type, receiver, text);
 	});
 }
@@ -1323,7 +1411,7 @@ void ProtocolGame::parseHouseWindow(NetworkMessage& msg)
 	uint8_t doorId = msg.getByte();
 	uint32_t id = msg.get<uint32_t>();
 	auto text = msg.getString();
-	g_dispatcher.addTask([=, playerID = player->getID(), text = std::string{text}]() {
+	g_dispatcher.addTask([=, playerID = player->getID(), text = std::move(text)]() {
 		g_game.playerUpdateHouseWindow(playerID, doorId, id, text);
 	});
 }
@@ -1392,7 +1480,7 @@ void ProtocolGame::parseAddVip(NetworkMessage& msg)
 {
 	auto name = msg.getString();
 	g_dispatcher.addTask(
-	    [playerID = player->getID(), name = std::string{name}]() { g_game.playerRequestAddVip(playerID, name); });
+	    [playerID = player->getID(), name = std::move(name)]() { g_game.playerRequestAddVip(playerID, name); });
 }
 
 void ProtocolGame::parseRemoveVip(NetworkMessage& msg)
@@ -1407,7 +1495,7 @@ void ProtocolGame::parseEditVip(NetworkMessage& msg)
 	auto description = msg.getString();
 	uint32_t icon = std::min<uint32_t>(10, msg.get<uint32_t>()); // 10 is max icon in 9.63
 	bool notify = msg.getByte() != 0;
-	g_dispatcher.addTask([=, playerID = player->getID(), description = std::string{description}]() {
+	g_dispatcher.addTask([=, playerID = player->getID(), description = std::move(description)]() {
 		g_game.playerRequestEditVip(playerID, guid, description, icon, notify);
 	});
 }
@@ -1436,8 +1524,8 @@ void ProtocolGame::parseRuleViolationReport(NetworkMessage& msg)
 		msg.get<uint32_t>(); // statement id, used to get whatever player have said, we don't log that.
 	}
 
-	g_dispatcher.addTask([=, playerID = player->getID(), targetName = std::string{targetName},
-	                      comment = std::string{comment}, translation = std::string{translation}]() {
+	g_dispatcher.addTask([=, playerID = player->getID(), targetName = std::move(targetName), comment = std::move(comment),
+	                      translation = std::move(translation)]() {
 		g_game.playerReportRuleViolation(playerID, targetName, reportType, reportReason, comment, translation);
 	});
 }
@@ -1454,8 +1542,8 @@ void ProtocolGame::parseDebugAssert(NetworkMessage& msg)
 	auto date = msg.getString();
 	auto description = msg.getString();
 	auto comment = msg.getString();
-	g_dispatcher.addTask([playerID = player->getID(), assertLine = std::string{assertLine}, date = std::string{date},
-	                      description = std::string{description}, comment = std::string{comment}]() {
+	g_dispatcher.addTask([playerID = player->getID(), assertLine = std::move(assertLine), date = std::move(date),
+	                      description = std::move(description), comment = std::move(comment)]() {
 		g_game.playerDebugAssert(playerID, assertLine, date, description, comment);
 	});
 }
@@ -1775,6 +1863,18 @@ void ProtocolGame::sendBasicData()
 
 void ProtocolGame::sendTextMessage(const TextMessage& message)
 {
+	switch (message.type) {
+		case MESSAGE_DAMAGE_OTHERS:
+		case MESSAGE_HEALED_OTHERS:
+		case MESSAGE_EXPERIENCE_OTHERS:
+			if (skipUpdate()) {
+				return;
+			}
+			break;
+		default:
+			break;
+	}
+
 	NetworkMessage msg;
 	msg.addByte(0xB4);
 	msg.addByte(message.type);
@@ -2396,37 +2496,63 @@ void ProtocolGame::sendCloseContainer(uint8_t cid)
 	writeToOutputBuffer(msg);
 }
 
-void ProtocolGame::sendCreatureTurn(const Creature* creature, uint32_t stackpos)
+void ProtocolGame::sendCreatureTurn(const Creature* creature, uint32_t stackpos, CreatureTurnPackets& packets)
 {
 	if (!canSee(creature)) {
 		return;
 	}
 
-	NetworkMessage msg;
-	msg.addByte(0x6B);
+	// every stack position past the last one is sent as the creature id
+	stackpos = std::min<uint32_t>(stackpos, MAX_STACKPOS);
+	const bool walkthrough = player->canWalkthroughEx(creature);
+
+	auto [it, inserted] = packets.try_emplace(static_cast<uint16_t>(stackpos << 1 | walkthrough));
+	EncodedCreatureTurn& packet = it->second;
+	auto out = getOutputBuffer(packet.bytes.size());
+	if (!inserted) {
+		out->addBytes(reinterpret_cast<const char*>(packet.bytes.data()), packet.length);
+		return;
+	}
+
+	const auto start = out->getBufferPosition();
+	out->addByte(0x6B);
 	if (stackpos >= MAX_STACKPOS) {
-		msg.add<uint16_t>(0xFFFF);
-		msg.add<uint32_t>(creature->getID());
+		out->add<uint16_t>(0xFFFF);
+		out->add<uint32_t>(creature->getID());
 	} else {
-		msg.addPosition(creature->getPosition());
-		msg.addByte(stackpos);
+		out->addPosition(creature->getPosition());
+		out->addByte(stackpos);
 	}
 
-	msg.add<uint16_t>(0x63);
-	msg.add<uint32_t>(creature->getID());
-	msg.addByte(creature->getDirection());
-	msg.addByte(player->canWalkthroughEx(creature) ? 0x00 : 0x01);
-	writeToOutputBuffer(msg);
+	out->add<uint16_t>(0x63);
+	out->add<uint32_t>(creature->getID());
+	out->addByte(creature->getDirection());
+	out->addByte(walkthrough ? 0x00 : 0x01);
+
+	packet.length = static_cast<uint8_t>(out->getBufferPosition() - start);
+	assert(packet.length <= packet.bytes.size());
+	std::memcpy(packet.bytes.data(), out->getBuffer() + start, packet.length);
 }
 
 void ProtocolGame::sendCreatureSay(const Creature* creature, SpeakClasses type, const std::string& text,
                                    const Position* pos /* = nullptr*/)
 {
 	NetworkMessage msg;
-	msg.addByte(0xAA);
+	encodeCreatureSay(msg, nextStatementId(), creature, type, text, pos);
+	writeToOutputBuffer(msg);
+}
 
+uint32_t ProtocolGame::nextStatementId()
+{
 	static uint32_t statementId = 0;
-	msg.add<uint32_t>(++statementId);
+	return ++statementId;
+}
+
+void ProtocolGame::encodeCreatureSay(NetworkMessage& msg, uint32_t statementId, const Creature* creature,
+                                     SpeakClasses type, const std::string& text, const Position* pos /* = nullptr*/)
+{
+	msg.addByte(0xAA);
+	msg.add<uint32_t>(statementId);
 
 	msg.addString(creature->getName());
 	msg.addByte(0x00); // "(Traded)" suffix after player name
@@ -2446,7 +2572,6 @@ void ProtocolGame::sendCreatureSay(const Creature* creature, SpeakClasses type,
 	}
 
 	msg.addString(text);
-	writeToOutputBuffer(msg);
 }
 
 void ProtocolGame::sendToChannel(const Creature* creature, SpeakClasses type, const std::string& text,
@@ -2546,7 +2671,26 @@ void ProtocolGame::sendPingBack()
 
 void ProtocolGame::sendDistanceShoot(const Position& from, const Position& to, uint8_t type)
 {
+	if (skipUpdate()) {
+		return;
+	}
+
 	NetworkMessage msg;
+	encodeDistanceShoot(msg, from, to, type);
+	writeToOutputBuffer(msg);
+}
+
+void ProtocolGame::sendDistanceShoot(const NetworkMessage& encoded)
+{
+	if (skipUpdate()) {
+		return;
+	}
+
+	writeToOutputBuffer(encoded);
+}
+
+void ProtocolGame::encodeDistanceShoot(NetworkMessage& msg, const Position& from, const Position& to, uint8_t type)
+{
 	msg.addByte(0x83);
 	msg.addPosition(from);
 	msg.addByte(MAGIC_EFFECTS_CREATE_DISTANCEEFFECT);
@@ -2554,37 +2698,90 @@ void ProtocolGame::sendDistanceShoot(const Position& from, const Position& to, u
 	msg.addByte(static_cast<uint8_t>(static_cast<int8_t>(static_cast<int32_t>(to.x) - static_cast<int32_t>(from.x))));
 	msg.addByte(static_cast<uint8_t>(static_cast<int8_t>(static_cast<int32_t>(to.y) - static_cast<int32_t>(from.y))));
 	msg.addByte(MAGIC_EFFECTS_END_LOOP);
-	writeToOutputBuffer(msg);
 }
 
 void ProtocolGame::sendMagicEffect(const Position& pos, uint8_t type)
 {
-	if (!canSee(pos)) {
+	if (!canSee(pos) || skipUpdate()) {
 		return;
 	}
 
 	NetworkMessage msg;
+	encodeMagicEffect(msg, pos, type);
+	writeToOutputBuffer(msg);
+}
+
+void ProtocolGame::sendMagicEffect(const Position& pos, const NetworkMessage& encoded)
+{
+	if (!canSee(pos) || skipUpdate()) {
+		return;
+	}
+
+	writeToOutputBuffer(encoded);
+}
+
+void ProtocolGame::encodeMagicEffect(NetworkMessage& msg, const Position& pos, uint8_t type)
+{
 	msg.addByte(0x83);
 	msg.addPosition(pos);
 	msg.addByte(MAGIC_EFFECTS_CREATE_EFFECT);
 	msg.addByte(type);
 	msg.addByte(MAGIC_EFFECTS_END_LOOP);
-	writeToOutputBuffer(msg);
 }
 
 void ProtocolGame::sendCreatureHealth(const Creature* creature)
 {
 	NetworkMessage msg;
-	msg.addByte(0x8C);
-	msg.add<uint32_t>(creature->getID());
+	encodeCreatureHealth(msg, creature);
+	sendCreatureHealth(creature, msg);
+}
 
-	if (creature->isHealthHidden()) {
-		msg.addByte(0x00);
-	} else {
-		msg.addByte(std::ceil(
-		    (static_cast<double>(creature->getHealth()) / std::max<int32_t>(creature->getMaxHealth(), 1)) * 100));
+void ProtocolGame::sendCreatureHealth(const Creature* creature, const NetworkMessage& encoded)
+{
+	if (skipUpdate()) {
+		// only the latest health of a creature matters, it is sent once the client has caught up
+		pendingHealth[creature->getID()] = getHealthPercent(creature);
+		return;
 	}
-	writeToOutputBuffer(msg);
+
+	pendingHealth.erase(creature->getID());
+	sendPendingHealth();
+	writeToOutputBuffer(encoded);
+}
+
+void ProtocolGame::sendPendingHealth()
+{
+	if (pendingHealth.empty()) {
+		return;
+	}
+
+	auto connection = getConnection();
+	if (!connection || connection->isCongested()) {
+		return;
+	}
+
+	NetworkMessage msg;
+	for (const auto& [creatureId, healthPercent] : pendingHealth) {
+		// the creature or the player may have moved out of view in the meantime
+		const Creature* creature = g_game.getCreatureByID(creatureId);
+		if (creature && knownCreatureSet.contains(creatureId) && canSee(creature->getPosition())) {
+			msg.addByte(0x8C);
+			msg.add<uint32_t>(creatureId);
+			msg.addByte(healthPercent);
+		}
+	}
+	pendingHealth.clear();
+
+	if (msg.getLength() != 0) {
+		writeToOutputBuffer(msg);
+	}
+}
+
+void ProtocolGame::encodeCreatureHealth(NetworkMessage& msg, const Creature* creature)
+{
+	msg.addByte(0x8C);
+	msg.add<uint32_t>(creature->getID());
+	msg.addByte(getHealthPercent(creature));
 }
 
 void ProtocolGame::sendFYIBox(const std::string& message)
@@ -2666,6 +2863,9 @@ void ProtocolGame::sendUpdateTileCreature(const Position& pos, uint32_t stackpos
 
 void ProtocolGame::sendRemoveTileCreature(const Creature* creature, const Position& pos, uint32_t stackpos)
 {
+	// a held back health update is outdated once the creature leaves the screen
+	pendingHealth.erase(creature->getID());
+
 	if (stackpos < MAX_STACKPOS) {
 		if (!canSee(pos)) {
 			return;
@@ -3745,7 +3945,7 @@ void ProtocolGame::parseExtendedOpcode(NetworkMessage& msg)
 	auto buffer = msg.getString();
 
 	// process additional opcodes via lua script event
-	g_dispatcher.addTask([=, playerID = player->getID(), buffer = std::string{buffer}]() {
+	g_dispatcher.addTask([=, playerID = player->getID(), buffer = std::move(buffer)]() {
 		g_game.parsePlayerExtendedOpcode(playerID, opcode, buffer);
 	});
 }
@@ -10,6 +10,7 @@
 #include "tasks.h"
 
 class Container;
+class Database;
 class Game;
 class NetworkMessage;
 class Player;
@@ -26,6 +27,18 @@ enum SessionEndTypes_t : uint8_t
 
 using ProtocolGame_ptr = std::shared_ptr<ProtocolGame>;
 
+// the bytes of a creature turn packet, copied into the output message of every spectator that sees the same packet
+struct EncodedCreatureTurn
+{
+	// opcode, position and stack position or creature id, then the turn itself
+	std::array<uint8_t, 15> bytes;
+	uint8_t length = 0;
+};
+
+// encodings of one creature turn, spectators only see a different packet when their stack position of the creature or
+// whether they can walk through it differs
+using CreatureTurnPackets = std::map<uint16_t, EncodedCreatureTurn>;
+
 extern Game g_game;
 
 struct TextMessage
@@ -69,11 +82,39 @@ public:
 
 	uint16_t getVersion() const { return version; }
 
+	// Packets that are the same for every spectator are encoded once by Game and the bytes are appended to the output
+	// buffer of each spectator as they are.
+	static uint32_t nextStatementId();
+	static void encodeCreatureSay(NetworkMessage& msg, uint32_t statementId, const Creature* creature,
+	                              SpeakClasses type, const std::string& text, const Position* pos = nullptr);
+	static void encodeCreatureHealth(NetworkMessage& msg, const Creature* creature);
+	static void encodeDistanceShoot(NetworkMessage& msg, const Position& from, const Position& to, uint8_t type);
+	static void encodeMagicEffect(NetworkMessage& msg, const Position& pos, uint8_t type);
+
 private:
+	// outcome of the checks of a login packet, applied on the strand of the connection
+	struct AuthResult
+	{
+		OperatingSystem_t operatingSystem;
+		// the packet could not be decrypted, the connection is dropped without an answer
+		bool decrypted = false;
+		// dropped after the xtea key is set up, for a failed challenge
+		bool drop = false;
+		std::string error;
+		xtea::key key;
+		uint32_t characterId = 0;
+		uint32_t accountId = 0;
+	};
+
 	ProtocolGame_ptr getThis() { return std::static_pointer_cast<ProtocolGame>(shared_from_this()); }
+	// auth worker, nothing here touches the protocol state, the result is posted back to the connection
+	void authenticate(NetworkMessage& msg, OperatingSystem_t operatingSystem, Database& db);
+	void onAuthenticated(const AuthResult& result);
 	void connect(uint32_t playerId, OperatingSystem_t operatingSystem);
 	void disconnectClient(const std::string& message) const;
 	void writeToOutputBuffer(const NetworkMessage& msg);
+	// effects and the damage numbers of others are left out while the client falls behind, health bars are held back
+	bool skipUpdate();
 
 	void release() override;
 
@@ -84,8 +125,8 @@ private:
 	bool canSee(const Position& pos) const;
 
 	// we have all the parse methods
-	void parsePacket(NetworkMessage& msg) override;
-	void onRecvFirstMessage(NetworkMessage& msg) override;
+	void parsePacket(NetworkMessage_ptr& packet) override;
+	void onRecvFirstMessage(NetworkMessage_ptr& packet) override;
 	void onConnect() override;
 
 	// Parse methods
@@ -169,12 +210,17 @@ private:
 	void sendFYIBox(const std::string& message);
 
 	void sendDistanceShoot(const Position& from, const Position& to, uint8_t type);
+	void sendDistanceShoot(const NetworkMessage& encoded);
 	void sendMagicEffect(const Position& pos, uint8_t type);
+	void sendMagicEffect(const Position& pos, const NetworkMessage& encoded);
 	void sendCreatureHealth(const Creature* creature);
+	void sendCreatureHealth(const Creature* creature, const NetworkMessage& encoded);
+	// the health updates that were held back while the connection was congested
+	void sendPendingHealth();
 	void sendSkills();
 	void sendPing();
 	void sendPingBack();
-	void sendCreatureTurn(const Creature* creature, uint32_t stackpos);
+	void sendCreatureTurn(const Creature* creature, uint32_t stackpos, CreatureTurnPackets& packets);
 	void sendCreatureSay(const Creature* creature, SpeakClasses type, const std::string& text,
 	                     const Position* pos = nullptr);
 
@@ -313,6 +359,8 @@ private:
 	friend class Player;
 
 	std::unordered_set<uint32_t> knownCreatureSet;
+	// latest health percent by creature id, of the updates that came in while the connection was congested
+	std::map<uint32_t, uint8_t> pendingHealth;
 	Player* player = nullptr;
 
 	uint32_t eventConnect = 0;
@@ -13,6 +13,7 @@
 
 extern Game g_game;
 
+std::mutex ProtocolStatus::ipConnectMapLock;
 std::map<Connection::Address, int64_t> ProtocolStatus::ipConnectMap;
 const uint64_t ProtocolStatus::start = OTSYS_TIME();
 
@@ -28,26 +29,31 @@ enum RequestedInfo_t : uint16_t
 	REQUEST_SERVER_SOFTWARE_INFO = 1 << 7,
 };
 
-void ProtocolStatus::onRecvFirstMessage(NetworkMessage& msg)
+void ProtocolStatus::onRecvFirstMessage(NetworkMessage_ptr& packet)
 {
+	NetworkMessage& msg = *packet;
 	const static auto acceptorAddress = boost::asio::ip::make_address(getString(ConfigManager::IP));
 
 	const auto& ip = getIP();
 
-	if (!ip.is_loopback() && ip != acceptorAddress) {
-		if (auto it = ipConnectMap.find(ip);
-		    it != ipConnectMap.end() && (OTSYS_TIME() < (it->second + getNumber(ConfigManager::STATUSQUERY_TIMEOUT)))) {
-			disconnect();
-			return;
+	{
+		std::lock_guard<std::mutex> lockClass(ipConnectMapLock);
+		if (!ip.is_loopback() && ip != acceptorAddress) {
+			auto it = ipConnectMap.find(ip);
+			if (it != ipConnectMap.end() &&
+			    (OTSYS_TIME() < (it->second + getNumber(ConfigManager::STATUSQUERY_TIMEOUT)))) {
+				disconnect();
+				return;
+			}
 		}
-	}
 
-	ipConnectMap[ip] = OTSYS_TIME();
+		ipConnectMap[ip] = OTSYS_TIME();
+	}
 
 	switch (msg.getByte()) {
 		// XML info protocol
 		case 0xFF: {
-			if (msg.getString(4) == "info") {
+			if (msg.getStringView(4) == "info") {
 				g_dispatcher.addTask([thisPtr = std::static_pointer_cast<ProtocolStatus>(shared_from_this())]() {
 					thisPtr->sendStatusString();
 				});
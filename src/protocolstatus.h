@@ -28,7 +28,7 @@ public:
 
 	explicit ProtocolStatus(Connection_ptr connection) : Protocol(connection) {}
 
-	void onRecvFirstMessage(NetworkMessage& msg) override;
+	void onRecvFirstMessage(NetworkMessage_ptr& packet) override;
 
 	void sendStatusString();
 	void sendInfo(uint16_t requestedInfo, const std::string& characterName);
@@ -36,6 +36,8 @@ public:
 	static const uint64_t start;
 
 private:
+	// status requests are read on every network thread
+	static std::mutex ipConnectMapLock;
 	static std::map<Connection::Address, int64_t> ipConnectMap;
 };
 
@@ -5,6 +5,7 @@
 
 #include "rsa.h"
 
+#include <openssl/core_names.h>
 #include <openssl/err.h>
 #include <openssl/pem.h>
 #include <openssl/rsa.h>
@@ -22,6 +23,37 @@ template <class T>
 using C_ptr = std::unique_ptr<T, Deleter>;
 
 C_ptr<EVP_PKEY> pkey = nullptr;
+// bumped by loadPEM, the threads set up their context again for the new key
+std::atomic<uint32_t> keyGeneration{0};
+
+// Creating a context fetches the RSA implementation from the provider store under a lock that every thread shares, with
+// several threads decrypting at once they queue up on it. Every thread keeps a context that is ready to decrypt and
+// reuses it for every login.
+struct ThreadContext
+{
+	uint32_t generation = 0;
+	C_ptr<EVP_PKEY_CTX> ctx;
+};
+
+thread_local ThreadContext threadContext;
+
+EVP_PKEY_CTX* getThreadContext()
+{
+	const uint32_t generation = keyGeneration.load(std::memory_order_acquire);
+	if (threadContext.ctx && threadContext.generation == generation) {
+		return threadContext.ctx.get();
+	}
+
+	C_ptr<EVP_PKEY_CTX> ctx{EVP_PKEY_CTX_new_from_pkey(nullptr, pkey.get(), nullptr)};
+	if (!ctx || EVP_PKEY_decrypt_init(ctx.get()) <= 0 ||
+	    EVP_PKEY_CTX_set_rsa_padding(ctx.get(), RSA_NO_PADDING) <= 0) {
+		threadContext = {};
+		return nullptr;
+	}
+
+	threadContext = {generation, std::move(ctx)};
+	return threadContext.ctx.get();
+}
 
 } // namespace
 
@@ -29,11 +61,9 @@ namespace tfs::rsa {
 
 void decrypt(uint8_t* msg, size_t len)
 {
-	C_ptr<EVP_PKEY_CTX> pctx{EVP_PKEY_CTX_new_from_pkey(nullptr, pkey.get(), nullptr)};
-	EVP_PKEY_decrypt_init(pctx.get());
-	EVP_PKEY_CTX_set_rsa_padding(pctx.get(), RSA_NO_PADDING);
-
-	EVP_PKEY_decrypt(pctx.get(), msg, &len, msg, len);
+	if (auto ctx = getThreadContext()) {
+		EVP_PKEY_decrypt(ctx, msg, &len, msg, len);
+	}
 }
 
 EVP_PKEY* loadPEM(std::string_view pem)
@@ -50,7 +80,17 @@ EVP_PKEY* loadPEM(std::string_view pem)
 		    fmt::format("Error while reading private key: {}", ERR_error_string(ERR_get_error(), nullptr)));
 	}
 
+	// the prime factors let OpenSSL decrypt with two half-size exponentiations (CRT), without them every login costs
+	// a full exponentiation with d
+	BIGNUM* factor = nullptr;
+	if (!EVP_PKEY_get_bn_param(pkey_, OSSL_PKEY_PARAM_RSA_FACTOR1, &factor)) {
+		std::cout << "[Warning - tfs::rsa::loadPEM] The private key has no CRT parameters, logins will be slow."
+		          << std::endl;
+	}
+	BN_clear_free(factor);
+
 	pkey.reset(pkey_);
+	keyGeneration.fetch_add(1, std::memory_order_release);
 	return pkey_;
 }
 
@@ -9,7 +9,9 @@ typedef struct evp_pkey_st EVP_PKEY;
 
 namespace tfs::rsa {
 
+// replaces the server key, must not run while other threads decrypt
 EVP_PKEY* loadPEM(std::string_view pem);
+// any thread, decrypts in place with a context that the calling thread keeps for the next call
 void decrypt(uint8_t* msg, size_t len);
 
 } // namespace tfs::rsa
@@ -0,0 +1,116 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_SAVEDROWS_H
+#define FS_SAVEDROWS_H
+
+// Rows of a player table as the database holds them, keyed by the primary key of the table. Comparing them with the
+// current rows tells the next save which rows it has to write and which ones it has to delete.
+//
+// The rows of a save only count as saved once the write is confirmed. Until then they are pending, and the database
+// may hold the confirmed rows or the rows of any pending save, so the changes of a new save are computed against all
+// of them. Whichever of the earlier writes fail, a write that succeeds leaves exactly its rows in the table. While the
+// saved rows are unknown, before the first save, the whole table is rewritten.
+template <typename Key, typename Value = std::monostate>
+class SavedRows
+{
+public:
+	using Rows = std::map<Key, Value>;
+
+	struct Changes
+	{
+		// the whole table has to be deleted first, the upserts hold every row then
+		bool rewrite = false;
+		std::vector<std::pair<Key, Value>> upserts;
+		std::vector<Key> removals;
+
+		bool empty() const { return !rewrite && upserts.empty() && removals.empty(); }
+	};
+
+	// the database holds exactly these rows, right after they were loaded
+	void reset(Rows rows)
+	{
+		savedRows = std::move(rows);
+		known = true;
+		pending.clear();
+	}
+
+	size_t getPendingCount() const { return pending.size(); }
+
+	// Returns what has to be written to bring the table to the current rows, from the confirmed rows as well as from
+	// the rows of every pending save. The current rows stay pending under the given save id until confirm is called.
+	Changes update(Rows current, uint32_t saveId, bool rewrite = false)
+	{
+		Changes changes;
+		if (rewrite || !known) {
+			changes.rewrite = true;
+			changes.upserts.assign(current.begin(), current.end());
+		} else {
+			std::set<Key> removed;
+			collectChanges(savedRows, current, changes.upserts, removed);
+			for (const auto& [id, rows] : pending) {
+				collectChanges(rows, current, changes.upserts, removed);
+			}
+
+			// every candidate adds the rows it disagrees on, keep each one once and in key order
+			std::sort(changes.upserts.begin(), changes.upserts.end(),
+			          [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+			changes.upserts.erase(std::unique(changes.upserts.begin(), changes.upserts.end(),
+			                                  [](const auto& lhs, const auto& rhs) { return lhs.first == rhs.first; }),
+			                      changes.upserts.end());
+			changes.removals.assign(removed.begin(), removed.end());
+		}
+
+		pending.emplace_back(saveId, std::move(current));
+		return changes;
+	}
+
+	// The write of the given save finished. The saves before it have finished too, or were never written at all, so
+	// their rows are dropped. The rows of the save become the saved rows if it was written.
+	void confirm(uint32_t saveId, bool written)
+	{
+		auto it = std::find_if(pending.begin(), pending.end(),
+		                       [saveId](const auto& save) { return save.first == saveId; });
+		if (it == pending.end()) {
+			return;
+		}
+
+		if (written) {
+			savedRows = std::move(it->second);
+			known = true;
+		}
+		pending.erase(pending.begin(), std::next(it));
+	}
+
+private:
+	// adds the current rows that differ from the candidate and the candidate keys that are gone
+	static void collectChanges(const Rows& candidate, const Rows& current, std::vector<std::pair<Key, Value>>& upserts,
+	                           std::set<Key>& removed)
+	{
+		auto saved = candidate.begin();
+		auto it = current.begin();
+		while (saved != candidate.end() || it != current.end()) {
+			if (it == current.end() || (saved != candidate.end() && saved->first < it->first)) {
+				removed.insert(saved->first);
+				++saved;
+			} else if (saved == candidate.end() || it->first < saved->first) {
+				upserts.push_back(*it);
+				++it;
+			} else {
+				if (saved->second != it->second) {
+					upserts.push_back(*it);
+				}
+				++saved;
+				++it;
+			}
+		}
+	}
+
+	Rows savedRows;
+	bool known = false;
+
+	// rows of the saves that were handed out but not confirmed yet, in save order
+	std::deque<std::pair<uint32_t, Rows>> pending;
+};
+
+#endif // FS_SAVEDROWS_H
@@ -5,6 +5,21 @@
 
 #include "scheduler.h"
 
+void TimerWheel::clear()
+{
+	std::vector<SchedulerTask*> tasks;
+	wheel.clear(tasks);
+	for (SchedulerTask* task : tasks) {
+		delete task;
+	}
+}
+
+uint64_t Scheduler::getCurrentTick() const
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime)
+	    .count();
+}
+
 uint32_t Scheduler::addEvent(SchedulerTask* task)
 {
 	// check if the event has a valid id
@@ -13,22 +28,24 @@ uint32_t Scheduler::addEvent(SchedulerTask* task)
 	}
 
 	boost::asio::post(io_context, [this, task]() {
-		// insert the event id in the list of active events
-		auto it = eventIdTimerMap.emplace(task->getEventId(), boost::asio::steady_timer{io_context});
-		auto& timer = it.first->second;
+		if (getState() == THREAD_STATE_TERMINATED) {
+			delete task;
+			return;
+		}
 
-		timer.expires_after(std::chrono::milliseconds(task->getDelay()));
-		timer.async_wait([this, task](const boost::system::error_code& error) {
-			eventIdTimerMap.erase(task->getEventId());
+		const uint64_t now = getCurrentTick();
+		if (wheel.empty()) {
+			// an empty wheel may lag behind, catch up so the new task does not land in the upper levels
+			wheel.advance(now, expiredTasks);
+		}
 
-			if (error == boost::asio::error::operation_aborted || getState() == THREAD_STATE_TERMINATED) {
-				// the timer has been manually canceled(timer->cancel()) or Scheduler::shutdown has been called
-				delete task;
-				return;
-			}
+		// insert the event id in the list of active events
+		eventIdTaskMap.emplace(task->getEventId(), task);
+		wheel.insert(task, now + task->getDelay());
 
-			g_dispatcher.addTask(task);
-		});
+		if (now + task->getDelay() < armedTick) {
+			armTimer();
+		}
 	});
 
 	return task->getEventId();
@@ -42,10 +59,15 @@ void Scheduler::stopEvent(uint32_t eventId)
 
 	boost::asio::post(io_context, [this, eventId]() {
 		// search the event id
-		auto it = eventIdTimerMap.find(eventId);
-		if (it != eventIdTimerMap.end()) {
-			it->second.cancel();
+		auto it = eventIdTaskMap.find(eventId);
+		if (it == eventIdTaskMap.end()) {
+			return;
 		}
+
+		SchedulerTask* task = it->second;
+		eventIdTaskMap.erase(it);
+		wheel.remove(task);
+		delete task;
 	});
 }
 
@@ -53,13 +75,69 @@ void Scheduler::shutdown()
 {
 	setState(THREAD_STATE_TERMINATED);
 	boost::asio::post(io_context, [this]() {
-		// cancel all active timers
-		for (auto& it : eventIdTimerMap) {
-			it.second.cancel();
-		}
+		// delete all pending tasks
+		timer.cancel();
+		eventIdTaskMap.clear();
+		wheel.clear();
 
 		io_context.stop();
 	});
 }
 
+void Scheduler::armTimer()
+{
+	auto timeout = wheel.getNextTimeout();
+	if (!timeout) {
+		armedTick = std::numeric_limits<uint64_t>::max();
+		timer.cancel();
+		return;
+	}
+
+	const uint64_t tick = wheel.getCurrentTick() + *timeout;
+	if (tick == armedTick) {
+		return;
+	}
+
+	armedTick = tick;
+	timer.expires_at(startTime + std::chrono::milliseconds(tick));
+	timer.async_wait([this](const boost::system::error_code& error) { onTimer(error); });
+}
+
+void Scheduler::onTimer(const boost::system::error_code& error)
+{
+	if (error == boost::asio::error::operation_aborted || getState() == THREAD_STATE_TERMINATED) {
+		// the timer has been re-armed for an earlier tick or Scheduler::shutdown has been called
+		return;
+	}
+
+	armedTick = std::numeric_limits<uint64_t>::max();
+	wheel.advance(getCurrentTick(), expiredTasks);
+
+	if (!expiredTasks.empty()) {
+		for (SchedulerTask* task : expiredTasks) {
+			eventIdTaskMap.erase(task->getEventId());
+		}
+
+		if (expiredTasks.size() == 1) {
+			g_dispatcher.addTask(expiredTasks.front());
+		} else {
+			// everything that expired within this wakeup is executed as a single dispatcher task
+			auto tasks = std::make_shared<std::vector<std::unique_ptr<SchedulerTask>>>();
+			tasks->reserve(expiredTasks.size());
+			for (SchedulerTask* task : expiredTasks) {
+				tasks->emplace_back(task);
+			}
+
+			g_dispatcher.addTask([tasks]() {
+				for (auto& task : *tasks) {
+					(*task)();
+				}
+			});
+		}
+		expiredTasks.clear();
+	}
+
+	armTimer();
+}
+
 SchedulerTask* createSchedulerTask(uint32_t delay, TaskFunc&& f) { return new SchedulerTask(delay, std::move(f)); }
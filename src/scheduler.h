@@ -4,6 +4,7 @@
 #ifndef FS_SCHEDULER_H
 #define FS_SCHEDULER_H
 
+#include "deadlinewheel.h"
 #include "tasks.h"
 #include "thread_holder_base.h"
 
@@ -23,11 +24,49 @@ private:
 	uint32_t eventId = 0;
 	uint32_t delay = 0;
 
+	// entry in the timing wheel, only touched by the scheduler thread
+	DeadlineWheelEntry wheelEntry;
+
+	friend class TimerWheel;
 	friend SchedulerTask* createSchedulerTask(uint32_t, TaskFunc&&);
 };
 
 SchedulerTask* createSchedulerTask(uint32_t delay, TaskFunc&& f);
 
+// Timing wheel of the scheduler with a resolution of one millisecond per tick. Every task keeps its own wheel entry, so
+// stopping an event removes it in constant time.
+class TimerWheel
+{
+public:
+	static constexpr uint32_t NEAR_SIZE = DeadlineWheel<SchedulerTask*>::NEAR_SIZE;
+
+	TimerWheel() = default;
+	~TimerWheel() { clear(); }
+
+	// non-copyable
+	TimerWheel(const TimerWheel&) = delete;
+	TimerWheel& operator=(const TimerWheel&) = delete;
+
+	void insert(SchedulerTask* task, uint64_t deadline) { task->wheelEntry = wheel.insert(task, deadline); }
+	void remove(SchedulerTask* task) { wheel.remove(task->wheelEntry, task); }
+
+	// advances the wheel to the given tick and appends every expired task to the list, in expiration order
+	void advance(uint64_t tick, std::vector<SchedulerTask*>& expired) { wheel.advance(tick, expired); }
+
+	// number of ticks until the wheel has to be advanced again, nothing if the wheel is empty
+	std::optional<uint64_t> getNextTimeout() const { return wheel.getNextTimeout(); }
+
+	// deletes all pending tasks
+	void clear();
+
+	uint64_t getCurrentTick() const { return wheel.getCurrentTick(); }
+	size_t size() const { return wheel.size(); }
+	bool empty() const { return wheel.empty(); }
+
+private:
+	DeadlineWheel<SchedulerTask*> wheel;
+};
+
 class Scheduler : public ThreadHolder<Scheduler>
 {
 public:
@@ -39,10 +78,21 @@ public:
 	void threadMain() { io_context.run(); }
 
 private:
+	uint64_t getCurrentTick() const;
+	void armTimer();
+	void onTimer(const boost::system::error_code& error);
+
+	const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
 	std::atomic<uint32_t> lastEventId{0};
-	std::unordered_map<uint32_t, boost::asio::steady_timer> eventIdTimerMap;
+	std::unordered_map<uint32_t, SchedulerTask*> eventIdTaskMap;
+	TimerWheel wheel;
+	std::vector<SchedulerTask*> expiredTasks;
+	uint64_t armedTick = std::numeric_limits<uint64_t>::max();
+
 	boost::asio::io_context io_context;
 	boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work{io_context.get_executor()};
+	boost::asio::steady_timer timer{io_context};
 };
 
 extern Scheduler g_scheduler;
@@ -76,11 +76,21 @@ ServiceManager::~ServiceManager() { stop(); }
 
 void ServiceManager::die() { io_context.stop(); }
 
+void ServiceManager::startConnectionContexts()
+{
+	if (connectionContexts.size() == 0) {
+		connectionContexts.start(std::max<int32_t>(getNumber(ConfigManager::NETWORK_THREADS), 1));
+	}
+}
+
 void ServiceManager::run()
 {
 	assert(!running);
 	running = true;
+
+	startConnectionContexts();
 	io_context.run();
+	connectionContexts.stop();
 }
 
 void ServiceManager::stop()
@@ -130,7 +140,8 @@ void ServicePort::accept()
 		return;
 	}
 
-	auto connection = ConnectionManager::getInstance().createConnection(io_context, shared_from_this());
+	auto connection =
+	    ConnectionManager::getInstance().createConnection(connectionContexts.next(), shared_from_this());
 	acceptor->async_accept(connection->getSocket(),
 	                       [=, thisPtr = shared_from_this()](const boost::system::error_code& error) {
 		                       thisPtr->onAccept(connection, error);
@@ -144,13 +155,21 @@ void ServicePort::onAccept(Connection_ptr connection, const boost::system::error
 			return;
 		}
 
-		const auto& remote_ip = connection->getIP();
-		if (acceptConnection(remote_ip)) {
+		// nothing else uses the socket yet, the address is set before any other thread can read it
+		boost::system::error_code endpointError;
+		if (auto endpoint = connection->socket.remote_endpoint(endpointError); !endpointError) {
+			connection->remoteAddress = endpoint.address();
+		}
+
+		if (acceptConnection(connection->getIP())) {
+			// from here on the connection is only handled on the strand of its network thread
 			Service_ptr service = services.front();
 			if (service->is_single_socket()) {
-				connection->accept(service->make_protocol(connection));
+				boost::asio::post(connection->strand, [connection, protocol = service->make_protocol(connection)]() {
+					connection->accept(protocol);
+				});
 			} else {
-				connection->accept();
+				boost::asio::post(connection->strand, [connection]() { connection->accept(); });
 			}
 		} else {
 			connection->close(Connection::FORCE_CLOSE);
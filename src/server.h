@@ -5,6 +5,7 @@
 #define FS_SERVER_H
 
 #include "connection.h"
+#include "iocontextpool.h"
 #include "signals.h"
 
 class ServiceBase
@@ -35,7 +36,9 @@ public:
 class ServicePort : public std::enable_shared_from_this<ServicePort>
 {
 public:
-	explicit ServicePort(boost::asio::io_context& io_context) : io_context(io_context) {}
+	ServicePort(boost::asio::io_context& io_context, IoContextPool& connectionContexts) :
+	    io_context(io_context), connectionContexts(connectionContexts)
+	{}
 	~ServicePort();
 
 	// non-copyable
@@ -57,6 +60,7 @@ private:
 	void accept();
 
 	boost::asio::io_context& io_context;
+	IoContextPool& connectionContexts;
 	std::unique_ptr<boost::asio::ip::tcp::acceptor> acceptor;
 	std::vector<Service_ptr> services;
 
@@ -84,10 +88,14 @@ public:
 
 private:
 	void die();
+	// the network threads are started with the first service, its acceptor already hands out their io_contexts
+	void startConnectionContexts();
 
 	std::unordered_map<uint16_t, ServicePort_ptr> acceptors;
 
+	// accepts the connections and handles the signals, the connections themselves run on the network threads
 	boost::asio::io_context io_context;
+	IoContextPool connectionContexts;
 	Signals signals{io_context};
 	boost::asio::steady_timer death_timer{io_context};
 	bool running = false;
@@ -107,7 +115,8 @@ bool ServiceManager::add(uint16_t port)
 	auto foundServicePort = acceptors.find(port);
 
 	if (foundServicePort == acceptors.end()) {
-		service_port = std::make_shared<ServicePort>(io_context);
+		startConnectionContexts();
+		service_port = std::make_shared<ServicePort>(io_context, connectionContexts);
 		service_port->open(port);
 		acceptors[port] = service_port;
 	} else {
@@ -47,7 +47,11 @@ void sigusr1Handler()
 	// Dispatcher thread
 	std::cout << "SIGUSR1 received, saving the game state..." << std::endl;
 	g_globalEvents->save();
-	g_game.saveGameState();
+	if (getBoolean(ConfigManager::WORLD_SAVE_ASYNC)) {
+		g_game.startWorldSave();
+	} else {
+		g_game.saveGameState();
+	}
 }
 
 void sighupHandler()
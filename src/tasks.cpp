@@ -7,9 +7,40 @@
 
 #include "enums.h"
 #include "game.h"
+#include "protocol.h"
 
 extern Game g_game;
 
+namespace {
+
+// large enough for both Task and SchedulerTask
+constexpr size_t TASK_BLOCK_SIZE = 192;
+constexpr size_t TASK_FREE_LIST_CAPACITY = 4096;
+
+using TaskFreeList = LockfreeFreeList<TASK_BLOCK_SIZE, TASK_FREE_LIST_CAPACITY>;
+
+} // namespace
+
+void* Task::operator new(size_t size)
+{
+	if (size > TASK_BLOCK_SIZE) {
+		return ::operator new(size);
+	}
+
+	void* p;
+	if (!TaskFreeList::get().pop(p)) {
+		p = ::operator new(TASK_BLOCK_SIZE);
+	}
+	return p;
+}
+
+void Task::operator delete(void* p, size_t size)
+{
+	if (size > TASK_BLOCK_SIZE || !TaskFreeList::get().bounded_push(p)) {
+		::operator delete(p);
+	}
+}
+
 Task* createTask(TaskFunc&& f) { return new Task(std::move(f)); }
 
 Task* createTask(uint32_t expiration, TaskFunc&& f) { return new Task(expiration, std::move(f)); }
@@ -17,18 +48,43 @@ Task* createTask(uint32_t expiration, TaskFunc&& f) { return new Task(expiration
 void Dispatcher::threadMain()
 {
 	std::vector<Task*> tmpTaskList;
-	// NOTE: second argument defer_lock is to prevent from immediate locking
-	std::unique_lock<std::mutex> taskLockUnique(taskLock, std::defer_lock);
 
 	while (getState() != THREAD_STATE_TERMINATED) {
-		// check if there are tasks waiting
-		taskLockUnique.lock();
-		if (taskList.empty()) {
-			// if the list is empty wait for signal
-			taskSignal.wait(taskLockUnique);
+		// take everything that has been queued so far
+		while (Task* task = taskQueue.pop()) {
+			tmpTaskList.push_back(task);
+		}
+
+		if (tmpTaskList.empty()) {
+			// announce that we are going to sleep, then check the queue once more so a concurrent addTask is either
+			// seen here or sees us sleeping
+			sleeping.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			if (Task* task = taskQueue.pop()) {
+				sleeping.store(false, std::memory_order_relaxed);
+				tmpTaskList.push_back(task);
+			} else {
+				sleeping.wait(true);
+				continue;
+			}
+		}
+
+		queueDepth.fetch_sub(static_cast<uint32_t>(tmpTaskList.size()), std::memory_order_relaxed);
+
+		const auto now = std::chrono::steady_clock::now();
+		int64_t maxWait = 0;
+		uint64_t batchWait = 0;
+		for (Task* task : tmpTaskList) {
+			const auto wait = std::chrono::duration_cast<std::chrono::microseconds>(now - task->enqueueTime).count();
+			maxWait = std::max<int64_t>(maxWait, wait);
+			batchWait += wait;
 		}
-		tmpTaskList.swap(taskList);
-		taskLockUnique.unlock();
+
+		lastBatchSize.store(static_cast<uint32_t>(tmpTaskList.size()), std::memory_order_relaxed);
+		lastBatchMaxWait.store(maxWait, std::memory_order_relaxed);
+		totalWaitTime.fetch_add(batchWait, std::memory_order_relaxed);
+		executedTasks.fetch_add(tmpTaskList.size(), std::memory_order_relaxed);
 
 		for (Task* task : tmpTaskList) {
 			if (!task->hasExpired()) {
@@ -39,39 +95,49 @@ void Dispatcher::threadMain()
 			delete task;
 		}
 		tmpTaskList.clear();
+
+		// whatever the batch wrote to the clients goes out right away instead of waiting for a timer
+		Protocol::sendAutosendMessages();
 	}
 }
 
 void Dispatcher::addTask(Task* task)
 {
-	bool do_signal = false;
-
-	taskLock.lock();
-
-	if (getState() == THREAD_STATE_RUNNING) {
-		do_signal = taskList.empty();
-		taskList.push_back(task);
-	} else {
+	if (getState() != THREAD_STATE_RUNNING) {
 		delete task;
+		return;
 	}
 
-	taskLock.unlock();
+	task->enqueueTime = std::chrono::steady_clock::now();
+	queueDepth.fetch_add(1, std::memory_order_relaxed);
+	taskQueue.push(task);
+	signal();
+}
 
-	// send a signal if the list was empty
-	if (do_signal) {
-		taskSignal.notify_one();
+void Dispatcher::signal()
+{
+	// pairs with the fence in threadMain, only wake the dispatcher thread up if it is actually sleeping
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (sleeping.load(std::memory_order_relaxed) && sleeping.exchange(false, std::memory_order_relaxed)) {
+		sleeping.notify_one();
 	}
 }
 
 void Dispatcher::shutdown()
 {
-	Task* task = createTask([this]() {
-		setState(THREAD_STATE_TERMINATED);
-		taskSignal.notify_one();
-	});
+	Task* task = createTask([this]() { setState(THREAD_STATE_TERMINATED); });
+	task->enqueueTime = std::chrono::steady_clock::now();
 
-	std::lock_guard<std::mutex> lockClass(taskLock);
-	taskList.push_back(task);
+	queueDepth.fetch_add(1, std::memory_order_relaxed);
+	taskQueue.push(task);
+	signal();
+}
 
-	taskSignal.notify_one();
+std::chrono::microseconds Dispatcher::getAverageWaitTime() const
+{
+	const uint64_t tasks = executedTasks.load(std::memory_order_relaxed);
+	if (tasks == 0) {
+		return std::chrono::microseconds::zero();
+	}
+	return std::chrono::microseconds(totalWaitTime.load(std::memory_order_relaxed) / tasks);
 }
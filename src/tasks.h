@@ -4,13 +4,113 @@
 #ifndef FS_TASKS_H
 #define FS_TASKS_H
 
+#include "lockfree.h"
 #include "thread_holder_base.h"
 
-using TaskFunc = std::function<void(void)>;
 const int DISPATCHER_TASK_EXPIRATION = 2000;
 const auto SYSTEM_TIME_ZERO = std::chrono::system_clock::time_point(std::chrono::milliseconds(0));
 
-class Task
+// Move-only replacement for std::function<void(void)>. Callables up to INLINE_SIZE bytes are stored inside the object
+// itself, so wrapping the usual lambda that captures a few ids does not allocate.
+class TaskFunc
+{
+public:
+	static constexpr size_t INLINE_SIZE = 48;
+
+	TaskFunc() = default;
+	TaskFunc(std::nullptr_t) {}
+
+	template <typename F>
+	    requires(!std::is_same_v<std::remove_cvref_t<F>, TaskFunc> && std::is_invocable_v<std::decay_t<F>&>)
+	TaskFunc(F&& f)
+	{
+		using Func = std::decay_t<F>;
+		if constexpr (sizeof(Func) <= INLINE_SIZE && alignof(Func) <= alignof(std::max_align_t) &&
+		              std::is_nothrow_move_constructible_v<Func>) {
+			new (storage) Func(std::forward<F>(f));
+			ops = &inlineOps<Func>;
+		} else {
+			new (storage) Func*(new Func(std::forward<F>(f)));
+			ops = &heapOps<Func>;
+		}
+	}
+
+	TaskFunc(TaskFunc&& other) noexcept : ops(other.ops)
+	{
+		if (ops) {
+			ops->relocate(storage, other.storage);
+			other.ops = nullptr;
+		}
+	}
+
+	TaskFunc& operator=(TaskFunc&& other) noexcept
+	{
+		if (this != &other) {
+			reset();
+			ops = other.ops;
+			if (ops) {
+				ops->relocate(storage, other.storage);
+				other.ops = nullptr;
+			}
+		}
+		return *this;
+	}
+
+	~TaskFunc() { reset(); }
+
+	void operator()() { ops->invoke(storage); }
+	explicit operator bool() const { return ops != nullptr; }
+
+private:
+	struct Ops
+	{
+		void (*invoke)(void* storage);
+		void (*relocate)(void* to, void* from);
+		void (*destroy)(void* storage);
+	};
+
+	template <typename Func>
+	static Func* getInline(void* storage)
+	{
+		return std::launder(static_cast<Func*>(storage));
+	}
+
+	template <typename Func>
+	static Func* getHeap(void* storage)
+	{
+		return *std::launder(static_cast<Func**>(storage));
+	}
+
+	template <typename Func>
+	static constexpr Ops inlineOps = {
+	    [](void* storage) { (*getInline<Func>(storage))(); },
+	    [](void* to, void* from) {
+		    new (to) Func(std::move(*getInline<Func>(from)));
+		    getInline<Func>(from)->~Func();
+	    },
+	    [](void* storage) { getInline<Func>(storage)->~Func(); },
+	};
+
+	template <typename Func>
+	static constexpr Ops heapOps = {
+	    [](void* storage) { (*getHeap<Func>(storage))(); },
+	    [](void* to, void* from) { new (to) Func*(getHeap<Func>(from)); },
+	    [](void* storage) { delete getHeap<Func>(storage); },
+	};
+
+	void reset()
+	{
+		if (ops) {
+			ops->destroy(storage);
+			ops = nullptr;
+		}
+	}
+
+	alignas(std::max_align_t) std::byte storage[INLINE_SIZE];
+	const Ops* ops = nullptr;
+};
+
+class Task : public LockfreeQueueNode
 {
 public:
 	// DO NOT allocate this class on the stack
@@ -32,6 +132,10 @@ public:
 		return expiration < std::chrono::system_clock::now();
 	}
 
+	// tasks and scheduler tasks are recycled through a lock-free free list
+	static void* operator new(size_t size);
+	static void operator delete(void* p, size_t size);
+
 protected:
 	std::chrono::system_clock::time_point expiration = SYSTEM_TIME_ZERO;
 
@@ -39,6 +143,11 @@ private:
 	// Expiration has another meaning for scheduler tasks, then it is the time the task should be added to the
 	// dispatcher
 	TaskFunc func;
+
+	// time the task was handed to the dispatcher, used for the queue wait statistics
+	std::chrono::steady_clock::time_point enqueueTime;
+
+	friend class Dispatcher;
 };
 
 Task* createTask(TaskFunc&& f);
@@ -57,13 +166,35 @@ public:
 
 	uint64_t getDispatcherCycle() const { return dispatcherCycle; }
 
+	// number of tasks waiting to be executed
+	uint32_t getQueueDepth() const { return queueDepth.load(std::memory_order_relaxed); }
+
+	// number of tasks executed by the last dispatcher batch
+	uint32_t getLastBatchSize() const { return lastBatchSize.load(std::memory_order_relaxed); }
+
+	// longest time a task of the last dispatcher batch had to wait before it was executed
+	std::chrono::microseconds getLastBatchMaxWaitTime() const
+	{
+		return std::chrono::microseconds(lastBatchMaxWait.load(std::memory_order_relaxed));
+	}
+
+	// average time a task had to wait before it was executed, over all tasks so far
+	std::chrono::microseconds getAverageWaitTime() const;
+
 	void threadMain();
 
 private:
-	std::mutex taskLock;
-	std::condition_variable taskSignal;
+	void signal();
+
+	LockfreeMPSCQueue<Task> taskQueue;
+	std::atomic<bool> sleeping{false};
+
+	std::atomic<uint32_t> queueDepth{0};
+	std::atomic<uint32_t> lastBatchSize{0};
+	std::atomic<int64_t> lastBatchMaxWait{0};
+	std::atomic<uint64_t> totalWaitTime{0};
+	std::atomic<uint64_t> executedTasks{0};
 
-	std::vector<Task*> taskList;
 	uint64_t dispatcherCycle = 0;
 };
 
@@ -0,0 +1,52 @@
+// Memory held by idle connections. The connections are created the way ServicePort creates them for accepted sockets
+// and are then left alone, which is where almost every connection of a running server spends its time: waiting for
+// the header of the next packet. Reports the size of the Connection object and everything allocated with it.
+
+#include "../otpch.h"
+
+#include "../connection.h"
+
+#include <new>
+
+namespace {
+
+constexpr size_t CONNECTION_COUNT = 2'000;
+
+std::atomic<size_t> allocatedBytes{0};
+
+} // namespace
+
+void* operator new(size_t size)
+{
+	allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+int main()
+{
+	boost::asio::io_context io_context;
+	auto& manager = ConnectionManager::getInstance();
+
+	std::vector<Connection_ptr> connections;
+	connections.reserve(CONNECTION_COUNT);
+
+	const size_t before = allocatedBytes.load(std::memory_order_relaxed);
+	for (size_t i = 0; i < CONNECTION_COUNT; ++i) {
+		connections.push_back(manager.createConnection(io_context, nullptr));
+	}
+	const size_t allocated = allocatedBytes.load(std::memory_order_relaxed) - before;
+
+	std::cout << fmt::format("sizeof(Connection): {:d} bytes\n", sizeof(Connection));
+	std::cout << fmt::format("{:d} idle connections: {:.1f} MiB, {:d} bytes per connection\n", CONNECTION_COUNT,
+	                         allocated / (1024. * 1024.), allocated / CONNECTION_COUNT);
+
+	manager.closeAll();
+	return 0;
+}
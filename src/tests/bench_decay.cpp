@@ -0,0 +1,279 @@
+// Load test for item decay with 500000 decaying items on a simulated clock. The wheel side follows Game::checkDecay:
+// every item has an absolute deadline and is only handled once that deadline has passed. The reference side walks
+// the four bucket lists the way the game did before, touching every item once per second to count its duration down.
+// A few items are paused and resumed every check, like rings that are taken off and put on again.
+
+#include "../otpch.h"
+
+#include "../deadlinewheel.h"
+#include "../game.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t ITEM_COUNT = 500'000;
+constexpr int32_t MIN_DURATION = 1'000;
+constexpr int32_t MAX_DURATION = 10 * 60 * 1000;
+constexpr size_t TOGGLES_PER_CHECK = 100;
+constexpr int64_t TOGGLE_TIME = 5 * 60 * 1000;
+constexpr int32_t REFERENCE_BUCKETS = 4;
+
+struct DecayingItem
+{
+	int32_t duration = 0;
+	int64_t deadline = 0;
+	bool canDecay = true;
+	bool decaying = false;
+	bool expired = false;
+};
+
+struct DecayStats
+{
+	double totalMs = 0;
+	double maxMs = 0;
+	size_t touched = 0;
+	size_t expired = 0;
+	int64_t maxLateness = 0;
+};
+
+// bucket lists and the countdown of the old Game::checkDecay and Game::cleanup
+class ReferenceDecay
+{
+public:
+	explicit ReferenceDecay(std::vector<DecayingItem>& items) : items(items) {}
+
+	void start(uint32_t index)
+	{
+		DecayingItem& item = items[index];
+		if (!item.decaying) {
+			item.decaying = true;
+			toDecayItems.push_front(index);
+		}
+	}
+
+	void pause(uint32_t index) { items[index].canDecay = false; }
+
+	void check(DecayStats& stats)
+	{
+		const size_t bucket = (lastBucket + 1) % REFERENCE_BUCKETS;
+
+		auto it = decayItems[bucket].begin(), end = decayItems[bucket].end();
+		while (it != end) {
+			DecayingItem& item = items[*it];
+			++stats.touched;
+
+			if (!item.canDecay) {
+				item.decaying = false;
+				it = decayItems[bucket].erase(it);
+				continue;
+			}
+
+			int32_t decreaseTime = std::min<int32_t>(EVENT_DECAYINTERVAL * REFERENCE_BUCKETS, item.duration);
+			item.duration -= decreaseTime;
+
+			if (item.duration <= 0) {
+				it = decayItems[bucket].erase(it);
+				expire(item, stats);
+			} else if (item.duration < EVENT_DECAYINTERVAL * REFERENCE_BUCKETS) {
+				size_t newBucket = (bucket + ((item.duration + EVENT_DECAYINTERVAL / 2) / 1000)) % REFERENCE_BUCKETS;
+				if (newBucket == bucket) {
+					it = decayItems[bucket].erase(it);
+					expire(item, stats);
+				} else {
+					decayItems[newBucket].splice(decayItems[newBucket].end(), decayItems[bucket], it++);
+				}
+			} else {
+				++it;
+			}
+		}
+		lastBucket = bucket;
+
+		for (uint32_t index : toDecayItems) {
+			const int32_t duration = items[index].duration;
+			if (duration >= EVENT_DECAYINTERVAL * REFERENCE_BUCKETS) {
+				decayItems[lastBucket].push_back(index);
+			} else {
+				decayItems[(lastBucket + 1 + duration / 1000) % REFERENCE_BUCKETS].push_back(index);
+			}
+		}
+		toDecayItems.clear();
+	}
+
+private:
+	static void expire(DecayingItem& item, DecayStats& stats)
+	{
+		item.decaying = false;
+		item.expired = true;
+		++stats.expired;
+	}
+
+	std::vector<DecayingItem>& items;
+	std::list<uint32_t> decayItems[REFERENCE_BUCKETS];
+	std::forward_list<uint32_t> toDecayItems;
+	size_t lastBucket = 0;
+};
+
+// absolute deadlines in a DeadlineWheel, the same bookkeeping as Item::setDecaying and Game::checkDecay
+class WheelDecay
+{
+public:
+	WheelDecay(std::vector<DecayingItem>& items, int64_t startTime) :
+	    items(items), wheel(static_cast<uint64_t>(startTime / EVENT_DECAYINTERVAL))
+	{}
+
+	void start(uint32_t index, int64_t now)
+	{
+		DecayingItem& item = items[index];
+		if (!item.decaying) {
+			item.decaying = true;
+			item.deadline = now + item.duration;
+			toDecayItems.push_front(index);
+		}
+	}
+
+	void pause(uint32_t index, int64_t now)
+	{
+		DecayingItem& item = items[index];
+		item.canDecay = false;
+		if (item.deadline != 0) {
+			item.duration = static_cast<int32_t>(std::max<int64_t>(0, item.deadline - now));
+			item.deadline = 0;
+			item.decaying = false;
+		}
+	}
+
+	void check(int64_t now, DecayStats& stats)
+	{
+		wheel.advance(now / EVENT_DECAYINTERVAL, expired);
+		for (uint32_t index : expired) {
+			DecayingItem& item = items[index];
+			++stats.touched;
+
+			if (item.deadline == 0 || item.deadline > now) {
+				continue;
+			}
+
+			stats.maxLateness = std::max(stats.maxLateness, now - item.deadline);
+			item.deadline = 0;
+			item.decaying = false;
+			if (item.canDecay) {
+				item.expired = true;
+				++stats.expired;
+			}
+		}
+		expired.clear();
+
+		for (uint32_t index : toDecayItems) {
+			if (const int64_t deadline = items[index].deadline; deadline != 0) {
+				wheel.insert(index, (deadline + EVENT_DECAYINTERVAL - 1) / EVENT_DECAYINTERVAL);
+			}
+		}
+		toDecayItems.clear();
+	}
+
+	bool empty() const { return wheel.empty() && toDecayItems.empty(); }
+
+private:
+	std::vector<DecayingItem>& items;
+	DeadlineWheel<uint32_t> wheel;
+	std::vector<uint32_t> expired;
+	std::forward_list<uint32_t> toDecayItems;
+};
+
+template <typename Check>
+void timeCheck(DecayStats& stats, Check&& check)
+{
+	auto start = Clock::now();
+	check();
+	const double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	stats.totalMs += elapsed;
+	stats.maxMs = std::max(stats.maxMs, elapsed);
+}
+
+void printStats(const char* name, const DecayStats& stats, size_t checks)
+{
+	std::cout << fmt::format("{:<10} {:9.2f} ms total, {:7.3f} ms/check, {:7.3f} ms worst, {:d} items touched, "
+	                         "{:d} expired\n",
+	                         name, stats.totalMs, stats.totalMs / checks, stats.maxMs, stats.touched, stats.expired);
+}
+
+} // namespace
+
+int main()
+{
+	std::mt19937 rng{42};
+	std::uniform_int_distribution<int32_t> durationDist{MIN_DURATION, MAX_DURATION};
+	std::uniform_int_distribution<uint32_t> indexDist{0, ITEM_COUNT - 1};
+
+	std::vector<DecayingItem> referenceItems(ITEM_COUNT);
+	for (auto& item : referenceItems) {
+		item.duration = durationDist(rng);
+	}
+	std::vector<DecayingItem> wheelItems = referenceItems;
+
+	// the simulated clock starts at a realistic OTSYS_TIME, ticks are counted from the epoch
+	const int64_t startTime = 1'700'000'000'000;
+
+	ReferenceDecay reference{referenceItems};
+	WheelDecay wheel{wheelItems, startTime};
+	for (uint32_t i = 0; i < ITEM_COUNT; ++i) {
+		reference.start(i);
+		wheel.start(i, startTime);
+	}
+
+	std::cout << fmt::format("{:d} items decaying within {:d}..{:d} s, {:d} paused or resumed per check\n",
+	                         ITEM_COUNT, MIN_DURATION / 1000, MAX_DURATION / 1000, TOGGLES_PER_CHECK);
+
+	DecayStats referenceStats, wheelStats;
+	size_t checks = 0;
+	for (int64_t now = startTime + EVENT_DECAYINTERVAL;; now += EVENT_DECAYINTERVAL) {
+		++checks;
+		if (now - startTime < TOGGLE_TIME) {
+			for (size_t i = 0; i < TOGGLES_PER_CHECK; ++i) {
+				const uint32_t index = indexDist(rng);
+				if (referenceItems[index].expired || wheelItems[index].expired) {
+					continue;
+				}
+
+				if (wheelItems[index].canDecay) {
+					reference.pause(index);
+					wheel.pause(index, now);
+				} else {
+					referenceItems[index].canDecay = true;
+					wheelItems[index].canDecay = true;
+					reference.start(index);
+					wheel.start(index, now);
+				}
+			}
+		} else if (now - startTime == TOGGLE_TIME) {
+			// resume everything that is still paused, so that every item expires in the end
+			for (uint32_t i = 0; i < ITEM_COUNT; ++i) {
+				if (!wheelItems[i].canDecay) {
+					referenceItems[i].canDecay = true;
+					wheelItems[i].canDecay = true;
+					reference.start(i);
+					wheel.start(i, now);
+				}
+			}
+		}
+
+		timeCheck(referenceStats, [&]() { reference.check(referenceStats); });
+		timeCheck(wheelStats, [&]() { wheel.check(now, wheelStats); });
+
+		if (referenceStats.expired == ITEM_COUNT && wheelStats.expired == ITEM_COUNT && wheel.empty()) {
+			break;
+		}
+
+		if (now - startTime > 4 * static_cast<int64_t>(MAX_DURATION) + TOGGLE_TIME) {
+			std::cout << "Items did not expire in time." << std::endl;
+			return 1;
+		}
+	}
+
+	std::cout << fmt::format("{:d} checks, one every {:d} ms\n", checks, EVENT_DECAYINTERVAL);
+	printStats("buckets:", referenceStats, checks);
+	printStats("wheel:", wheelStats, checks);
+	std::cout << fmt::format("wheel expired at most {:d} ms after the deadline\n", wheelStats.maxLateness);
+	return 0;
+}
@@ -0,0 +1,132 @@
+// Reading `tile_store` at startup for a world with 5,000 houses, buffered with storeQuery the way
+// IOMapSerialize::loadHouseItems used to and streamed with streamQuery. Reports the time until the first row reaches
+// the loader, the time for all rows and the peak of the heap while the rows are read. Needs the database from
+// config.lua in the working directory.
+
+#include "../otpch.h"
+
+#include "../configmanager.h"
+#include "../database.h"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t HOUSE_COUNT = 5'000;
+constexpr size_t TILES_PER_HOUSE = 24;
+// position, item count and a handful of items with their attributes
+constexpr size_t TILE_SIZE = 160;
+
+struct Result
+{
+	double firstRowMilliseconds = 0;
+	double totalMilliseconds = 0;
+	size_t peakHeapBytes = 0;
+	size_t bytes = 0;
+};
+
+size_t heapInUse()
+{
+#if defined(__GLIBC__)
+	return mallinfo2().uordblks;
+#else
+	return 0;
+#endif
+}
+
+class Reader
+{
+public:
+	Reader() : start{Clock::now()}, heapBefore{heapInUse()} {}
+
+	void visit(const DBResult& row)
+	{
+		if (result.bytes == 0) {
+			result.firstRowMilliseconds = millisecondsSinceStart();
+		}
+		result.bytes += row.getString(0).size();
+
+		// sampling the heap costs a little, every few rows is enough to see the peak
+		if (++rows % 256 == 1) {
+			if (const size_t heap = heapInUse(); heap > heapBefore) {
+				result.peakHeapBytes = std::max(result.peakHeapBytes, heap - heapBefore);
+			}
+		}
+	}
+
+	Result finish()
+	{
+		result.totalMilliseconds = millisecondsSinceStart();
+		return result;
+	}
+
+private:
+	double millisecondsSinceStart() const
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	Clock::time_point start;
+	size_t heapBefore;
+	size_t rows = 0;
+	Result result;
+};
+
+void print(std::string_view name, const Result& result)
+{
+	std::cout << fmt::format("{:>10} {:>16.2f} {:>12.2f} {:>14.1f} {:>10.1f}\n", name, result.firstRowMilliseconds,
+	                         result.totalMilliseconds, result.peakHeapBytes / (1024. * 1024.),
+	                         result.bytes / (1024. * 1024.));
+}
+
+} // namespace
+
+int main()
+{
+	Database& db = Database::getInstance();
+	if (!ConfigManager::load() || !db.connect()) {
+		std::cout << "Failed to connect to database.\n";
+		return 1;
+	}
+
+	db.executeQuery(
+	    "CREATE TEMPORARY TABLE `bench_tile_store` (`house_id` INT NOT NULL, `data` LONGBLOB NOT NULL, KEY (`house_id`))");
+
+	std::mt19937 rng{42};
+	std::string data(TILE_SIZE, '\0');
+	for (size_t house = 1; house <= HOUSE_COUNT; ++house) {
+		DBInsert insert("INSERT INTO `bench_tile_store` (`house_id`, `data`) VALUES ");
+		for (size_t tile = 0; tile < TILES_PER_HOUSE; ++tile) {
+			std::generate(data.begin(), data.end(), [&]() { return static_cast<char>(rng()); });
+			insert.addRow(fmt::format("{:d}, {:s}", house, db.escapeBlob(data.data(), data.size())));
+		}
+		insert.execute();
+	}
+
+	const std::string query = "SELECT `data` FROM `bench_tile_store`";
+
+	std::cout << fmt::format("{:d} houses, {:d} tiles:\n", HOUSE_COUNT, HOUSE_COUNT * TILES_PER_HOUSE);
+	std::cout << fmt::format("{:>10} {:>16} {:>12} {:>14} {:>10}\n", "read", "first row ms", "total ms",
+	                         "peak heap MiB", "data MiB");
+
+	{
+		Reader reader;
+		if (DBResult_ptr result = db.storeQuery(query)) {
+			do {
+				reader.visit(*result);
+			} while (result->next());
+		}
+		print("buffered", reader.finish());
+	}
+
+	{
+		Reader reader;
+		db.streamQuery(query, [&](const DBResult& row) { reader.visit(row); });
+		print("streamed", reader.finish());
+	}
+	return 0;
+}
@@ -0,0 +1,139 @@
+// Compares tile lookups through the quadtree with lookups through the flat tile grid. The tile positions are read
+// from an OTBM file (data/world/forgotten.otbm by default), only the positions are loaded, not the items.
+
+#include "../otpch.h"
+
+#include "../fileloader.h"
+#include "../iomap.h"
+#include "../map.h"
+#include "../tile.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t LOOKUP_COUNT = 10'000'000;
+
+struct MapPositions
+{
+	uint16_t width = 0;
+	uint16_t height = 0;
+	std::vector<Position> positions;
+};
+
+MapPositions readPositions(const std::string& fileName)
+{
+	OTB::Loader loader{fileName, OTB::Identifier{{'O', 'T', 'B', 'M'}}};
+	auto& root = loader.parseTree();
+
+	MapPositions result;
+
+	PropStream propStream;
+	OTBM_root_header rootHeader;
+	if (!loader.getProps(root, propStream) || !propStream.read(rootHeader) || root.children.empty()) {
+		throw std::runtime_error("Could not read map header.");
+	}
+
+	result.width = rootHeader.width;
+	result.height = rootHeader.height;
+
+	for (auto& areaNode : root.children[0].children) {
+		if (areaNode.type != OTBM_TILE_AREA) {
+			continue;
+		}
+
+		OTBM_Destination_coords areaCoords;
+		if (!loader.getProps(areaNode, propStream) || !propStream.read(areaCoords)) {
+			throw std::runtime_error("Invalid tile area.");
+		}
+
+		for (auto& tileNode : areaNode.children) {
+			OTBM_Tile_coords tileCoords;
+			if (!loader.getProps(tileNode, propStream) || !propStream.read(tileCoords)) {
+				throw std::runtime_error("Invalid tile.");
+			}
+
+			result.positions.emplace_back(areaCoords.x + tileCoords.x, areaCoords.y + tileCoords.y, areaCoords.z);
+		}
+	}
+	return result;
+}
+
+template <typename Lookup>
+void bench(const char* name, Lookup&& lookup)
+{
+	auto start = Clock::now();
+	size_t found = lookup();
+	double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	std::cout << fmt::format("{:<28} {:9.2f} ms {:7.2f} ns/lookup ({:d} tiles found)\n", name, elapsed,
+	                         elapsed * 1e6 / LOOKUP_COUNT, found);
+}
+
+void benchMap(const char* name, const Map& map, const MapPositions& mapPositions,
+              const std::vector<Position>& randomPositions)
+{
+	std::cout << name << ":\n";
+
+	bench("  random existing tiles", [&]() {
+		size_t found = 0;
+		for (size_t i = 0; i < LOOKUP_COUNT; ++i) {
+			found += map.getTile(randomPositions[i % randomPositions.size()]) != nullptr;
+		}
+		return found;
+	});
+
+	bench("  random positions", [&]() {
+		std::mt19937 rng{7};
+		size_t found = 0;
+		for (size_t i = 0; i < LOOKUP_COUNT; ++i) {
+			auto x = static_cast<uint16_t>(rng() % mapPositions.width);
+			auto y = static_cast<uint16_t>(rng() % mapPositions.height);
+			found += map.getTile(x, y, 7) != nullptr;
+		}
+		return found;
+	});
+
+	bench("  sequential rows", [&]() {
+		size_t found = 0, lookups = 0;
+		while (lookups < LOOKUP_COUNT) {
+			for (uint16_t y = 0; y < mapPositions.height && lookups < LOOKUP_COUNT; ++y) {
+				for (uint16_t x = 0; x < mapPositions.width && lookups < LOOKUP_COUNT; ++x, ++lookups) {
+					found += map.getTile(x, y, 7) != nullptr;
+				}
+			}
+		}
+		return found;
+	});
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	const std::string fileName = argc > 1 ? argv[1] : "data/world/forgotten.otbm";
+
+	MapPositions mapPositions;
+	try {
+		mapPositions = readPositions(fileName);
+	} catch (const std::exception& e) {
+		std::cout << "Failed to read " << fileName << ": " << e.what() << std::endl;
+		return 1;
+	}
+
+	std::cout << fmt::format("{:s}: {:d}x{:d}, {:d} tiles\n", fileName, mapPositions.width, mapPositions.height,
+	                         mapPositions.positions.size());
+
+	Map quadtreeMap, gridMap;
+	for (auto& pos : mapPositions.positions) {
+		quadtreeMap.setTile(pos, new StaticTile(pos.x, pos.y, pos.z));
+		gridMap.setTile(pos, new StaticTile(pos.x, pos.y, pos.z));
+	}
+	gridMap.buildTileGrid();
+
+	auto randomPositions = mapPositions.positions;
+	std::shuffle(randomPositions.begin(), randomPositions.end(), std::mt19937{42});
+
+	benchMap("quadtree", quadtreeMap, mapPositions, randomPositions);
+	benchMap("tile grid", gridMap, mapPositions, randomPositions);
+	return 0;
+}
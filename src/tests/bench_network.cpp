@@ -0,0 +1,169 @@
+// Load generator for the network threads. Client threads keep a few hundred loopback connections busy with small
+// XTEA encrypted packets, the server side reads every packet the way Connection does, a header read followed by a
+// body read on the strand of the connection, and decrypts the body like Protocol::onRecvMessage. The same load runs
+// against a growing number of io_contexts in an IoContextPool and reports the packets handled per second.
+
+#include "../otpch.h"
+
+#include "../iocontextpool.h"
+#include "../xtea.h"
+
+#include <numeric>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using boost::asio::ip::tcp;
+
+constexpr size_t CONNECTION_COUNT = 256;
+constexpr size_t CLIENT_THREADS = 4;
+constexpr uint16_t BODY_LENGTH = 4 + 64; // checksum and eight XTEA blocks, a typical walk or say packet
+constexpr size_t PACKETS_PER_WRITE = 32;
+constexpr auto RUN_TIME = std::chrono::seconds(2);
+
+const xtea::round_keys roundKeys = xtea::expand_key({0x01234567, 0x89abcdef, 0xfedcba98, 0x76543210});
+
+class ServerConnection : public std::enable_shared_from_this<ServerConnection>
+{
+public:
+	explicit ServerConnection(boost::asio::io_context& io_context) :
+	    strand(boost::asio::make_strand(io_context)), socket(strand)
+	{}
+
+	tcp::socket& getSocket() { return socket; }
+	uint64_t getPackets() const { return packets.load(std::memory_order_relaxed); }
+
+	void readHeader()
+	{
+		boost::asio::async_read(socket, boost::asio::buffer(buffer.data(), 2),
+		                        [thisPtr = shared_from_this()](const boost::system::error_code& error, size_t) {
+			                        if (!error) {
+				                        thisPtr->readBody();
+			                        }
+		                        });
+	}
+
+private:
+	void readBody()
+	{
+		uint16_t length;
+		std::memcpy(&length, buffer.data(), sizeof(length));
+		if (length == 0 || length > buffer.size()) {
+			return;
+		}
+
+		boost::asio::async_read(socket, boost::asio::buffer(buffer.data(), length),
+		                        [thisPtr = shared_from_this(), length](const boost::system::error_code& error, size_t) {
+			                        if (!error) {
+				                        xtea::decrypt(thisPtr->buffer.data() + 4, length - 4, roundKeys);
+				                        thisPtr->packets.fetch_add(1, std::memory_order_relaxed);
+				                        thisPtr->readHeader();
+			                        }
+		                        });
+	}
+
+	boost::asio::strand<boost::asio::io_context::executor_type> strand;
+	tcp::socket socket;
+	std::array<uint8_t, 1024> buffer;
+	std::atomic<uint64_t> packets{0};
+};
+
+std::string makePackets()
+{
+	std::array<uint8_t, BODY_LENGTH> body{};
+	std::iota(body.begin() + 4, body.end(), 0);
+	xtea::encrypt(body.data() + 4, BODY_LENGTH - 4, roundKeys);
+
+	std::string packets;
+	for (size_t i = 0; i < PACKETS_PER_WRITE; ++i) {
+		const uint16_t length = BODY_LENGTH;
+		packets.append(reinterpret_cast<const char*>(&length), sizeof(length));
+		packets.append(reinterpret_cast<const char*>(body.data()), body.size());
+	}
+	return packets;
+}
+
+double run(size_t threadCount)
+{
+	boost::asio::io_context acceptContext;
+	tcp::acceptor acceptor{acceptContext, tcp::endpoint{boost::asio::ip::address_v4::loopback(), 0}};
+	const auto endpoint = acceptor.local_endpoint();
+
+	IoContextPool pool;
+	pool.start(threadCount);
+
+	// connect every client first, the accepting thread hands the sockets out round-robin like ServicePort does
+	boost::asio::io_context clientContext;
+	std::vector<tcp::socket> clients;
+	std::vector<std::shared_ptr<ServerConnection>> connections;
+	for (size_t i = 0; i < CONNECTION_COUNT; ++i) {
+		auto connection = std::make_shared<ServerConnection>(pool.next());
+		auto& client = clients.emplace_back(clientContext);
+		client.connect(endpoint);
+		acceptor.accept(connection->getSocket());
+		client.set_option(tcp::no_delay{true});
+
+		boost::asio::post(connection->getSocket().get_executor(), [connection]() { connection->readHeader(); });
+		connections.push_back(std::move(connection));
+	}
+
+	const std::string packets = makePackets();
+	std::atomic<bool> stopping{false};
+
+	std::vector<std::thread> clientThreads;
+	for (size_t t = 0; t < CLIENT_THREADS; ++t) {
+		clientThreads.emplace_back([&, t]() {
+			boost::system::error_code error;
+			while (!stopping.load(std::memory_order_relaxed)) {
+				for (size_t i = t; i < clients.size(); i += CLIENT_THREADS) {
+					boost::asio::write(clients[i], boost::asio::buffer(packets), error);
+				}
+			}
+		});
+	}
+
+	auto packetCount = [&]() {
+		uint64_t count = 0;
+		for (const auto& connection : connections) {
+			count += connection->getPackets();
+		}
+		return count;
+	};
+
+	// let the connections warm up before measuring
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	const uint64_t startPackets = packetCount();
+	const auto start = Clock::now();
+	std::this_thread::sleep_for(RUN_TIME);
+	const uint64_t handled = packetCount() - startPackets;
+	const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	// the server keeps reading until the clients are done, so no client is left blocked in a write
+	stopping = true;
+	for (auto& thread : clientThreads) {
+		thread.join();
+	}
+	pool.stop();
+	return handled / seconds;
+}
+
+} // namespace
+
+int main()
+{
+	const size_t maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+	std::cout << fmt::format("{:d} connections, {:d} client threads, {:d} byte packets\n", CONNECTION_COUNT,
+	                         CLIENT_THREADS, BODY_LENGTH + 2);
+
+	double single = 0;
+	for (size_t threads = 1; threads <= std::min<size_t>(maxThreads, 16); threads *= 2) {
+		const double rate = run(threads);
+		if (threads == 1) {
+			single = rate;
+		}
+		std::cout << fmt::format("{:2d} network threads: {:12.0f} packets/s, {:5.2f}x\n", threads, rate,
+		                         rate / single);
+	}
+	return 0;
+}
@@ -0,0 +1,139 @@
+// Reading the rows of a player with 10,000 items, the way IOLoginData::loadItems does for every login. Compares the
+// columns looked up by name for every field with the column indices resolved once per result. The numbers are first
+// parsed on their own, strtoul on a terminated string the way the rows used to be read against std::from_chars on the
+// column, then the rows are loaded from the database in config.lua if it can be reached.
+
+#include "../otpch.h"
+
+#include "../configmanager.h"
+#include "../database.h"
+#include "../pugicast.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t ITEM_COUNT = 10'000;
+constexpr size_t LOADS = 50;
+
+struct ItemRow
+{
+	uint32_t sid;
+	uint32_t pid;
+	uint16_t type;
+	uint16_t count;
+	size_t attributes;
+};
+
+template <typename Load>
+double millisecondsPerLoad(Load&& load)
+{
+	const auto start = Clock::now();
+	for (size_t i = 0; i < LOADS; ++i) {
+		load();
+	}
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / LOADS;
+}
+
+void benchmarkParsing()
+{
+	std::mt19937 rng{42};
+	std::uniform_int_distribution<uint32_t> value(0, 100'000);
+
+	// the numeric columns of the item rows, as the text protocol delivers them
+	std::vector<std::string> columns;
+	for (size_t i = 0; i < ITEM_COUNT * 4; ++i) {
+		columns.push_back(std::to_string(value(rng)));
+	}
+
+	uint64_t sum = 0;
+	const double strtoul = millisecondsPerLoad([&]() {
+		for (const auto& column : columns) {
+			sum += pugi::cast<uint32_t>(column.c_str());
+		}
+	});
+	const double fromChars = millisecondsPerLoad([&]() {
+		for (const auto& column : columns) {
+			sum += tfs::detail::parseNumber<uint32_t>(column);
+		}
+	});
+
+	std::cout << fmt::format("parsing the numbers of {:d} items, ms per player (checksum {:d}):\n", ITEM_COUNT, sum);
+	std::cout << fmt::format("{:>24} {:>10.3f}\n", "strtoul", strtoul);
+	std::cout << fmt::format("{:>24} {:>10.3f}\n", "std::from_chars", fromChars);
+}
+
+std::vector<ItemRow> readByName(const DBResult_ptr& result)
+{
+	std::vector<ItemRow> rows;
+	rows.reserve(ITEM_COUNT);
+	do {
+		rows.push_back({result->getNumber<uint32_t>("sid"), result->getNumber<uint32_t>("pid"),
+		                result->getNumber<uint16_t>("itemtype"), result->getNumber<uint16_t>("count"),
+		                result->getString("attributes").size()});
+	} while (result->next());
+	return rows;
+}
+
+std::vector<ItemRow> readByIndex(const DBResult_ptr& result)
+{
+	const size_t sidColumn = result->getColumnIndex("sid");
+	const size_t pidColumn = result->getColumnIndex("pid");
+	const size_t typeColumn = result->getColumnIndex("itemtype");
+	const size_t countColumn = result->getColumnIndex("count");
+	const size_t attributesColumn = result->getColumnIndex("attributes");
+
+	std::vector<ItemRow> rows;
+	rows.reserve(ITEM_COUNT);
+	do {
+		rows.push_back({result->getNumber<uint32_t>(sidColumn), result->getNumber<uint32_t>(pidColumn),
+		                result->getNumber<uint16_t>(typeColumn), result->getNumber<uint16_t>(countColumn),
+		                result->getString(attributesColumn).size()});
+	} while (result->next());
+	return rows;
+}
+
+void benchmarkLoading(Database& db)
+{
+	db.executeQuery(
+	    "CREATE TEMPORARY TABLE `bench_player_items` (`player_id` INT NOT NULL, `pid` INT NOT NULL, `sid` INT NOT NULL, `itemtype` SMALLINT UNSIGNED NOT NULL, `count` SMALLINT NOT NULL, `attributes` BLOB NOT NULL, UNIQUE KEY (`player_id`, `sid`))");
+
+	// a few backpacks full of stacks, every item with a short attribute blob
+	DBInsert insert("INSERT INTO `bench_player_items` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
+	const std::string attributes(12, '\x01');
+	for (size_t sid = 101; sid < 101 + ITEM_COUNT; ++sid) {
+		const size_t pid = sid < 111 ? (sid - 100) : 101 + (sid - 111) / 20;
+		insert.addRow(fmt::format("1, {:d}, {:d}, {:d}, {:d}, {:s}", pid, sid, 2148 + sid % 3, sid % 100,
+		                          db.escapeBlob(attributes.data(), attributes.size())));
+	}
+	insert.execute();
+
+	const std::string query =
+	    "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `bench_player_items` WHERE `player_id` = 1 ORDER BY `sid` DESC";
+
+	const double queryOnly = millisecondsPerLoad([&]() { db.storeQuery(query); });
+	const double byName = millisecondsPerLoad([&]() { readByName(db.storeQuery(query)); });
+	const double byIndex = millisecondsPerLoad([&]() { readByIndex(db.storeQuery(query)); });
+
+	std::cout << fmt::format("loading a player with {:d} items, ms per player:\n", ITEM_COUNT);
+	std::cout << fmt::format("{:>24} {:>10.3f}\n", "query only", queryOnly);
+	std::cout << fmt::format("{:>24} {:>10.3f} {:>10.3f} reading\n", "columns by name", byName, byName - queryOnly);
+	std::cout << fmt::format("{:>24} {:>10.3f} {:>10.3f} reading\n", "columns by index", byIndex,
+	                         byIndex - queryOnly);
+}
+
+} // namespace
+
+int main()
+{
+	benchmarkParsing();
+
+	Database& db = Database::getInstance();
+	if (!ConfigManager::load() || !db.connect()) {
+		std::cout << "Failed to connect to database, skipping the load from the database.\n";
+		return 0;
+	}
+
+	benchmarkLoading(db);
+	return 0;
+}
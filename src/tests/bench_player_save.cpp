@@ -0,0 +1,138 @@
+// Writing a global save of 1,000 players, each with the row in `players` and the statements that rewrite their items,
+// storage and outfits. Compares a transaction per player with a round trip for every statement, the way the players
+// used to be saved, against a batch per player and against one transaction that sends every player in one batch.
+// Needs the database from config.lua in the working directory.
+
+#include "../otpch.h"
+
+#include "../configmanager.h"
+#include "../database.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t PLAYER_COUNT = 1'000;
+constexpr size_t ITEMS_PER_PLAYER = 60;
+constexpr size_t STORAGE_PER_PLAYER = 40;
+
+std::vector<std::string> playerSave(const Database& db, uint32_t guid, std::mt19937& rng)
+{
+	std::vector<std::string> queries;
+	queries.push_back(db.formatStatement(
+	    "UPDATE `bench_players` SET `level` = ?, `experience` = ?, `health` = ?, `mana` = ?, `posx` = ?, `posy` = ?, `posz` = ?, `conditions` = ?, `lastip` = COALESCE(INET6_ATON(?), `lastip`) WHERE `id` = ?",
+	    rng() % 500, rng(), rng() % 5'000, rng() % 5'000, 1000 + rng() % 100, 1000 + rng() % 100, 7,
+	    DBBlob{std::string(24, '\x02')}, std::optional<std::string>{"127.0.0.1"}, guid));
+
+	queries.push_back(fmt::format("DELETE FROM `bench_player_items` WHERE `player_id` = {:d}", guid));
+	DBInsert items("INSERT INTO `bench_player_items` (`player_id`, `sid`, `itemtype`, `attributes`) VALUES ",
+	               queries);
+	const std::string attributes(12, '\x01');
+	for (size_t sid = 101; sid < 101 + ITEMS_PER_PLAYER; ++sid) {
+		items.addRow(fmt::format("{:d}, {:d}, {:d}, {:s}", guid, sid, 2148 + rng() % 100,
+		                         db.escapeBlob(attributes.data(), attributes.size())));
+	}
+	items.execute();
+
+	DBInsert storage("INSERT INTO `bench_player_storage` (`player_id`, `key`, `value`) VALUES ", queries);
+	storage.upsert({"value"});
+	for (size_t key = 0; key < STORAGE_PER_PLAYER; ++key) {
+		storage.addRow(fmt::format("{:d}, {:d}, {:d}", guid, 10'000 + key, rng() % 100));
+	}
+	storage.execute();
+
+	queries.push_back(fmt::format("DELETE FROM `bench_player_outfits` WHERE `player_id` = {:d}", guid));
+	queries.push_back(fmt::format(
+	    "INSERT INTO `bench_player_outfits` (`player_id`, `outfit_id`, `addons`) VALUES ({:d}, 128, 3), ({:d}, 129, 1)",
+	    guid, guid));
+	return queries;
+}
+
+std::vector<std::string_view> views(const std::vector<std::string>& queries)
+{
+	return {queries.begin(), queries.end()};
+}
+
+template <typename Save>
+double milliseconds(Save&& save)
+{
+	const auto start = Clock::now();
+	save();
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+} // namespace
+
+int main()
+{
+	Database& db = Database::getInstance();
+	if (!ConfigManager::load() || !db.connect()) {
+		std::cout << "Failed to connect to database.\n";
+		return 1;
+	}
+
+	db.executeQuery(
+	    "CREATE TEMPORARY TABLE `bench_players` (`id` INT NOT NULL PRIMARY KEY, `level` INT NOT NULL DEFAULT 1, `experience` BIGINT NOT NULL DEFAULT 0, `health` INT NOT NULL DEFAULT 150, `mana` INT NOT NULL DEFAULT 0, `posx` INT NOT NULL DEFAULT 0, `posy` INT NOT NULL DEFAULT 0, `posz` INT NOT NULL DEFAULT 0, `conditions` BLOB NULL, `lastip` VARBINARY(16) NULL) ENGINE = InnoDB");
+	db.executeQuery(
+	    "CREATE TEMPORARY TABLE `bench_player_items` (`player_id` INT NOT NULL, `sid` INT NOT NULL, `itemtype` SMALLINT UNSIGNED NOT NULL, `attributes` BLOB NOT NULL, UNIQUE KEY (`player_id`, `sid`)) ENGINE = InnoDB");
+	db.executeQuery(
+	    "CREATE TEMPORARY TABLE `bench_player_storage` (`player_id` INT NOT NULL, `key` INT UNSIGNED NOT NULL, `value` INT NOT NULL, PRIMARY KEY (`player_id`, `key`)) ENGINE = InnoDB");
+	db.executeQuery(
+	    "CREATE TEMPORARY TABLE `bench_player_outfits` (`player_id` INT NOT NULL, `outfit_id` SMALLINT UNSIGNED NOT NULL, `addons` TINYINT UNSIGNED NOT NULL, PRIMARY KEY (`player_id`, `outfit_id`)) ENGINE = InnoDB");
+
+	DBInsert players("INSERT INTO `bench_players` (`id`) VALUES ");
+	for (uint32_t guid = 1; guid <= PLAYER_COUNT; ++guid) {
+		players.addRow(std::to_string(guid));
+	}
+	players.execute();
+
+	std::mt19937 rng{42};
+	std::vector<std::vector<std::string>> saves;
+	size_t statements = 0;
+	for (uint32_t guid = 1; guid <= PLAYER_COUNT; ++guid) {
+		statements += saves.emplace_back(playerSave(db, guid, rng)).size();
+	}
+
+	const double perStatement = milliseconds([&]() {
+		for (const auto& queries : saves) {
+			DBTransaction transaction{db};
+			transaction.begin();
+			for (const std::string& query : queries) {
+				db.executeQuery(query);
+			}
+			transaction.commit();
+		}
+	});
+
+	const double perPlayer = milliseconds([&]() {
+		for (const auto& queries : saves) {
+			DBTransaction transaction{db};
+			transaction.begin();
+			db.executeBatch(views(queries));
+			transaction.commit();
+		}
+	});
+
+	const double grouped = milliseconds([&]() {
+		std::vector<std::string_view> queries;
+		queries.reserve(statements);
+		for (const auto& save : saves) {
+			queries.insert(queries.end(), save.begin(), save.end());
+		}
+
+		DBTransaction transaction{db};
+		transaction.begin();
+		db.executeBatch(queries);
+		transaction.commit();
+	});
+
+	std::cout << fmt::format("saving {:d} players, {:d} statements (max_allowed_packet {:d} bytes):\n", PLAYER_COUNT,
+	                         statements, db.getMaxPacketSize());
+	std::cout << fmt::format("{:>36} {:>10} {:>14}\n", "", "total ms", "ms per player");
+	std::cout << fmt::format("{:>36} {:>10.1f} {:>14.3f}\n", "round trip per statement", perStatement,
+	                         perStatement / PLAYER_COUNT);
+	std::cout << fmt::format("{:>36} {:>10.1f} {:>14.3f}\n", "batch per player", perPlayer, perPlayer / PLAYER_COUNT);
+	std::cout << fmt::format("{:>36} {:>10.1f} {:>14.3f}\n", "one transaction for all players", grouped,
+	                         grouped / PLAYER_COUNT);
+	return 0;
+}
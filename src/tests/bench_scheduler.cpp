@@ -0,0 +1,178 @@
+// Compares the scheduler against one boost::asio::steady_timer per event, which is how the scheduler used to track
+// its events. The shipped Scheduler and the previous implementation run on their own thread and hand expired events to
+// the dispatcher, and both are driven through the same workload and the same measurement code:
+// - add events with delays of up to a minute and stop all of them again,
+// - add events with short delays and wait until the dispatcher has executed all of them.
+// Both phases wait in real time for the scheduler thread, so the CPU time of the process is what is compared.
+
+#include "../otpch.h"
+
+#include "../scheduler.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t EVENT_COUNT = 200'000;
+constexpr uint32_t MAX_DELAY = 60'000;
+constexpr uint32_t EXPIRE_EVENT_COUNT = 50'000;
+constexpr uint32_t MAX_EXPIRE_DELAY = 500;
+
+double elapsedMs(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+double cpuElapsedMs(std::clock_t start) { return 1000.0 * (std::clock() - start) / CLOCKS_PER_SEC; }
+
+std::vector<uint32_t> makeDelays(uint32_t count, uint32_t maxDelay)
+{
+	std::mt19937 rng{42};
+	std::uniform_int_distribution<uint32_t> dist{SCHEDULER_MINTICKS, maxDelay};
+
+	std::vector<uint32_t> delays(count);
+	std::generate(delays.begin(), delays.end(), [&]() { return dist(rng); });
+	return delays;
+}
+
+// The previous scheduler: one steady_timer per event, looked up by event id.
+class SteadyTimerScheduler : public ThreadHolder<SteadyTimerScheduler>
+{
+public:
+	uint32_t addEvent(SchedulerTask* task)
+	{
+		if (task->getEventId() == 0) {
+			task->setEventId(++lastEventId);
+		}
+
+		boost::asio::post(io_context, [this, task]() {
+			auto it = eventIdTimerMap.emplace(task->getEventId(), boost::asio::steady_timer{io_context});
+			auto& timer = it.first->second;
+
+			timer.expires_after(std::chrono::milliseconds(task->getDelay()));
+			timer.async_wait([this, task](const boost::system::error_code& error) {
+				eventIdTimerMap.erase(task->getEventId());
+
+				if (error == boost::asio::error::operation_aborted || getState() == THREAD_STATE_TERMINATED) {
+					delete task;
+					return;
+				}
+
+				g_dispatcher.addTask(task);
+			});
+		});
+
+		return task->getEventId();
+	}
+
+	void stopEvent(uint32_t eventId)
+	{
+		if (eventId == 0) {
+			return;
+		}
+
+		boost::asio::post(io_context, [this, eventId]() {
+			auto it = eventIdTimerMap.find(eventId);
+			if (it != eventIdTimerMap.end()) {
+				it->second.cancel();
+			}
+		});
+	}
+
+	void shutdown()
+	{
+		setState(THREAD_STATE_TERMINATED);
+		boost::asio::post(io_context, [this]() {
+			for (auto& it : eventIdTimerMap) {
+				it.second.cancel();
+			}
+
+			io_context.stop();
+		});
+	}
+
+	void threadMain() { io_context.run(); }
+
+private:
+	std::atomic<uint32_t> lastEventId{0};
+	std::unordered_map<uint32_t, boost::asio::steady_timer> eventIdTimerMap;
+
+	boost::asio::io_context io_context;
+	boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work{io_context.get_executor()};
+};
+
+// Adds an event that fulfills the promise once the dispatcher executes it. Events are handled by the scheduler thread
+// in the order they were added or stopped, so this also waits for everything that was posted before.
+void waitForEvent(auto& scheduler, uint32_t delay)
+{
+	std::promise<void> done;
+	scheduler.addEvent(createSchedulerTask(delay, [&done]() { done.set_value(); }));
+	done.get_future().wait();
+}
+
+template <typename SchedulerType>
+void runWorkload(std::string_view name, const std::vector<uint32_t>& delays,
+                 const std::vector<uint32_t>& expireDelays)
+{
+	SchedulerType scheduler;
+	scheduler.start();
+
+	std::vector<uint32_t> eventIds;
+	eventIds.reserve(delays.size());
+
+	auto start = Clock::now();
+	std::clock_t cpuStart = std::clock();
+	for (auto delay : delays) {
+		eventIds.push_back(scheduler.addEvent(createSchedulerTask(delay, []() {})));
+	}
+	double scheduleTime = elapsedMs(start);
+
+	for (auto eventId : eventIds) {
+		scheduler.stopEvent(eventId);
+	}
+	waitForEvent(scheduler, SCHEDULER_MINTICKS);
+	double scheduleCpuTime = cpuElapsedMs(cpuStart);
+
+	// executed on the dispatcher thread only
+	size_t executed = 0;
+	std::promise<void> allExecuted;
+
+	start = Clock::now();
+	cpuStart = std::clock();
+	for (auto delay : expireDelays) {
+		scheduler.addEvent(createSchedulerTask(delay, [&]() {
+			if (++executed == expireDelays.size()) {
+				allExecuted.set_value();
+			}
+		}));
+	}
+	allExecuted.get_future().wait();
+	double expireCpuTime = cpuElapsedMs(cpuStart);
+	double expireTime = elapsedMs(start);
+
+	scheduler.shutdown();
+	scheduler.join();
+
+	std::cout << fmt::format(
+	    "{:<15} add {:8.2f} ms, add and stop {:8.2f} ms cpu, expire {:8.2f} ms cpu ({:.0f} ms wall, {:d} executed)\n",
+	    name, scheduleTime, scheduleCpuTime, expireCpuTime, expireTime, executed);
+}
+
+} // namespace
+
+int main()
+{
+	g_dispatcher.start();
+
+	auto delays = makeDelays(EVENT_COUNT, MAX_DELAY);
+	auto expireDelays = makeDelays(EXPIRE_EVENT_COUNT, MAX_EXPIRE_DELAY);
+	std::cout << fmt::format("{:d} events between {:d} and {:d} ms, {:d} expiring events up to {:d} ms\n",
+	                         EVENT_COUNT, SCHEDULER_MINTICKS, MAX_DELAY, EXPIRE_EVENT_COUNT, MAX_EXPIRE_DELAY);
+
+	runWorkload<SteadyTimerScheduler>("steady_timer:", delays, expireDelays);
+	runWorkload<Scheduler>("scheduler:", delays, expireDelays);
+
+	g_dispatcher.shutdown();
+	g_dispatcher.join();
+	return 0;
+}
@@ -0,0 +1,202 @@
+// Measures spectator queries while monsters walk around, with 1000 players and 20000 monsters on one floor.
+// The map keeps the creature positions per quadtree leaf and only drops the cached spectators around a tile that a
+// creature entered or left. The reference side does what the map used to do: it reads the position from every
+// creature of a leaf and drops the whole spectator cache on every move.
+
+#include "../otpch.h"
+
+#include "../game.h"
+#include "../monster.h"
+#include "../monsters.h"
+#include "../player.h"
+
+extern Game g_game;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint16_t AREA_SIZE = 1024;
+constexpr uint16_t AREA_OFFSET = 1000;
+constexpr uint8_t AREA_FLOOR = 7;
+constexpr size_t PLAYER_COUNT = 1'000;
+constexpr size_t MONSTER_COUNT = 20'000;
+constexpr size_t ROUNDS = 20;
+
+double elapsedMs(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// spectator lookup and cache as the map did it before creature positions were stored per leaf
+class ReferenceSpectators
+{
+public:
+	void addCreature(Creature* creature) { cells[getCellKey(creature->getPosition())].push_back(creature); }
+
+	void removeCreature(Creature* creature, const Position& pos)
+	{
+		auto& cell = cells[getCellKey(pos)];
+		auto it = std::find(cell.begin(), cell.end(), creature);
+		*it = cell.back();
+		cell.pop_back();
+	}
+
+	void clearCache() { cache.clear(); }
+
+	void getSpectators(SpectatorVec& spectators, const Position& centerPos)
+	{
+		auto it = cache.find(centerPos);
+		if (it != cache.end()) {
+			spectators = it->second;
+			return;
+		}
+
+		const int32_t minX = centerPos.x - Map::maxViewportX;
+		const int32_t maxX = centerPos.x + Map::maxViewportX;
+		const int32_t minY = centerPos.y - Map::maxViewportY;
+		const int32_t maxY = centerPos.y + Map::maxViewportY;
+
+		for (int32_t y = minY & ~FLOOR_MASK; y <= maxY; y += FLOOR_SIZE) {
+			for (int32_t x = minX & ~FLOOR_MASK; x <= maxX; x += FLOOR_SIZE) {
+				auto cell = cells.find(getCellKey(Position(x, y, AREA_FLOOR)));
+				if (cell == cells.end()) {
+					continue;
+				}
+
+				for (Creature* creature : cell->second) {
+					const Position& pos = creature->getPosition();
+					if (pos.x >= minX && pos.x <= maxX && pos.y >= minY && pos.y <= maxY) {
+						spectators.emplace_back(creature);
+					}
+				}
+			}
+		}
+		cache[centerPos] = spectators;
+	}
+
+private:
+	static uint32_t getCellKey(const Position& pos) { return hashCoord(pos.x >> FLOOR_BITS, pos.y >> FLOOR_BITS); }
+
+	std::unordered_map<uint32_t, CreatureVector> cells;
+	std::map<Position, SpectatorVec> cache;
+};
+
+Position randomPosition(std::mt19937& rng)
+{
+	std::uniform_int_distribution<uint16_t> dist{0, AREA_SIZE - 1};
+	return Position(AREA_OFFSET + dist(rng), AREA_OFFSET + dist(rng), AREA_FLOOR);
+}
+
+Position randomStep(std::mt19937& rng, const Position& pos)
+{
+	static constexpr std::array<std::pair<int32_t, int32_t>, 4> steps = {{{0, -1}, {1, 0}, {0, 1}, {-1, 0}}};
+	const auto& step = steps[rng() % steps.size()];
+	return Position(std::clamp<int32_t>(pos.x + step.first, AREA_OFFSET, AREA_OFFSET + AREA_SIZE - 1),
+	                std::clamp<int32_t>(pos.y + step.second, AREA_OFFSET, AREA_OFFSET + AREA_SIZE - 1), AREA_FLOOR);
+}
+
+// moves the creature between tiles the way Map::moveCreature does, without the client updates and move events
+void moveCreature(Creature* creature, const Position& newPos)
+{
+	Map& map = g_game.map;
+	const Position oldPos = creature->getPosition();
+
+	Tile* oldTile = creature->getTile();
+	Tile* newTile = map.getTile(newPos);
+
+	oldTile->removeThing(creature, 0);
+	newTile->addThing(creature);
+
+	QTreeLeafNode* leaf = map.getQTNode(oldPos.x, oldPos.y);
+	QTreeLeafNode* newLeaf = map.getQTNode(newPos.x, newPos.y);
+	if (leaf != newLeaf) {
+		leaf->removeCreature(creature);
+		newLeaf->addCreature(creature);
+	} else {
+		leaf->moveCreature(creature);
+	}
+}
+
+} // namespace
+
+int main()
+{
+	Map& map = g_game.map;
+	for (uint16_t y = AREA_OFFSET; y < AREA_OFFSET + AREA_SIZE; ++y) {
+		for (uint16_t x = AREA_OFFSET; x < AREA_OFFSET + AREA_SIZE; ++x) {
+			map.setTile(x, y, AREA_FLOOR, new StaticTile(x, y, AREA_FLOOR));
+		}
+	}
+	map.buildTileGrid();
+
+	std::mt19937 rng{42};
+
+	MonsterType monsterType;
+	std::vector<Player*> players;
+	std::vector<Creature*> monsters;
+	for (size_t i = 0; i < PLAYER_COUNT; ++i) {
+		players.push_back(new Player(nullptr));
+		map.placeCreature(randomPosition(rng), players.back(), false, true);
+	}
+	for (size_t i = 0; i < MONSTER_COUNT; ++i) {
+		monsters.push_back(new Monster(&monsterType));
+		map.placeCreature(randomPosition(rng), monsters.back(), false, true);
+	}
+
+	ReferenceSpectators reference;
+	for (Creature* player : players) {
+		reference.addCreature(player);
+	}
+	for (Creature* monster : monsters) {
+		reference.addCreature(monster);
+	}
+
+	std::cout << fmt::format("{:d} players, {:d} monsters on {:d}x{:d} tiles, {:d} rounds\n", PLAYER_COUNT,
+	                         MONSTER_COUNT, AREA_SIZE, AREA_SIZE, ROUNDS);
+
+	double mapMoveTime = 0, mapQueryTime = 0, referenceMoveTime = 0, referenceQueryTime = 0;
+	size_t mapSpectators = 0, referenceSpectators = 0;
+
+	for (size_t round = 0; round < ROUNDS; ++round) {
+		// every monster takes a step, then every player looks around twice, like a creature moving next to it would
+		for (Creature* monster : monsters) {
+			const Position oldPos = monster->getPosition();
+			const Position newPos = randomStep(rng, oldPos);
+
+			auto start = Clock::now();
+			moveCreature(monster, newPos);
+			mapMoveTime += elapsedMs(start);
+
+			start = Clock::now();
+			reference.removeCreature(monster, oldPos);
+			reference.addCreature(monster);
+			reference.clearCache();
+			referenceMoveTime += elapsedMs(start);
+		}
+
+		for (size_t i = 0; i < 2; ++i) {
+			auto start = Clock::now();
+			for (Player* player : players) {
+				SpectatorVec spectators;
+				map.getSpectators(spectators, player->getPosition(), true);
+				mapSpectators += spectators.size();
+			}
+			mapQueryTime += elapsedMs(start);
+
+			start = Clock::now();
+			for (Player* player : players) {
+				SpectatorVec spectators;
+				reference.getSpectators(spectators, player->getPosition());
+				referenceSpectators += spectators.size();
+			}
+			referenceQueryTime += elapsedMs(start);
+		}
+	}
+
+	std::cout << fmt::format("reference: moves {:.2f} ms, queries {:.2f} ms ({:d} spectators)\n", referenceMoveTime,
+	                         referenceQueryTime, referenceSpectators);
+	std::cout << fmt::format("map:       moves {:.2f} ms, queries {:.2f} ms ({:d} spectators)\n", mapMoveTime,
+	                         mapQueryTime, mapSpectators);
+	return mapSpectators == referenceSpectators ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+// Latency and CPU time of the queries on the hot paths, sent as text the way they used to be and as prepared
+// statements. Looks up and updates rows of a temporary table shaped like `players` by their id, which is what loading,
+// saving and the online status do. Needs the database from config.lua in the working directory.
+
+#include "../otpch.h"
+
+#include "../configmanager.h"
+#include "../database.h"
+
+#include <ctime>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t ROW_COUNT = 1'000;
+constexpr size_t QUERY_COUNT = 20'000;
+
+struct Result
+{
+	double latencyMicroseconds;
+	double cpuMicroseconds;
+};
+
+template <typename Query>
+Result measure(Query&& query)
+{
+	std::mt19937 rng{42};
+	std::uniform_int_distribution<uint32_t> id(1, ROW_COUNT);
+
+	const auto start = Clock::now();
+	const std::clock_t cpuStart = std::clock();
+	for (size_t i = 0; i < QUERY_COUNT; ++i) {
+		query(id(rng));
+	}
+	const double cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+	const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	return {seconds * 1e6 / QUERY_COUNT, cpuSeconds * 1e6 / QUERY_COUNT};
+}
+
+void print(std::string_view name, std::string_view protocol, Result result)
+{
+	std::cout << fmt::format("{:>8} {:>10} {:>12.1f} {:>12.2f}\n", name, protocol, result.latencyMicroseconds,
+	                         result.cpuMicroseconds);
+}
+
+} // namespace
+
+int main()
+{
+	if (!ConfigManager::load()) {
+		std::cout << "Unable to load config.lua\n";
+		return 1;
+	}
+
+	Database& db = Database::getInstance();
+	if (!db.connect()) {
+		std::cout << "Failed to connect to database.\n";
+		return 1;
+	}
+
+	db.executeQuery(
+	    "CREATE TEMPORARY TABLE `bench_statements` (`id` INT NOT NULL PRIMARY KEY, `name` VARCHAR(255) NOT NULL, `level` INT NOT NULL, `experience` BIGINT UNSIGNED NOT NULL, `onlinetime` BIGINT NOT NULL, `conditions` BLOB NOT NULL)");
+	for (size_t id = 1; id <= ROW_COUNT; ++id) {
+		db.executeStatement(
+		    "INSERT INTO `bench_statements` (`id`, `name`, `level`, `experience`, `onlinetime`, `conditions`) VALUES (?, ?, ?, ?, ?, ?)",
+		    id, fmt::format("Player {:d}", id), 100, uint64_t{15'694'800}, int64_t{0}, DBBlob{std::string(64, '\0')});
+	}
+
+	std::cout << fmt::format("{:d} queries on {:d} rows, per query:\n", QUERY_COUNT, ROW_COUNT);
+	std::cout << fmt::format("{:>8} {:>10} {:>12} {:>12}\n", "query", "protocol", "latency us", "cpu us");
+
+	print("select", "text", measure([&](uint32_t id) {
+		      DBResult_ptr result = db.storeQuery(fmt::format(
+		          "SELECT `name`, `level`, `experience`, `onlinetime`, `conditions` FROM `bench_statements` WHERE `id` = {:d}",
+		          id));
+		      result->getNumber<uint64_t>("experience");
+	      }));
+	print("select", "statement", measure([&](uint32_t id) {
+		      DBResult_ptr result = db.storeStatement(
+		          "SELECT `name`, `level`, `experience`, `onlinetime`, `conditions` FROM `bench_statements` WHERE `id` = ?",
+		          id);
+		      result->getNumber<uint64_t>("experience");
+	      }));
+
+	const std::string conditions(64, '\x01');
+	print("update", "text", measure([&](uint32_t id) {
+		      db.executeQuery(fmt::format(
+		          "UPDATE `bench_statements` SET `level` = {:d}, `experience` = {:d}, `onlinetime` = `onlinetime` + {:d}, `conditions` = {:s} WHERE `id` = {:d}",
+		          101, 15'694'900, 60, db.escapeBlob(conditions.data(), conditions.size()), id));
+	      }));
+	print("update", "statement", measure([&](uint32_t id) {
+		      db.executeStatement(
+		          "UPDATE `bench_statements` SET `level` = ?, `experience` = ?, `onlinetime` = `onlinetime` + ?, `conditions` = ? WHERE `id` = ?",
+		          101, 15'694'900, 60, DBBlob{conditions}, id);
+	      }));
+	return 0;
+}
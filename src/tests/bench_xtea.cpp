@@ -0,0 +1,69 @@
+// Throughput of the XTEA kernels on packets of typical sizes, from a single walk packet up to a full map description.
+// Every kernel the CPU supports encrypts and decrypts the same buffers, the last one listed is the one the server uses.
+
+#include "../otpch.h"
+
+#include "../xtea.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t BYTES_PER_RUN = 256 * 1024 * 1024;
+
+const char* kernelName(xtea::kernel kernel)
+{
+	switch (kernel) {
+		case xtea::kernel::sse2:
+			return "sse2";
+		case xtea::kernel::avx2:
+			return "avx2";
+		default:
+			return "scalar";
+	}
+}
+
+template <typename Crypt>
+double throughput(std::vector<uint8_t>& data, Crypt&& crypt)
+{
+	const size_t iterations = std::max<size_t>(BYTES_PER_RUN / data.size(), 1);
+
+	auto start = Clock::now();
+	for (size_t i = 0; i < iterations; ++i) {
+		crypt(data.data(), data.size());
+	}
+	const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	return iterations * data.size() / seconds / (1024 * 1024);
+}
+
+} // namespace
+
+int main()
+{
+	std::mt19937 rng{42};
+	std::uniform_int_distribution<uint32_t> word;
+	const auto roundKeys = xtea::expand_key({word(rng), word(rng), word(rng), word(rng)});
+
+	std::cout << fmt::format("{:>7} {:>8} {:>14} {:>14}\n", "bytes", "kernel", "encrypt MB/s", "decrypt MB/s");
+	for (size_t size : {16, 64, 256, 1024, 4096, 24576}) {
+		std::vector<uint8_t> data(size);
+		std::generate(data.begin(), data.end(), [&]() { return static_cast<uint8_t>(rng()); });
+
+		double scalarEncrypt = 0;
+		for (auto kernel : xtea::supported_kernels()) {
+			const double encrypt = throughput(data, [&](uint8_t* buffer, size_t length) {
+				xtea::encrypt(buffer, length, roundKeys, kernel);
+			});
+			const double decrypt = throughput(data, [&](uint8_t* buffer, size_t length) {
+				xtea::decrypt(buffer, length, roundKeys, kernel);
+			});
+
+			if (kernel == xtea::kernel::scalar) {
+				scalarEncrypt = encrypt;
+			}
+			std::cout << fmt::format("{:>7d} {:>8} {:>14.1f} {:>14.1f} {:6.2f}x\n", size, kernelName(kernel), encrypt,
+			                         decrypt, encrypt / scalarEncrypt);
+		}
+	}
+	return 0;
+}
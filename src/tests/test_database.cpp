@@ -0,0 +1,69 @@
+#define BOOST_TEST_MODULE database
+
+#include "../otpch.h"
+
+#include "../database.h"
+
+#include <boost/test/unit_test.hpp>
+
+using tfs::detail::formatNumber;
+using tfs::detail::parseNumber;
+
+BOOST_AUTO_TEST_CASE(test_parse_number_integers)
+{
+	BOOST_TEST(parseNumber<uint32_t>("4294967295") == 4294967295u);
+	BOOST_TEST(parseNumber<int32_t>("-2147483648") == std::numeric_limits<int32_t>::min());
+	BOOST_TEST(parseNumber<uint64_t>("18446744073709551615") == std::numeric_limits<uint64_t>::max());
+	BOOST_TEST(parseNumber<int64_t>("-1") == -1);
+	BOOST_TEST(parseNumber<uint16_t>("") == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_number_stops_at_the_end_of_the_column)
+{
+	// the columns of a row follow each other in one buffer
+	constexpr std::string_view row = "12345";
+	BOOST_TEST(parseNumber<uint32_t>(row.substr(0, 2)) == 12u);
+	// DECIMAL columns, such as SUM of integers
+	BOOST_TEST(parseNumber<uint64_t>("1500.0000") == 1500u);
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_number_wraps_like_strtoul)
+{
+	BOOST_TEST(parseNumber<uint32_t>("-1") == std::numeric_limits<uint32_t>::max());
+	BOOST_TEST(parseNumber<uint8_t>("300") == 44);
+	BOOST_TEST(parseNumber<int8_t>("-129") == 127);
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_number_enums_and_floats)
+{
+	enum class Small : uint8_t
+	{
+		A = 7
+	};
+	BOOST_TEST((parseNumber<Small>("7") == Small::A));
+	BOOST_TEST(parseNumber<double>("2.5") == 2.5);
+	BOOST_TEST(parseNumber<double>("-0.125") == -0.125);
+}
+
+BOOST_AUTO_TEST_CASE(test_format_number_like_the_text_protocol)
+{
+	using tfs::detail::StatementValue;
+	BOOST_TEST(formatNumber(StatementValue{int64_t{-42}}) == "-42");
+	BOOST_TEST(formatNumber(StatementValue{std::numeric_limits<uint64_t>::max()}) == "18446744073709551615");
+	BOOST_TEST(formatNumber(StatementValue{2.5}) == "2.5");
+	BOOST_TEST(formatNumber(StatementValue{}).empty());
+
+	// the text of a number reads back as the same number
+	BOOST_TEST(parseNumber<int32_t>(formatNumber(StatementValue{int64_t{-2147483648}})) ==
+	           std::numeric_limits<int32_t>::min());
+}
+
+BOOST_AUTO_TEST_CASE(test_format_statement)
+{
+	// numbers and NULL don't need the connection to be escaped
+	const Database db;
+	BOOST_TEST(db.formatStatement("UPDATE `players` SET `level` = ?, `skull` = COALESCE(?, `skull`) WHERE `id` = ?", 8,
+	                              std::optional<int64_t>{}, 12u) ==
+	           "UPDATE `players` SET `level` = 8, `skull` = COALESCE(NULL, `skull`) WHERE `id` = 12");
+	BOOST_TEST(db.formatStatement("SELECT ?, ?", std::optional<uint8_t>{3}, true) == "SELECT 3, 1");
+}
@@ -0,0 +1,162 @@
+#define BOOST_TEST_MODULE databasetasks
+
+#include "../otpch.h"
+
+#include "../databasetasks.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+constexpr size_t THREAD_COUNT = 4;
+
+// A job that does not return before it is released, it keeps its keys held meanwhile.
+class Gate
+{
+public:
+	void wait() { released.wait(); }
+	void open() { promise.set_value(); }
+
+private:
+	std::promise<void> promise;
+	std::shared_future<void> released = promise.get_future().share();
+};
+
+// The jobs log their names in the order they run, the connections are not used.
+class Log
+{
+public:
+	std::function<void(Database&)> job(std::string name, Gate* gate = nullptr)
+	{
+		return [this, name = std::move(name), gate](Database&) {
+			if (gate) {
+				gate->wait();
+			}
+
+			std::lock_guard lock{mutex};
+			names.push_back(name);
+		};
+	}
+
+	std::vector<std::string> get()
+	{
+		std::lock_guard lock{mutex};
+		return names;
+	}
+
+	bool contains(std::string_view name)
+	{
+		auto current = get();
+		return std::find(current.begin(), current.end(), name) != current.end();
+	}
+
+private:
+	std::mutex mutex;
+	std::vector<std::string> names;
+};
+
+struct Fixture
+{
+	Fixture() { BOOST_REQUIRE(tasks.start(THREAD_COUNT, false)); }
+	~Fixture()
+	{
+		tasks.shutdown();
+		tasks.join();
+	}
+
+	DatabaseTasks tasks;
+	Log log;
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(test_database_tasks_same_key_in_order, Fixture)
+{
+	std::vector<std::string> expected;
+	for (size_t i = 0; i < 100; ++i) {
+		expected.push_back(std::to_string(i));
+		tasks.addJob(log.job(expected.back()), DatabaseTasks::playerKey(1));
+	}
+
+	tasks.flush();
+	BOOST_TEST(log.get() == expected, boost::test_tools::per_element());
+}
+
+BOOST_FIXTURE_TEST_CASE(test_database_tasks_blocked_key_does_not_hold_others, Fixture)
+{
+	Gate gate;
+	tasks.addJob(log.job("first", &gate), DatabaseTasks::playerKey(1));
+	tasks.addJob(log.job("second"), DatabaseTasks::playerKey(1));
+	tasks.addJob(log.job("other"), DatabaseTasks::playerKey(2));
+
+	tasks.flush(DatabaseTasks::playerKey(2));
+	BOOST_TEST(log.get() == std::vector<std::string>{"other"}, boost::test_tools::per_element());
+
+	gate.open();
+	tasks.flush();
+	BOOST_TEST(log.get() == (std::vector<std::string>{"other", "first", "second"}), boost::test_tools::per_element());
+}
+
+BOOST_FIXTURE_TEST_CASE(test_database_tasks_multi_key_job_waits_for_every_key, Fixture)
+{
+	Gate gate;
+	tasks.addJob(log.job("player", &gate), DatabaseTasks::playerKey(1));
+	tasks.addJob(log.job("both"), {DatabaseTasks::playerKey(1), DatabaseTasks::playerKey(2)});
+	// queued behind the job that takes both keys, it does not overtake it
+	tasks.addJob(log.job("after"), DatabaseTasks::playerKey(2));
+	tasks.addJob(log.job("unrelated"), DatabaseTasks::playerKey(3));
+
+	tasks.flush(DatabaseTasks::playerKey(3));
+	BOOST_TEST(log.get() == std::vector<std::string>{"unrelated"}, boost::test_tools::per_element());
+	BOOST_TEST(!log.contains("both"));
+	BOOST_TEST(!log.contains("after"));
+
+	gate.open();
+	tasks.flush();
+	BOOST_TEST(log.get() == (std::vector<std::string>{"unrelated", "player", "both", "after"}),
+	           boost::test_tools::per_element());
+}
+
+BOOST_FIXTURE_TEST_CASE(test_database_tasks_flush_key, Fixture)
+{
+	Gate gate;
+	tasks.addJob(log.job("blocked", &gate), DatabaseTasks::playerKey(1));
+	tasks.addJob(log.job("player"), DatabaseTasks::playerKey(2));
+	tasks.addJob(log.job("account"), DatabaseTasks::accountKey(2));
+
+	// only waits for the jobs with the key, the blocked one is still running
+	tasks.flush(DatabaseTasks::playerKey(2));
+	BOOST_TEST(log.contains("player"));
+	BOOST_TEST(!log.contains("blocked"));
+
+	tasks.flush(DatabaseTasks::accountKey(2));
+	BOOST_TEST(log.contains("account"));
+
+	// a job that takes several keys counts for each of them
+	tasks.addJob(log.job("both"), {DatabaseTasks::playerKey(1), DatabaseTasks::playerKey(3)});
+	std::thread release([&gate]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		gate.open();
+	});
+	tasks.flush(DatabaseTasks::playerKey(3));
+	BOOST_TEST(log.contains("blocked"));
+	BOOST_TEST(log.contains("both"));
+	release.join();
+
+	// nothing queued with the key
+	tasks.flush(DatabaseTasks::playerKey(4));
+	BOOST_TEST(log.get().size() == 4u);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_database_tasks_repeated_key, Fixture)
+{
+	Gate gate;
+	tasks.addJob(log.job("first", &gate), DatabaseTasks::playerKey(1));
+	// a key given twice waits only for the tasks before it
+	tasks.addJob(log.job("twice"), {DatabaseTasks::playerKey(1), DatabaseTasks::playerKey(1)});
+	tasks.addJob(log.job("after"), DatabaseTasks::playerKey(1));
+
+	gate.open();
+	tasks.flush();
+	BOOST_TEST(log.get() == (std::vector<std::string>{"first", "twice", "after"}), boost::test_tools::per_element());
+}
@@ -0,0 +1,171 @@
+#define BOOST_TEST_MODULE deadlinewheel
+
+#include "../otpch.h"
+
+#include "../deadlinewheel.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+std::vector<uint64_t> advanceAndCollect(DeadlineWheel<uint64_t>& wheel, uint64_t tick)
+{
+	std::vector<uint64_t> expired;
+	wheel.advance(tick, expired);
+	return expired;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_deadline_wheel_expires_in_order)
+{
+	DeadlineWheel<uint64_t> wheel;
+	wheel.insert(20, 20);
+	wheel.insert(10, 10);
+	wheel.insert(11, 10);
+
+	BOOST_TEST(wheel.size() == 3u);
+	BOOST_TEST(advanceAndCollect(wheel, 9).empty());
+	BOOST_TEST(advanceAndCollect(wheel, 10) == (std::vector<uint64_t>{10, 11}));
+	BOOST_TEST(advanceAndCollect(wheel, 100) == (std::vector<uint64_t>{20}));
+	BOOST_TEST(wheel.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_deadline_wheel_cascades_every_level)
+{
+	// decay ticks are counted from the epoch, the wheel does not start at zero
+	constexpr uint64_t start = 6'000'000'123;
+
+	const std::vector<uint64_t> offsets = {1, 255, 256, 257, 16383, 16384, 70000, 1048575, 1048576, 5000000};
+
+	DeadlineWheel<uint64_t> wheel{start};
+	for (auto offset : offsets) {
+		wheel.insert(start + offset, start + offset);
+	}
+
+	// step exactly to every deadline, nothing may expire early or late
+	for (auto offset : offsets) {
+		BOOST_TEST(advanceAndCollect(wheel, start + offset - 1).empty());
+		BOOST_TEST(advanceAndCollect(wheel, start + offset) == std::vector<uint64_t>{start + offset});
+	}
+	BOOST_TEST(wheel.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_deadline_wheel_random_deadlines)
+{
+	std::mt19937 rng{77};
+	std::uniform_int_distribution<uint64_t> dist{0, 200'000};
+
+	DeadlineWheel<uint64_t> wheel{1000};
+	std::vector<uint64_t> deadlines;
+	for (size_t i = 0; i < 20'000; ++i) {
+		// some of the deadlines are already in the past, they expire in the next tick
+		deadlines.push_back(dist(rng) + 500);
+		wheel.insert(deadlines.back(), deadlines.back());
+	}
+
+	uint64_t tick = 1000, lastDeadline = 0;
+	size_t expiredCount = 0;
+	while (!wheel.empty()) {
+		tick += 1 + rng() % 600;
+		for (auto deadline : advanceAndCollect(wheel, tick)) {
+			const uint64_t expiresAt = std::max<uint64_t>(deadline, 1001);
+			BOOST_TEST(expiresAt <= tick);
+			BOOST_TEST(expiresAt >= lastDeadline);
+			lastDeadline = expiresAt;
+			++expiredCount;
+		}
+
+		// whatever is still in the wheel may not have expired yet
+		lastDeadline = std::max(lastDeadline, tick + 1);
+	}
+	BOOST_TEST(expiredCount == deadlines.size());
+}
+
+BOOST_AUTO_TEST_CASE(test_deadline_wheel_remove)
+{
+	constexpr uint64_t start = 6'000'000'123;
+
+	const std::vector<uint64_t> offsets = {1, 255, 256, 16384, 1048576, 5000000};
+
+	DeadlineWheel<uint64_t> wheel{start};
+	std::map<uint64_t, DeadlineWheelEntry> entries;
+	for (auto offset : offsets) {
+		wheel.insert(start + offset, start + offset);
+		entries[offset] = wheel.insert(offset, start + offset);
+	}
+
+	// let the far entries cascade a level down before they are removed
+	BOOST_TEST(advanceAndCollect(wheel, start + 300) == (std::vector<uint64_t>{start + 1, 1, start + 255, 255,
+	                                                                             start + 256, 256}));
+
+	// expired entries can not be removed anymore
+	BOOST_TEST(!wheel.remove(entries[255], 255));
+
+	for (auto offset : {16384, 1048576, 5000000}) {
+		BOOST_TEST(!wheel.remove(entries[offset], offset + 1));
+		BOOST_TEST(wheel.remove(entries[offset], offset));
+		BOOST_TEST(!wheel.remove(entries[offset], offset));
+	}
+	BOOST_TEST(wheel.size() == 3u);
+	BOOST_TEST(!wheel.remove(DeadlineWheelEntry{}, 0));
+
+	BOOST_TEST(advanceAndCollect(wheel, start + 5000000) ==
+	           (std::vector<uint64_t>{start + 16384, start + 1048576, start + 5000000}));
+	BOOST_TEST(wheel.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_deadline_wheel_remove_from_crowded_slot)
+{
+	constexpr uint64_t deadline = 5000;
+	constexpr uint64_t count = 10'000;
+
+	DeadlineWheel<uint64_t> wheel;
+	std::vector<DeadlineWheelEntry> entries;
+	for (uint64_t i = 0; i < count; ++i) {
+		entries.push_back(wheel.insert(i, deadline));
+	}
+
+	// take out the first, the last and every third entry, the rest keeps its order
+	std::vector<uint64_t> expected;
+	for (uint64_t i = 0; i < count; ++i) {
+		if (i == 0 || i == count - 1 || i % 3 == 0) {
+			BOOST_TEST(wheel.remove(entries[i], i));
+		} else {
+			expected.push_back(i);
+		}
+	}
+	BOOST_TEST(wheel.size() == expected.size());
+
+	// freed entries are reused, an old entry must not remove the value that took its place
+	const auto reused = wheel.insert(count, deadline);
+	BOOST_TEST(!wheel.remove(entries[count - 1], count - 1));
+	BOOST_TEST(!wheel.remove(entries[count - 1], count));
+	expected.push_back(count);
+
+	BOOST_TEST(advanceAndCollect(wheel, deadline - 1).empty());
+	BOOST_TEST(advanceAndCollect(wheel, deadline) == expected);
+	BOOST_TEST(!wheel.remove(reused, count));
+	BOOST_TEST(wheel.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_deadline_wheel_clear)
+{
+	DeadlineWheel<uint64_t> wheel;
+	const auto nearEntry = wheel.insert(1, 10);
+	wheel.insert(2, 100000);
+	BOOST_TEST(wheel.getNextTimeout().value() == 10u);
+
+	std::vector<uint64_t> removed;
+	wheel.clear(removed);
+	std::sort(removed.begin(), removed.end());
+	BOOST_TEST(removed == (std::vector<uint64_t>{1, 2}));
+	BOOST_TEST(wheel.empty());
+	BOOST_TEST(!wheel.getNextTimeout());
+
+	// entries from before the clear do not match the values that reuse their place
+	wheel.insert(1, 10);
+	BOOST_TEST(!wheel.remove(nearEntry, 1));
+	BOOST_TEST(wheel.getNextTimeout().value() == 10u);
+	BOOST_TEST(advanceAndCollect(wheel, 10) == std::vector<uint64_t>{1});
+}
@@ -0,0 +1,120 @@
+#define BOOST_TEST_MODULE itemblob
+
+#include "../otpch.h"
+
+#include "../fileloader.h"
+#include "../itemblob.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+std::string randomData(std::mt19937& rng, size_t size, uint32_t alphabet)
+{
+	std::string data(size, '\0');
+	for (auto& c : data) {
+		c = static_cast<char>(rng() % alphabet);
+	}
+	return data;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_itemblob_round_trip)
+{
+	std::mt19937 rng{1234};
+
+	std::string buffer;
+	for (size_t i = 0; i < 500; ++i) {
+		// a small alphabet compresses well, the full byte range mostly does not
+		const std::string data = randomData(rng, rng() % 8192, i % 2 == 0 ? 4 : 256);
+
+		const std::string blob = tfs::itemblob::pack(data);
+		const auto unpacked = tfs::itemblob::unpack(blob, buffer);
+		BOOST_TEST_REQUIRE(unpacked.has_value());
+		BOOST_TEST(*unpacked == data);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_itemblob_small_blob_is_not_copied)
+{
+	const std::string data = "a backpack with a few items";
+	BOOST_TEST_REQUIRE(data.size() < tfs::itemblob::COMPRESS_THRESHOLD);
+
+	const std::string blob = tfs::itemblob::pack(data);
+	BOOST_TEST(blob.size() == data.size() + 1);
+
+	std::string buffer;
+	const auto unpacked = tfs::itemblob::unpack(blob, buffer);
+	BOOST_TEST_REQUIRE(unpacked.has_value());
+	BOOST_TEST(*unpacked == data);
+	BOOST_TEST(unpacked->data() == blob.data() + 1);
+	BOOST_TEST(buffer.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_itemblob_large_blob_is_compressed)
+{
+	// a depot full of the same few items, like most depots are
+	std::string data;
+	for (size_t i = 0; i < 2000; ++i) {
+		data.append("\x0b\x0c\x01\x00\x0f\x05\x00", 7);
+	}
+
+	const std::string blob = tfs::itemblob::pack(data);
+	BOOST_TEST(blob.size() < data.size() / 10);
+
+	std::string buffer;
+	const auto unpacked = tfs::itemblob::unpack(blob, buffer);
+	BOOST_TEST_REQUIRE(unpacked.has_value());
+	BOOST_TEST(*unpacked == data);
+}
+
+BOOST_AUTO_TEST_CASE(test_itemblob_broken_blobs)
+{
+	std::mt19937 rng{99};
+	const std::string blob = tfs::itemblob::pack(randomData(rng, 4096, 8));
+
+	std::string buffer;
+	BOOST_TEST(!tfs::itemblob::unpack({}, buffer).has_value());
+	BOOST_TEST(!tfs::itemblob::unpack(std::string_view{blob}.substr(0, 3), buffer).has_value());
+	BOOST_TEST(!tfs::itemblob::unpack(std::string_view{blob}.substr(0, blob.size() / 2), buffer).has_value());
+
+	std::string unknownFormat = blob;
+	unknownFormat[0] = 7;
+	BOOST_TEST(!tfs::itemblob::unpack(unknownFormat, buffer).has_value());
+
+	// a size of several gigabytes must be refused before anything is allocated
+	std::string hugeSize = blob;
+	const uint32_t size = std::numeric_limits<uint32_t>::max();
+	std::memcpy(hugeSize.data() + 1, &size, sizeof(size));
+	BOOST_TEST(!tfs::itemblob::unpack(hugeSize, buffer).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(test_itemblob_prop_stream)
+{
+	// the item trees are read with a PropStream straight from the unpacked view
+	PropWriteStream writer;
+	for (uint16_t id = 100; id < 1100; ++id) {
+		writer.write<uint16_t>(id);
+		writer.writeString("item");
+		writer.write<uint8_t>(0x00);
+	}
+
+	std::string buffer;
+	const std::string blob = tfs::itemblob::pack(writer.getStream());
+	const auto unpacked = tfs::itemblob::unpack(blob, buffer);
+	BOOST_TEST_REQUIRE(unpacked.has_value());
+
+	PropStream reader;
+	reader.init(unpacked->data(), unpacked->size());
+	for (uint16_t id = 100; id < 1100; ++id) {
+		uint16_t readId = 0;
+		uint8_t end = 0;
+		BOOST_TEST_REQUIRE(reader.read<uint16_t>(readId));
+		BOOST_TEST(readId == id);
+		BOOST_TEST(reader.readString().first == "item");
+		BOOST_TEST_REQUIRE(reader.read<uint8_t>(end));
+		BOOST_TEST(end == 0);
+	}
+	BOOST_TEST(reader.size() == 0u);
+}
@@ -132,3 +132,47 @@ BOOST_FIXTURE_TEST_CASE(test_rsa_decrypt, PrivateKeyFixture)
 	tfs::rsa::decrypt(reinterpret_cast<uint8_t*>(encrypted.data()), encrypted.size());
 	BOOST_TEST(encrypted == plaintext, "expected '" << plaintext << "', got '" << encrypted << "'");
 }
+
+BOOST_FIXTURE_TEST_CASE(test_rsa_decrypt_reuses_thread_context, PrivateKeyFixture)
+{
+	tfs::rsa::loadPEM(privateKey);
+
+	// the same message as in test_rsa_decrypt
+	const std::string plaintext(128, 'x');
+	const std::string encrypted =
+	    "\x72\x17\x59\x03\xe4\xe9\xf8\x51\xce\x44\x0f\x83\x35\xbf\x65\xf0\x23\xe9\x80\xfc\x8c\x80\x43\x08\xa4\x0e\xd2\xc1\x1d\x7d"
+	    "\x03\x38\xb0\x3b\x0b\xb6\xd1\xf9\xf4\x55\xdc\x71\x12\xc2\x17\x92\xee\xd3\x22\xfa\xd4\x24\xd3\xd5\x05\x5d\x38\x34\xd4\x12"
+	    "\xdf\x3b\x0d\xc5\xa8\x59\xe5\x9d\x1f\x92\xb6\x3f\x54\x0a\xe0\x44\xeb\x6e\x55\x0a\x8e\xd0\xd1\xf7\x84\x1d\x3c\x0b\xcc\x3e"
+	    "\x2b\x08\x83\x3d\xa7\x83\x67\xb8\x3d\x49\xda\x13\xde\x41\x18\x7f\x42\xb2\x80\x8f\x9b\xe6\xfe\x4b\xb7\xe2\xab\x98\x0f\x4a"
+	    "\xdd\x52\xe9\xb1\x5b\xef\x25\x03";
+
+	auto decrypt = [&encrypted]() {
+		std::string message = encrypted;
+		tfs::rsa::decrypt(reinterpret_cast<uint8_t*>(message.data()), message.size());
+		return message;
+	};
+
+	// the first call sets the context of the thread up, the others reuse it
+	for (int i = 0; i < 3; ++i) {
+		BOOST_TEST(decrypt() == plaintext);
+	}
+
+	std::vector<std::string> results(4);
+	std::vector<std::thread> threads;
+	for (auto& result : results) {
+		threads.emplace_back([&decrypt, &result]() {
+			decrypt();
+			result = decrypt();
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	for (const auto& result : results) {
+		BOOST_TEST(result == plaintext);
+	}
+
+	// loading the key again replaces the contexts of the threads
+	tfs::rsa::loadPEM(privateKey);
+	BOOST_TEST(decrypt() == plaintext);
+}
@@ -0,0 +1,160 @@
+#define BOOST_TEST_MODULE savedrows
+
+#include "../otpch.h"
+
+#include "../savedrows.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+using Storage = SavedRows<uint32_t, int32_t>;
+
+// applies the changes to a table the way the statements of IOLoginData::snapshotPlayer do
+template <typename Key, typename Value>
+void applyChanges(std::map<Key, Value>& table, const typename SavedRows<Key, Value>::Changes& changes)
+{
+	if (changes.rewrite) {
+		table.clear();
+	}
+
+	for (const auto& key : changes.removals) {
+		table.erase(key);
+	}
+
+	for (const auto& [key, value] : changes.upserts) {
+		table.insert_or_assign(key, value);
+	}
+}
+
+void mutate(Storage::Rows& rows, std::mt19937& rng)
+{
+	for (size_t i = 0, count = rng() % 20; i < count; ++i) {
+		const uint32_t key = rng() % 200;
+		switch (rng() % 3) {
+			case 0:
+				rows.erase(key);
+				break;
+			default:
+				rows[key] = static_cast<int32_t>(rng() % 5);
+				break;
+		}
+	}
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_saved_rows_unchanged)
+{
+	Storage saved;
+	saved.reset({{1, 10}, {2, 20}});
+
+	BOOST_TEST(saved.update({{1, 10}, {2, 20}}, 1).empty());
+	saved.confirm(1, true);
+
+	const auto changes = saved.update({{1, 11}, {3, 30}}, 2);
+	BOOST_TEST(!changes.rewrite);
+	BOOST_TEST((changes.upserts == std::vector<std::pair<uint32_t, int32_t>>{{1, 11}, {3, 30}}));
+	BOOST_TEST(changes.removals == std::vector<uint32_t>{2});
+}
+
+BOOST_AUTO_TEST_CASE(test_saved_rows_match_full_rewrite)
+{
+	std::mt19937 rng{2024};
+
+	// the full rewrite is the oracle, the incremental table has to hold the same rows after every save
+	std::map<uint32_t, int32_t> rewrittenTable, incrementalTable;
+	Storage rewritten, incremental;
+
+	Storage::Rows rows;
+	for (uint32_t save = 1; save <= 2000; ++save) {
+		mutate(rows, rng);
+
+		const auto fullChanges = rewritten.update(rows, save, true);
+		BOOST_TEST(fullChanges.rewrite);
+		applyChanges(rewrittenTable, fullChanges);
+		rewritten.confirm(save, true);
+
+		const auto changes = incremental.update(rows, save);
+		BOOST_TEST((changes.rewrite == (save == 1)));
+		applyChanges(incrementalTable, changes);
+		incremental.confirm(save, true);
+
+		BOOST_TEST((rewrittenTable == rows));
+		BOOST_TEST((incrementalTable == rewrittenTable));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_saved_rows_failed_save)
+{
+	Storage saved;
+	saved.reset({{1, 10}, {2, 20}});
+	std::map<uint32_t, int32_t> table = {{1, 10}, {2, 20}};
+
+	// the second snapshot is taken while the first one is still being written
+	const Storage::Rows first = {{1, 11}, {2, 20}, {3, 30}};
+	const Storage::Rows second = {{1, 11}, {3, 30}, {4, 40}};
+	saved.update(first, 1);
+	const auto changes = saved.update(second, 2);
+
+	// the first write fails, the second one still has to bring the table to its rows on its own
+	saved.confirm(1, false);
+	applyChanges(table, changes);
+	saved.confirm(2, true);
+	BOOST_TEST((table == second));
+	BOOST_TEST(saved.getPendingCount() == 0u);
+
+	BOOST_TEST(saved.update(second, 3).empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_saved_rows_failed_saves_in_flight)
+{
+	std::mt19937 rng{77};
+
+	std::map<uint32_t, int32_t> table;
+	Storage saved;
+	saved.reset(table);
+
+	// snapshots are queued like on the database thread and written in order, some writes fail and their
+	// confirmation only arrives after later snapshots were already taken
+	std::deque<std::tuple<uint32_t, Storage::Changes, Storage::Rows>> queue;
+	Storage::Rows rows;
+	uint32_t nextSave = 0;
+	size_t failed = 0;
+	for (size_t step = 0; step < 5000; ++step) {
+		if (queue.empty() || rng() % 2 == 0) {
+			mutate(rows, rng);
+			const uint32_t save = ++nextSave;
+			queue.emplace_back(save, saved.update(rows, save), rows);
+			continue;
+		}
+
+		auto [save, changes, expected] = std::move(queue.front());
+		queue.pop_front();
+
+		if (rng() % 4 == 0) {
+			// the transaction is rolled back, the table is left as it was
+			saved.confirm(save, false);
+			++failed;
+			continue;
+		}
+
+		applyChanges(table, changes);
+		saved.confirm(save, true);
+		BOOST_TEST((table == expected));
+	}
+
+	BOOST_TEST(failed > 0u);
+	BOOST_TEST(saved.getPendingCount() == queue.size());
+}
+
+BOOST_AUTO_TEST_CASE(test_saved_rows_keys_only)
+{
+	SavedRows<std::string> spells;
+	spells.reset({{"exura", {}}, {"utani hur", {}}});
+
+	const auto changes = spells.update({{"exura", {}}, {"exori", {}}}, 1);
+	BOOST_TEST(changes.upserts.size() == 1u);
+	BOOST_TEST(changes.upserts.front().first == "exori");
+	BOOST_TEST(changes.removals == std::vector<std::string>{"utani hur"});
+}
@@ -0,0 +1,105 @@
+#define BOOST_TEST_MODULE scheduler
+
+#include "../otpch.h"
+
+#include "../scheduler.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+std::vector<uint64_t> advanceAndCollect(TimerWheel& wheel, uint64_t tick)
+{
+	std::vector<SchedulerTask*> expired;
+	wheel.advance(tick, expired);
+
+	std::vector<uint64_t> delays;
+	for (auto task : expired) {
+		delays.push_back(task->getDelay());
+		delete task;
+	}
+	return delays;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_timer_wheel_expires_near_tasks_in_order)
+{
+	TimerWheel wheel;
+	wheel.insert(createSchedulerTask(20, [] {}), 20);
+	wheel.insert(createSchedulerTask(10, [] {}), 10);
+	wheel.insert(createSchedulerTask(11, [] {}), 10);
+
+	BOOST_TEST(wheel.size() == 3u);
+	BOOST_TEST(wheel.getNextTimeout().value() == 10u);
+
+	BOOST_TEST(advanceAndCollect(wheel, 9).empty());
+	BOOST_TEST(advanceAndCollect(wheel, 10) == (std::vector<uint64_t>{10, 11}));
+	BOOST_TEST(advanceAndCollect(wheel, 100) == (std::vector<uint64_t>{20}));
+	BOOST_TEST(wheel.empty());
+	BOOST_TEST(!wheel.getNextTimeout());
+}
+
+BOOST_AUTO_TEST_CASE(test_timer_wheel_cascades_every_level)
+{
+	// boundaries of the near level, every upper level and the overflow list
+	const std::vector<uint64_t> deadlines = {1,       255,     256,      257,      16383,    16384,
+	                                         70000,   1048575, 1048576,  5000000,  67108863, 67108864,
+	                                         90000000};
+
+	TimerWheel wheel;
+	for (auto deadline : deadlines) {
+		wheel.insert(createSchedulerTask(deadline, [] {}), deadline);
+	}
+
+	// step exactly to every deadline, nothing may expire early or late
+	for (auto deadline : deadlines) {
+		BOOST_TEST(advanceAndCollect(wheel, deadline - 1).empty());
+		BOOST_TEST(advanceAndCollect(wheel, deadline) == std::vector<uint64_t>{deadline});
+	}
+	BOOST_TEST(wheel.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_timer_wheel_remove)
+{
+	TimerWheel wheel;
+	auto first = createSchedulerTask(1, [] {});
+	auto second = createSchedulerTask(2, [] {});
+	auto far = createSchedulerTask(3, [] {});
+	wheel.insert(first, 5);
+	wheel.insert(second, 5);
+	wheel.insert(far, 100000);
+
+	wheel.remove(first);
+	delete first;
+	wheel.remove(far);
+	delete far;
+
+	BOOST_TEST(wheel.size() == 1u);
+	BOOST_TEST(advanceAndCollect(wheel, 200000) == std::vector<uint64_t>{2});
+}
+
+BOOST_AUTO_TEST_CASE(test_timer_wheel_next_timeout_stops_at_cascade)
+{
+	TimerWheel wheel;
+	wheel.insert(createSchedulerTask(1, [] {}), 1000);
+
+	// the task lives in an upper level, so the wheel has to wake up when the near level wraps
+	BOOST_TEST(wheel.getNextTimeout().value() == TimerWheel::NEAR_SIZE);
+
+	BOOST_TEST(advanceAndCollect(wheel, TimerWheel::NEAR_SIZE * 3).empty());
+	BOOST_TEST(wheel.getNextTimeout().value() == 1000u - TimerWheel::NEAR_SIZE * 3);
+	BOOST_TEST(advanceAndCollect(wheel, 1000) == std::vector<uint64_t>{1});
+}
+
+BOOST_AUTO_TEST_CASE(test_timer_wheel_insert_in_the_past)
+{
+	TimerWheel wheel;
+	wheel.insert(createSchedulerTask(1, [] {}), 50);
+	BOOST_TEST(advanceAndCollect(wheel, 50).size() == 1u);
+
+	// a task can never expire in the tick that has already been processed
+	wheel.insert(createSchedulerTask(2, [] {}), 10);
+	BOOST_TEST(wheel.getNextTimeout().value() == 1u);
+	BOOST_TEST(advanceAndCollect(wheel, 51) == std::vector<uint64_t>{2});
+}
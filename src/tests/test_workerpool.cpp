@@ -0,0 +1,261 @@
+#define BOOST_TEST_MODULE workerpool
+
+#include "../otpch.h"
+
+#include "../creature.h"
+#include "../workerpool.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+constexpr size_t WALKER_COUNT = 2000;
+constexpr uint16_t AREA_SIZE = 64;
+
+struct Walker
+{
+	Position pos;
+	size_t target;
+	FindPathParams fpp;
+};
+
+// Stands in for Map::getPathMatching: the result only depends on the start, the target and the parameters
+bool searchPath(const Position& start, const Position& target, const FindPathParams& fpp,
+                std::vector<Direction>& dirList)
+{
+	dirList.clear();
+	Position pos = start;
+	while (pos != target && dirList.size() < static_cast<size_t>(fpp.maxSearchDist)) {
+		if (pos.x != target.x) {
+			dirList.push_back(pos.x < target.x ? DIRECTION_EAST : DIRECTION_WEST);
+			pos.x += pos.x < target.x ? 1 : -1;
+		} else {
+			dirList.push_back(pos.y < target.y ? DIRECTION_SOUTH : DIRECTION_NORTH);
+			pos.y += pos.y < target.y ? 1 : -1;
+		}
+	}
+	return pos == target;
+}
+
+void step(Position& pos, Direction dir)
+{
+	switch (dir) {
+		case DIRECTION_EAST:
+			pos.x = std::min<uint16_t>(pos.x + 1, AREA_SIZE - 1);
+			break;
+		case DIRECTION_WEST:
+			pos.x = std::max<uint16_t>(pos.x, 1) - 1;
+			break;
+		case DIRECTION_SOUTH:
+			pos.y = std::min<uint16_t>(pos.y + 1, AREA_SIZE - 1);
+			break;
+		default:
+			pos.y = std::max<uint16_t>(pos.y, 1) - 1;
+			break;
+	}
+}
+
+// Breadth-first search on the area that goes around the blocked positions, the directions are tried in a fixed order
+// so the same map always gives the same path
+bool searchPathAround(const Position& start, const Position& target, const std::set<Position>& blocked,
+                      std::vector<Direction>& dirList)
+{
+	dirList.clear();
+	std::map<Position, std::pair<Position, Direction>> cameFrom;
+	std::deque<Position> open{start};
+	cameFrom.emplace(start, std::make_pair(start, DIRECTION_NONE));
+	while (!open.empty()) {
+		Position pos = open.front();
+		open.pop_front();
+		if (pos == target) {
+			while (pos != start) {
+				const auto& [previous, dir] = cameFrom[pos];
+				dirList.insert(dirList.begin(), dir);
+				pos = previous;
+			}
+			return true;
+		}
+
+		for (Direction dir : {DIRECTION_EAST, DIRECTION_SOUTH, DIRECTION_WEST, DIRECTION_NORTH}) {
+			Position next = pos;
+			step(next, dir);
+			if (next != pos && !blocked.contains(next) && cameFrom.emplace(next, std::make_pair(pos, dir)).second) {
+				open.push_back(next);
+			}
+		}
+	}
+	return false;
+}
+
+struct WalkResult
+{
+	std::vector<Position> positions;
+	size_t taken = 0;
+	size_t searchedAgain = 0;
+};
+
+// Plans the paths of all walkers on the pool and hands them out in walker order through PlannedPath::take, the same
+// way Game::updateCreaturesPath and Creature::updateFollowCreaturePath do. Without a pool every path is searched when
+// it is handed out, which is what the serial path does. Taking a step moves the walker, and sometimes its target, so
+// later plans of the round go stale.
+WalkResult walk(WorkerPool* pool, uint32_t seed)
+{
+	std::mt19937 rng{seed};
+	std::vector<Walker> walkers(WALKER_COUNT);
+	for (size_t i = 0; i < WALKER_COUNT; ++i) {
+		auto& walker = walkers[i];
+		walker.pos = Position(rng() % AREA_SIZE, rng() % AREA_SIZE, 7);
+		walker.target = (i * 7 + 3) % WALKER_COUNT;
+		walker.fpp.maxSearchDist = 16 + rng() % 64;
+	}
+
+	WalkResult result;
+	for (size_t round = 0; round < 10; ++round) {
+		std::vector<std::optional<PlannedPath>> plans(WALKER_COUNT);
+		if (pool) {
+			pool->parallelFor(WALKER_COUNT, [&](size_t i) {
+				const Walker& walker = walkers[i];
+				PlannedPath& path = plans[i].emplace();
+				path.startPos = walker.pos;
+				path.targetPos = walkers[walker.target].pos;
+				path.fpp = walker.fpp;
+				path.found = searchPath(path.startPos, path.targetPos, path.fpp, path.dirList);
+			});
+		}
+
+		for (size_t i = 0; i < WALKER_COUNT; ++i) {
+			Walker& walker = walkers[i];
+			const Position& targetPos = walkers[walker.target].pos;
+
+			std::vector<Direction> dirList;
+			std::optional<bool> found;
+			if (plans[i]) {
+				// the toy map has no obstacles, so every tile of a planned path stays walkable
+				found = plans[i]->take(walker.pos, targetPos, walker.fpp, dirList,
+				                       [](const Position&) { return true; });
+				if (found) {
+					++result.taken;
+				} else {
+					++result.searchedAgain;
+				}
+			}
+
+			if (!found) {
+				found = searchPath(walker.pos, targetPos, walker.fpp, dirList);
+			}
+
+			if (*found && !dirList.empty()) {
+				step(walker.pos, dirList.front());
+			}
+
+			if (rng() % 4 == 0) {
+				step(walkers[walker.target].pos, static_cast<Direction>(rng() % 4));
+			}
+		}
+	}
+
+	for (const auto& walker : walkers) {
+		result.positions.push_back(walker.pos);
+	}
+	return result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_worker_pool_runs_every_index_once)
+{
+	WorkerPool pool;
+	pool.start(4);
+
+	for (size_t count : {0, 1, 2, 3, 1000, 100000}) {
+		std::vector<std::atomic<uint32_t>> calls(count);
+		pool.parallelFor(count, [&](size_t i) { calls[i].fetch_add(1, std::memory_order_relaxed); });
+
+		BOOST_TEST(std::all_of(calls.begin(), calls.end(), [](const auto& c) { return c.load() == 1; }));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_worker_pool_planned_paths_match_serial)
+{
+	const auto expected = walk(nullptr, 1234);
+
+	for (size_t threads : {0, 1, 2, 3, 8}) {
+		WorkerPool pool;
+		pool.start(threads);
+
+		for (size_t run = 0; run < 3; ++run) {
+			const auto result = walk(&pool, 1234);
+			BOOST_TEST(result.positions == expected.positions);
+			// both kinds of hand out have to happen for the comparison to mean anything
+			BOOST_TEST(result.taken > 0u);
+			BOOST_TEST(result.searchedAgain > 0u);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_worker_pool_planned_path_blocked_after_search)
+{
+	const Position start(10, 10, 7);
+	const Position target(20, 10, 7);
+	std::set<Position> blocked;
+
+	WorkerPool pool;
+	pool.start(2);
+
+	PlannedPath path;
+	pool.parallelFor(1, [&](size_t) {
+		path.startPos = start;
+		path.targetPos = target;
+		path.found = searchPathAround(start, target, blocked, path.dirList);
+	});
+	BOOST_TEST(path.found);
+	BOOST_TEST(path.dirList.size() == 10u);
+
+	// something is put on the path after it was planned
+	blocked.insert(Position(15, 10, 7));
+	const auto isWalkable = [&](const Position& pos) { return !blocked.contains(pos); };
+
+	std::vector<Direction> dirList;
+	BOOST_TEST(!path.take(start, target, path.fpp, dirList, isWalkable).has_value());
+
+	// searching again gives what the serial path would have walked
+	std::vector<Direction> expected;
+	BOOST_TEST(searchPathAround(start, target, blocked, expected));
+	BOOST_TEST(searchPathAround(start, target, blocked, dirList));
+	BOOST_TEST(dirList == expected);
+
+	Position pos = start;
+	for (Direction dir : dirList) {
+		pos = getNextPosition(dir, pos);
+		BOOST_TEST(isWalkable(pos));
+	}
+	BOOST_TEST(pos == target);
+
+	// a path that is still clear is taken as planned
+	PlannedPath clearPath;
+	clearPath.startPos = start;
+	clearPath.targetPos = target;
+	clearPath.found = searchPathAround(start, target, blocked, clearPath.dirList);
+	const auto planned = clearPath.dirList;
+
+	dirList.clear();
+	const auto found = clearPath.take(start, target, clearPath.fpp, dirList, isWalkable);
+	BOOST_TEST(found.has_value());
+	BOOST_TEST(found.value_or(false));
+	BOOST_TEST(dirList == planned);
+}
+
+BOOST_AUTO_TEST_CASE(test_worker_pool_shutdown)
+{
+	WorkerPool pool;
+	pool.start(2);
+	BOOST_TEST(pool.getThreadCount() == 2u);
+
+	pool.shutdown();
+	BOOST_TEST(pool.getThreadCount() == 0u);
+
+	// without workers the jobs run in order on the calling thread
+	std::vector<size_t> order;
+	pool.parallelFor(5, [&](size_t i) { order.push_back(i); });
+	BOOST_TEST(order == (std::vector<size_t>{0, 1, 2, 3, 4}));
+}
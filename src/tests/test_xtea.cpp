@@ -42,3 +42,60 @@ BOOST_AUTO_TEST_CASE(test_xtea_decrypt)
 
 	BOOST_TEST(data == expected);
 }
+
+BOOST_AUTO_TEST_CASE(test_xtea_kernels_match_scalar)
+{
+	std::mt19937 rng{0x7ea};
+	std::uniform_int_distribution<uint32_t> word;
+
+	const auto kernels = xtea::supported_kernels();
+	BOOST_TEST_REQUIRE((kernels.front() == xtea::kernel::scalar));
+
+	for (size_t run = 0; run < 500; ++run) {
+		const auto roundKeys = xtea::expand_key({word(rng), word(rng), word(rng), word(rng)});
+
+		// every length up to a few vector sets, then anything up to the largest packets
+		const size_t blocks = run < 100 ? run : rng() % 3000;
+		std::vector<uint8_t> plain(blocks * 8);
+		std::generate(plain.begin(), plain.end(), [&]() { return static_cast<uint8_t>(rng()); });
+
+		auto expected = plain;
+		xtea::encrypt(expected.data(), expected.size(), roundKeys, xtea::kernel::scalar);
+
+		for (auto kernel : kernels) {
+			auto data = plain;
+			xtea::encrypt(data.data(), data.size(), roundKeys, kernel);
+			BOOST_TEST_REQUIRE(data == expected);
+
+			xtea::decrypt(data.data(), data.size(), roundKeys, kernel);
+			BOOST_TEST_REQUIRE(data == plain);
+		}
+
+		// the default functions pick one of the kernels
+		auto data = plain;
+		xtea::encrypt(data.data(), data.size(), roundKeys);
+		BOOST_TEST_REQUIRE(data == expected);
+		xtea::decrypt(data.data(), data.size(), roundKeys);
+		BOOST_TEST_REQUIRE(data == plain);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_xtea_kernels_known_vector)
+{
+	const auto roundKeys = xtea::expand_key({0xdeadbeef, 0xdeadbeef, 0xdeadbeef, 0xdeadbeef});
+	const auto block = std::vector<uint8_t>{0xef, 0xbe, 0xad, 0xde, 0xef, 0xbe, 0xad, 0xde};
+	const auto encrypted = std::vector<uint8_t>{0xb5, 0x8c, 0xf2, 0xfa, 0xe0, 0xc0, 0x40, 0x09};
+
+	// enough copies of the block to go through every path of the vector kernels
+	for (auto kernel : xtea::supported_kernels()) {
+		std::vector<uint8_t> data;
+		for (size_t i = 0; i < 31; ++i) {
+			data.insert(data.end(), block.begin(), block.end());
+		}
+
+		xtea::encrypt(data.data(), data.size(), roundKeys, kernel);
+		for (size_t i = 0; i < data.size(); i += 8) {
+			BOOST_TEST(std::vector<uint8_t>(data.begin() + i, data.begin() + i + 8) == encrypted);
+		}
+	}
+}
@@ -820,10 +820,7 @@ void Tile::addThing(int32_t, Thing* thing)
 {
 	Creature* creature = thing->getCreature();
 	if (creature) {
-		g_game.map.clearSpectatorCache();
-		if (creature->getPlayer()) {
-			g_game.map.clearPlayersSpectatorCache();
-		}
+		g_game.map.clearSpectatorCache(getPosition(), creature->getPlayer() != nullptr);
 
 		creature->setParent(this);
 		CreatureVector* creatures = makeCreatures();
@@ -1031,10 +1028,7 @@ void Tile::removeThing(Thing* thing, uint32_t count)
 		if (creatures) {
 			auto it = std::find(creatures->begin(), creatures->end(), thing);
 			if (it != creatures->end()) {
-				g_game.map.clearSpectatorCache();
-				if (creature->getPlayer()) {
-					g_game.map.clearPlayersSpectatorCache();
-				}
+				g_game.map.clearSpectatorCache(getPosition(), creature->getPlayer() != nullptr);
 
 				creatures->erase(it);
 			}
@@ -1404,10 +1398,7 @@ void Tile::internalAddThing(uint32_t, Thing* thing)
 
 	Creature* creature = thing->getCreature();
 	if (creature) {
-		g_game.map.clearSpectatorCache();
-		if (creature->getPlayer()) {
-			g_game.map.clearPlayersSpectatorCache();
-		}
+		g_game.map.clearSpectatorCache(getPosition(), creature->getPlayer() != nullptr);
 
 		CreatureVector* creatures = makeCreatures();
 		creatures->insert(creatures->begin(), creature);
@@ -0,0 +1,97 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "workerpool.h"
+
+WorkerPool::~WorkerPool() { shutdown(); }
+
+void WorkerPool::start(size_t threadCount)
+{
+	stopping = false;
+
+	threads.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i) {
+		threads.emplace_back(&WorkerPool::threadMain, this);
+	}
+}
+
+void WorkerPool::shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lockClass(mutex);
+		stopping = true;
+	}
+	jobSignal.notify_all();
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	threads.clear();
+}
+
+void WorkerPool::parallelFor(size_t count, const std::function<void(size_t)>& func)
+{
+	if (threads.empty() || count <= 1) {
+		for (size_t i = 0; i < count; ++i) {
+			func(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lockClass(mutex);
+		job = &func;
+		jobCount = count;
+		nextIndex.store(0, std::memory_order_relaxed);
+		++jobGeneration;
+	}
+	jobSignal.notify_all();
+
+	runJobs(func, count);
+
+	std::unique_lock<std::mutex> lockClass(mutex);
+	doneSignal.wait(lockClass, [this]() { return activeWorkers == 0; });
+
+	// every index has been claimed by now, a worker that wakes up late must not touch the finished job
+	job = nullptr;
+}
+
+void WorkerPool::threadMain()
+{
+	uint64_t seenGeneration = 0;
+
+	std::unique_lock<std::mutex> lockClass(mutex);
+	while (true) {
+		jobSignal.wait(lockClass, [&]() { return stopping || jobGeneration != seenGeneration; });
+		if (stopping) {
+			return;
+		}
+
+		seenGeneration = jobGeneration;
+		if (!job) {
+			continue;
+		}
+
+		const auto& func = *job;
+		const size_t count = jobCount;
+		++activeWorkers;
+
+		lockClass.unlock();
+		runJobs(func, count);
+		lockClass.lock();
+
+		if (--activeWorkers == 0) {
+			doneSignal.notify_one();
+		}
+	}
+}
+
+void WorkerPool::runJobs(const std::function<void(size_t)>& func, size_t count)
+{
+	size_t index;
+	while ((index = nextIndex.fetch_add(1, std::memory_order_relaxed)) < count) {
+		func(index);
+	}
+}
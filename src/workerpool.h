@@ -0,0 +1,49 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_WORKERPOOL_H
+#define FS_WORKERPOOL_H
+
+// Fixed set of threads that help the calling thread run one batch of independent jobs at a time. Used by the
+// dispatcher for work that only reads the game state, the caller blocks until the whole batch is done, so nothing can
+// change the state while the workers read it.
+class WorkerPool
+{
+public:
+	WorkerPool() = default;
+	~WorkerPool();
+
+	// non-copyable
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	void start(size_t threadCount);
+	void shutdown();
+
+	size_t getThreadCount() const { return threads.size(); }
+
+	// Calls func(i) for every i in [0, count), spread over the workers and the calling thread, and returns once all
+	// calls have finished. The order of the calls is unspecified, results should be written to slot i and combined
+	// afterwards. Without workers the calls are made in order on the calling thread.
+	void parallelFor(size_t count, const std::function<void(size_t)>& func);
+
+private:
+	void threadMain();
+	void runJobs(const std::function<void(size_t)>& func, size_t count);
+
+	std::vector<std::thread> threads;
+
+	std::mutex mutex;
+	std::condition_variable jobSignal;
+	std::condition_variable doneSignal;
+
+	const std::function<void(size_t)>* job = nullptr;
+	size_t jobCount = 0;
+	uint64_t jobGeneration = 0;
+	size_t activeWorkers = 0;
+	bool stopping = false;
+
+	std::atomic<size_t> nextIndex{0};
+};
+
+#endif // FS_WORKERPOOL_H
@@ -7,23 +7,27 @@
 
 #include <cstring>
 
-namespace xtea {
+#if defined(__x86_64__) || defined(_M_X64)
+#define XTEA_X86_64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
 
-round_keys expand_key(const key& k)
-{
-	constexpr uint32_t delta = 0x9E3779B9;
-	round_keys expanded;
+#if defined(__GNUC__) || defined(__clang__)
+#define XTEA_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define XTEA_TARGET_AVX2
+#endif
 
-	for (uint32_t i = 0, sum = 0, next_sum = sum + delta; i < expanded.size();
-	     i += 2, sum = next_sum, next_sum += delta) {
-		expanded[i] = sum + k[sum & 3];
-		expanded[i + 1] = next_sum + k[(next_sum >> 11) & 3];
-	}
+namespace xtea {
 
-	return expanded;
-}
+namespace {
+
+constexpr size_t BLOCK_SIZE = 8;
 
-void encrypt(uint8_t* data, size_t length, const round_keys& k)
+void encrypt_scalar(uint8_t* data, size_t length, const round_keys& k)
 {
 	for (auto i = 0u; i < k.size(); i += 2) {
 		for (auto it = data, last = data + length; it < last; it += 8) {
@@ -40,7 +44,7 @@ void encrypt(uint8_t* data, size_t length, const round_keys& k)
 	}
 }
 
-void decrypt(uint8_t* data, size_t length, const round_keys& k)
+void decrypt_scalar(uint8_t* data, size_t length, const round_keys& k)
 {
 	for (auto i = k.size(); i > 0; i -= 2) {
 		for (auto it = data, last = data + length; it < last; it += 8) {
@@ -57,4 +61,278 @@ void decrypt(uint8_t* data, size_t length, const round_keys& k)
 	}
 }
 
+#ifdef XTEA_X86_64
+
+// The vector kernels keep the left halves of several blocks in one register and the right halves in another, so
+// every instruction of a round works on all of them. Sets of blocks are processed side by side to hide the latency of
+// the rounds, which all depend on the previous one.
+
+// SSE2 is part of every x86-64 CPU, it needs no detection
+
+constexpr size_t SSE2_BLOCKS = 4;
+
+// [L0 R0 L1 R1] [L2 R2 L3 R3] -> [L0 L1 L2 L3] [R0 R1 R2 R3]
+inline void load_sse2(const uint8_t* data, __m128i& left, __m128i& right)
+{
+	const __m128i a = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), 0xD8);
+	const __m128i b = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)), 0xD8);
+	left = _mm_unpacklo_epi64(a, b);
+	right = _mm_unpackhi_epi64(a, b);
+}
+
+inline void store_sse2(uint8_t* data, __m128i left, __m128i right)
+{
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(data), _mm_shuffle_epi32(_mm_unpacklo_epi64(left, right), 0xD8));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(data + 16),
+	                 _mm_shuffle_epi32(_mm_unpackhi_epi64(left, right), 0xD8));
+}
+
+// ((v << 4 ^ v >> 5) + v) ^ key
+inline __m128i mix_sse2(__m128i v, uint32_t key)
+{
+	const __m128i shifted = _mm_xor_si128(_mm_slli_epi32(v, 4), _mm_srli_epi32(v, 5));
+	return _mm_xor_si128(_mm_add_epi32(shifted, v), _mm_set1_epi32(static_cast<int>(key)));
+}
+
+template <size_t Sets>
+void encrypt_sse2_blocks(uint8_t* data, const round_keys& k)
+{
+	__m128i left[Sets], right[Sets];
+	for (size_t s = 0; s < Sets; ++s) {
+		load_sse2(data + s * SSE2_BLOCKS * BLOCK_SIZE, left[s], right[s]);
+	}
+
+	for (size_t i = 0; i < k.size(); i += 2) {
+		for (size_t s = 0; s < Sets; ++s) {
+			left[s] = _mm_add_epi32(left[s], mix_sse2(right[s], k[i]));
+			right[s] = _mm_add_epi32(right[s], mix_sse2(left[s], k[i + 1]));
+		}
+	}
+
+	for (size_t s = 0; s < Sets; ++s) {
+		store_sse2(data + s * SSE2_BLOCKS * BLOCK_SIZE, left[s], right[s]);
+	}
+}
+
+template <size_t Sets>
+void decrypt_sse2_blocks(uint8_t* data, const round_keys& k)
+{
+	__m128i left[Sets], right[Sets];
+	for (size_t s = 0; s < Sets; ++s) {
+		load_sse2(data + s * SSE2_BLOCKS * BLOCK_SIZE, left[s], right[s]);
+	}
+
+	for (size_t i = k.size(); i > 0; i -= 2) {
+		for (size_t s = 0; s < Sets; ++s) {
+			right[s] = _mm_sub_epi32(right[s], mix_sse2(left[s], k[i - 1]));
+			left[s] = _mm_sub_epi32(left[s], mix_sse2(right[s], k[i - 2]));
+		}
+	}
+
+	for (size_t s = 0; s < Sets; ++s) {
+		store_sse2(data + s * SSE2_BLOCKS * BLOCK_SIZE, left[s], right[s]);
+	}
+}
+
+template <void (*Single)(uint8_t*, const round_keys&), void (*Double)(uint8_t*, const round_keys&),
+          void (*Tail)(uint8_t*, size_t, const round_keys&), size_t Blocks>
+void crypt_vector(uint8_t* data, size_t length, const round_keys& k)
+{
+	constexpr size_t setSize = Blocks * BLOCK_SIZE;
+
+	auto it = data, last = data + length;
+	for (; last - it >= static_cast<ptrdiff_t>(2 * setSize); it += 2 * setSize) {
+		Double(it, k);
+	}
+	if (last - it >= static_cast<ptrdiff_t>(setSize)) {
+		Single(it, k);
+		it += setSize;
+	}
+	Tail(it, last - it, k);
+}
+
+void encrypt_sse2(uint8_t* data, size_t length, const round_keys& k)
+{
+	crypt_vector<encrypt_sse2_blocks<1>, encrypt_sse2_blocks<2>, encrypt_scalar, SSE2_BLOCKS>(data, length, k);
+}
+
+void decrypt_sse2(uint8_t* data, size_t length, const round_keys& k)
+{
+	crypt_vector<decrypt_sse2_blocks<1>, decrypt_sse2_blocks<2>, decrypt_scalar, SSE2_BLOCKS>(data, length, k);
+}
+
+// AVX2 works on two independent 128 bit lanes, the blocks end up in a different order within the registers than in
+// memory, which does not matter as long as they are stored back the same way
+
+constexpr size_t AVX2_BLOCKS = 8;
+
+XTEA_TARGET_AVX2 inline void load_avx2(const uint8_t* data, __m256i& left, __m256i& right)
+{
+	const __m256i a = _mm256_shuffle_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)), 0xD8);
+	const __m256i b = _mm256_shuffle_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32)), 0xD8);
+	left = _mm256_unpacklo_epi64(a, b);
+	right = _mm256_unpackhi_epi64(a, b);
+}
+
+XTEA_TARGET_AVX2 inline void store_avx2(uint8_t* data, __m256i left, __m256i right)
+{
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(data),
+	                    _mm256_shuffle_epi32(_mm256_unpacklo_epi64(left, right), 0xD8));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(data + 32),
+	                    _mm256_shuffle_epi32(_mm256_unpackhi_epi64(left, right), 0xD8));
+}
+
+XTEA_TARGET_AVX2 inline __m256i mix_avx2(__m256i v, uint32_t key)
+{
+	const __m256i shifted = _mm256_xor_si256(_mm256_slli_epi32(v, 4), _mm256_srli_epi32(v, 5));
+	return _mm256_xor_si256(_mm256_add_epi32(shifted, v), _mm256_set1_epi32(static_cast<int>(key)));
+}
+
+template <size_t Sets>
+XTEA_TARGET_AVX2 void encrypt_avx2_blocks(uint8_t* data, const round_keys& k)
+{
+	__m256i left[Sets], right[Sets];
+	for (size_t s = 0; s < Sets; ++s) {
+		load_avx2(data + s * AVX2_BLOCKS * BLOCK_SIZE, left[s], right[s]);
+	}
+
+	for (size_t i = 0; i < k.size(); i += 2) {
+		for (size_t s = 0; s < Sets; ++s) {
+			left[s] = _mm256_add_epi32(left[s], mix_avx2(right[s], k[i]));
+			right[s] = _mm256_add_epi32(right[s], mix_avx2(left[s], k[i + 1]));
+		}
+	}
+
+	for (size_t s = 0; s < Sets; ++s) {
+		store_avx2(data + s * AVX2_BLOCKS * BLOCK_SIZE, left[s], right[s]);
+	}
+}
+
+template <size_t Sets>
+XTEA_TARGET_AVX2 void decrypt_avx2_blocks(uint8_t* data, const round_keys& k)
+{
+	__m256i left[Sets], right[Sets];
+	for (size_t s = 0; s < Sets; ++s) {
+		load_avx2(data + s * AVX2_BLOCKS * BLOCK_SIZE, left[s], right[s]);
+	}
+
+	for (size_t i = k.size(); i > 0; i -= 2) {
+		for (size_t s = 0; s < Sets; ++s) {
+			right[s] = _mm256_sub_epi32(right[s], mix_avx2(left[s], k[i - 1]));
+			left[s] = _mm256_sub_epi32(left[s], mix_avx2(right[s], k[i - 2]));
+		}
+	}
+
+	for (size_t s = 0; s < Sets; ++s) {
+		store_avx2(data + s * AVX2_BLOCKS * BLOCK_SIZE, left[s], right[s]);
+	}
+}
+
+// what is left after the AVX2 sets goes through the SSE2 kernel, which finishes with the scalar one
+void encrypt_avx2(uint8_t* data, size_t length, const round_keys& k)
+{
+	crypt_vector<encrypt_avx2_blocks<1>, encrypt_avx2_blocks<2>, encrypt_sse2, AVX2_BLOCKS>(data, length, k);
+}
+
+void decrypt_avx2(uint8_t* data, size_t length, const round_keys& k)
+{
+	crypt_vector<decrypt_avx2_blocks<1>, decrypt_avx2_blocks<2>, decrypt_sse2, AVX2_BLOCKS>(data, length, k);
+}
+
+bool cpu_supports_avx2()
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+
+	// the operating system has to save the AVX registers on context switches
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6) {
+		return false;
+	}
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return false;
+#endif
+}
+
+#endif
+
+using crypt_function = void (*)(uint8_t*, size_t, const round_keys&);
+
+struct kernel_functions
+{
+	crypt_function encrypt;
+	crypt_function decrypt;
+};
+
+kernel_functions get_kernel_functions(kernel which)
+{
+	switch (which) {
+#ifdef XTEA_X86_64
+		case kernel::sse2:
+			return {encrypt_sse2, decrypt_sse2};
+		case kernel::avx2:
+			return {encrypt_avx2, decrypt_avx2};
+#endif
+		default:
+			return {encrypt_scalar, decrypt_scalar};
+	}
+}
+
+const kernel_functions& best_kernel_functions()
+{
+	static const kernel_functions functions = get_kernel_functions(supported_kernels().back());
+	return functions;
+}
+
+} // namespace
+
+round_keys expand_key(const key& k)
+{
+	constexpr uint32_t delta = 0x9E3779B9;
+	round_keys expanded;
+
+	for (uint32_t i = 0, sum = 0, next_sum = sum + delta; i < expanded.size();
+	     i += 2, sum = next_sum, next_sum += delta) {
+		expanded[i] = sum + k[sum & 3];
+		expanded[i + 1] = next_sum + k[(next_sum >> 11) & 3];
+	}
+
+	return expanded;
+}
+
+void encrypt(uint8_t* data, size_t length, const round_keys& k) { best_kernel_functions().encrypt(data, length, k); }
+
+void decrypt(uint8_t* data, size_t length, const round_keys& k) { best_kernel_functions().decrypt(data, length, k); }
+
+std::vector<kernel> supported_kernels()
+{
+	std::vector<kernel> kernels{kernel::scalar};
+#ifdef XTEA_X86_64
+	kernels.push_back(kernel::sse2);
+	if (cpu_supports_avx2()) {
+		kernels.push_back(kernel::avx2);
+	}
+#endif
+	return kernels;
+}
+
+void encrypt(uint8_t* data, size_t length, const round_keys& k, kernel which)
+{
+	get_kernel_functions(which).encrypt(data, length, k);
+}
+
+void decrypt(uint8_t* data, size_t length, const round_keys& k, kernel which)
+{
+	get_kernel_functions(which).decrypt(data, length, k);
+}
+
 } // namespace xtea
@@ -50,6 +50,35 @@ void encrypt(uint8_t* data, size_t length, const round_keys& k);
  */
 void decrypt(uint8_t* data, size_t length, const round_keys& k);
 
+/**
+ * @enum kernel
+ * @brief The implementations of encrypt and decrypt. The vector kernels work on several blocks at once and give the
+ * same results as the scalar one.
+ */
+enum class kernel : uint8_t
+{
+	scalar,
+	sse2,
+	avx2,
+};
+
+/**
+ * @brief Lists the kernels this CPU can run.
+ *
+ * @return The supported kernels, fastest last. encrypt and decrypt use the last one.
+ */
+std::vector<kernel> supported_kernels();
+
+/**
+ * @brief Encrypts data with the given kernel, which has to be supported by this CPU.
+ */
+void encrypt(uint8_t* data, size_t length, const round_keys& k, kernel which);
+
+/**
+ * @brief Decrypts data with the given kernel, which has to be supported by this CPU.
+ */
+void decrypt(uint8_t* data, size_t length, const round_keys& k, kernel which);
+
 } // namespace xtea
 
 #endif // FS_XTEA_H